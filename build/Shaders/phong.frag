@@ -96,8 +96,9 @@ void main()
 		{
 			// generate tangent space matrix
 			mat3 TBN = transpose(mat3(T,B,N));
-			// sample bump map
-			vec3 bumpNormal = normalize(texture2D( modelBumpMap, UV ).rgb * 2 - 1);
+			// sample bump map (z is rebuilt from x and y, which is all a BC5 map keeps)
+			vec2 bumpSlope = texture2D( modelBumpMap, UV ).rg * 2 - 1;
+			vec3 bumpNormal = normalize(vec3(bumpSlope, sqrt(max(1.0f - dot(bumpSlope, bumpSlope), 0.0f))));
 			// phong model preparation
 			vec3 NN = bumpNormal;
 			vec3 EE = TBN * normalize(E[i]);
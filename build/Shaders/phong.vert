@@ -6,6 +6,8 @@ in vec3 normal;
 in vec2 textureUV;
 in vec3 tangent;
 in vec3 bitangent;
+in vec4 qtangent;
+in vec3 morphTarget;
 
 //// Uniforms
 uniform int renderType;
@@ -14,6 +16,12 @@ uniform mat4 transformM;
 uniform mat4 transformV;
 uniform mat4 transformMVP;
 uniform mat3 transformN;
+uniform vec3 positionScale;
+uniform vec3 positionOffset;
+uniform int tangentFrame;
+uniform vec2 morphRange;
+uniform vec3 morphCamera;
+uniform float morphRadius;
 
 //// Outputs
 out vec3 N;
@@ -26,20 +34,40 @@ out vec2 UV;
 //// Run Loop
 void main()
 {
+	// Decode Position (quantized positions are normalized to the mesh bounds)
+	vec3 objectPosition = positionOffset + (positionScale * position);
+	// Morph Terrain (over its morph range a chunk's vertices slide onto where its parent's grid has them)
+	if (morphRange.y > morphRange.x)
+	{
+		// NOTE: Distances are to the undisplaced sphere, the same as the chunks were picked by
+		float morph = clamp((distance(normalize(objectPosition) * morphRadius, morphCamera) - morphRange.x) / (morphRange.y - morphRange.x), 0.0f, 1.0f);
+		objectPosition = mix(objectPosition, morphTarget, morph);
+	}
 	// Generate Model View Matrix
     mat4 transformMV = transformV * transformM;
+	// Decode Tangent Frame (a qtangent rotates x, y and z onto T, B and N, with the handedness of B in the sign of w)
+	vec3 objectNormal = normal;
+	vec3 objectTangent = tangent;
+	vec3 objectBitangent = bitangent;
+	if (tangentFrame == 1)
+	{
+		vec4 q = normalize(qtangent);
+		objectTangent = vec3(1.0f - 2.0f * (q.y * q.y + q.z * q.z), 2.0f * (q.x * q.y + q.w * q.z), 2.0f * (q.x * q.z - q.w * q.y));
+		objectNormal = vec3(2.0f * (q.x * q.z + q.w * q.y), 2.0f * (q.y * q.z - q.w * q.x), 1.0f - 2.0f * (q.x * q.x + q.y * q.y));
+		objectBitangent = cross(objectNormal, objectTangent) * ((q.w < 0.0f) ? -1.0f : 1.0f);
+	}
 	// Generate vectors for Tangent Space
-	N = normalize((transformMV * vec4(normal, 0.0f)).xyz);
-	T = normalize((transformMV * vec4(tangent, 0.0f)).xyz);
-	B = normalize((transformMV * vec4(bitangent, 0.0f)).xyz);
+	N = normalize((transformMV * vec4(objectNormal, 0.0f)).xyz);
+	T = normalize((transformMV * vec4(objectTangent, 0.0f)).xyz);
+	B = normalize((transformMV * vec4(objectBitangent, 0.0f)).xyz);
 	// Process Light Source INteractions
 	for(int i=0; i<2; i++)
 	{
-		L[i] = normalize((transformV * vec4(lightpositions[i],1.0f)).xyz - (transformMV * vec4(position, 1.0f)).xyz);
-		E[i] = normalize((transformMV * vec4(-1.0f * position, 1.0f)).xyz);
+		L[i] = normalize((transformV * vec4(lightpositions[i],1.0f)).xyz - (transformMV * vec4(objectPosition, 1.0f)).xyz);
+		E[i] = normalize((transformMV * vec4(-1.0f * objectPosition, 1.0f)).xyz);
 	}
 	// Pass through UV coordinates
    	UV = textureUV;
    	// set vertex position
-   	gl_Position = transformMVP * vec4(position, 1.0f);
+   	gl_Position = transformMVP * vec4(objectPosition, 1.0f);
 }
@@ -0,0 +1,150 @@
+//// Header
+#include "arena.h"
+
+//// OS Specific Imports
+#ifdef __linux__
+#include <sys/mman.h>
+#else
+#include <Windows.h>
+#endif
+
+//// Imports
+#include <algorithm>
+
+//// Namespaces
+using namespace std;
+
+namespace SWPTAS001
+{
+	//// Constants
+	static const size_t HUGE_PAGE_SIZE = 2 << 20;
+
+	/////////////
+	// Helpers //
+	/////////////
+
+	static char* allocatePages(size_t size, bool preferHugePages, bool& hugePages)
+	{
+		hugePages = false;
+#ifdef __linux__
+		void* pages = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (pages == MAP_FAILED)
+		{
+			return NULL;
+		}
+#ifdef MADV_HUGEPAGE
+		hugePages = preferHugePages && (madvise(pages, size, MADV_HUGEPAGE) == 0);
+#endif
+		return (char*)pages;
+#else
+		// NOTE: Large pages need the "Lock pages in memory" privilege on Windows, so plain pages are used
+		(void)preferHugePages;
+		return (char*)VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#endif
+	}
+
+	static void freePages(char* pages, size_t size)
+	{
+#ifdef __linux__
+		munmap(pages, size);
+#else
+		(void)size;
+		VirtualFree(pages, 0, MEM_RELEASE);
+#endif
+	}
+
+	//////////////////
+	// Constructors //
+	//////////////////
+
+	MemoryArena::MemoryArena(size_t blockSize)
+	{
+		fBlockSize = max(blockSize, HUGE_PAGE_SIZE);
+		fAllocationCount = 0;
+		fBytesInUse = 0;
+		fPeakBytes = 0;
+		fHugePageBytes = 0;
+	}
+
+	MemoryArena::~MemoryArena()
+	{
+		release();
+	}
+
+	///////////////////
+	// Core Routines //
+	///////////////////
+
+	void* MemoryArena::allocate(size_t size, size_t alignment)
+	{
+		// NOTE: Blocks start page aligned, so aligning the offset within a block aligns the address
+		size = max(size, (size_t)1);
+		Block* block = fBlocks.empty() ? NULL : &fBlocks.back();
+		size_t offset = block ? ((block->used + alignment - 1) & ~(alignment - 1)) : 0;
+		if (!block || ((offset + size) > block->size))
+		{
+			// start a new block, rounded up to whole huge pages
+			Block newBlock;
+			newBlock.size = ((max(size, fBlockSize) + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE) * HUGE_PAGE_SIZE;
+			newBlock.used = 0;
+			bool hugePages;
+			newBlock.base = allocatePages(newBlock.size, size >= HUGE_PAGE_SIZE, hugePages);
+			if (!newBlock.base)
+			{
+				throw bad_alloc();
+			}
+			fHugePageBytes += hugePages ? newBlock.size : 0;
+			// NOTE: A small leftover in the current block is still worth keeping for later allocations
+			if (block && ((block->size - block->used) >= (newBlock.size - size)))
+			{
+				fBlocks.insert(fBlocks.end() - 1, newBlock);
+				block = &fBlocks[fBlocks.size() - 2];
+			}
+			else
+			{
+				fBlocks.push_back(newBlock);
+				block = &fBlocks.back();
+			}
+			offset = 0;
+		}
+		fBytesInUse += (offset - block->used) + size;
+		fPeakBytes = max(fPeakBytes, fBytesInUse);
+		fAllocationCount++;
+		block->used = offset + size;
+		return block->base + offset;
+	}
+
+	void MemoryArena::release()
+	{
+		for (size_t block = 0; block < fBlocks.size(); block++)
+		{
+			freePages(fBlocks[block].base, fBlocks[block].size);
+		}
+		fBlocks.clear();
+		fBytesInUse = 0;
+	}
+
+	///////////////
+	// Accessors //
+	///////////////
+
+	size_t MemoryArena::allocationCount()
+	{
+		return fAllocationCount;
+	}
+
+	size_t MemoryArena::bytesInUse()
+	{
+		return fBytesInUse;
+	}
+
+	size_t MemoryArena::peakBytes()
+	{
+		return fPeakBytes;
+	}
+
+	size_t MemoryArena::hugePageBytes()
+	{
+		return fHugePageBytes;
+	}
+}
@@ -0,0 +1,110 @@
+//// Declaration Guards
+#ifndef ARENA_H
+#define ARENA_H
+
+//// Imports
+#include <vector>
+#include <new>
+#include <type_traits>
+#include <stddef.h>
+
+namespace SWPTAS001
+{
+	//// Constants
+	const size_t ARENA_ALIGNMENT = 64;
+
+	//// Classes
+	class MemoryArena
+	{
+		//// Constructors
+		public:
+			MemoryArena(size_t blockSize = 2 << 20);
+			~MemoryArena();
+
+		//// Core Routines
+		public:
+			void* allocate(size_t size, size_t alignment = ARENA_ALIGNMENT);
+			void release();
+
+		//// Accessors
+		public:
+			size_t allocationCount();
+			size_t bytesInUse();
+			size_t peakBytes();
+			size_t hugePageBytes();
+
+		//// Arena State
+		private:
+			struct Block
+			{
+				char* base;
+				size_t size;
+				size_t used;
+			};
+			std::vector<Block> fBlocks;
+			size_t fBlockSize;
+			size_t fAllocationCount;
+			size_t fBytesInUse;
+			size_t fPeakBytes;
+			size_t fHugePageBytes;
+
+		//// Copy Guards
+		private:
+			MemoryArena(const MemoryArena&);
+			MemoryArena& operator=(const MemoryArena&);
+	};
+
+	// Standard allocator handing out arena memory, or plain heap memory without an arena
+	template <typename T>
+	class ArenaAllocator
+	{
+		public:
+			typedef T value_type;
+			typedef std::true_type propagate_on_container_move_assignment;
+			typedef std::true_type propagate_on_container_swap;
+
+			ArenaAllocator(MemoryArena* theArena = NULL) : arena(theArena) {}
+			template <typename U> ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+			T* allocate(size_t count)
+			{
+				if (arena)
+				{
+					return (T*)arena->allocate(count * sizeof(T));
+				}
+				return (T*)::operator new(count * sizeof(T));
+			}
+
+			void deallocate(T* pointer, size_t)
+			{
+				// NOTE: Arena memory is only given back all at once, by MemoryArena::release()
+				if (!arena)
+				{
+					::operator delete(pointer);
+				}
+			}
+
+			template <typename U> bool operator==(const ArenaAllocator<U>& other) const { return arena == other.arena; }
+			template <typename U> bool operator!=(const ArenaAllocator<U>& other) const { return arena != other.arena; }
+
+			MemoryArena* arena;
+	};
+
+	template <typename T>
+	using ArenaVector = std::vector<T, ArenaAllocator<T> >;
+}
+
+#endif
+
+// NOTE: A MemoryArena is a bump allocator. allocate() carves 64-byte aligned ranges out of large blocks
+//       taken straight from the OS (anything larger than a block gets a block of its own), and nothing
+//       is freed until release() hands every block back at once. That makes it a good fit for data that
+//       is built once and dropped together, like the loader's temporaries or a mesh's final attributes,
+//       and a poor one for anything that grows and shrinks repeatedly
+// NOTE: On Linux the blocks are anonymous mappings, and those holding an allocation of 2 MB or more are
+//       marked MADV_HUGEPAGE, so where transparent huge pages are enabled a large load takes one page
+//       fault per 2 MB instead of one per 4 KB. hugePageBytes() reports how much was requested that way
+//       (the kernel may still decline). The statistics cover the arena's whole lifetime, release() only
+//       resets bytesInUse()
+// NOTE: ArenaVector is a std::vector drawing from an arena. Vectors sharing an arena can be swapped and
+//       moved freely, and a default constructed one simply uses the heap
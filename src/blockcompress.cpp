@@ -0,0 +1,677 @@
+//// Header
+#include "blockcompress.h"
+
+//// Imports
+#include "parallel.h"
+#include <algorithm>
+#include <math.h>
+#include <limits.h>
+#include <string.h>
+
+//// Configurations
+#if defined(__AVX2__)
+#define BLOCKCOMPRESS_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#define BLOCKCOMPRESS_SSE2
+#include <emmintrin.h>
+#endif
+
+//// Namespaces
+using namespace std;
+
+namespace SWPTAS001
+{
+	//// Constants
+	static const int BLOCK_TEXELS = 16;
+	static const int REFIT_PASSES = 2;
+	static const int POWER_ITERATIONS = 8;
+	static const float COLOR_WEIGHTS[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f}; // share of color0 per BC1 index
+	static const float CHANNEL_WEIGHTS[8] = {1.0f, 0.0f, 6.0f / 7.0f, 5.0f / 7.0f, 4.0f / 7.0f, 3.0f / 7.0f, 2.0f / 7.0f, 1.0f / 7.0f};
+
+	/////////////
+	// Helpers //
+	/////////////
+
+	static inline size_t blockBytes(TextureFormat format)
+	{
+		return (format == BC1_TEXTURE) ? 8 : 16;
+	}
+
+	static void gatherBlock(const unsigned char* texels, int width, int height, int blockX, int blockY, short* planes)
+	{
+		// NOTE: planes holds the 16 texels of each channel in a row (r, g, b, a), edge texels standing in past the level
+		for (int y = 0; y < 4; y++)
+		{
+			int row = min((4 * blockY) + y, height - 1);
+			for (int x = 0; x < 4; x++)
+			{
+				int column = min((4 * blockX) + x, width - 1);
+				const unsigned char* texel = texels + (4 * (((size_t)row * width) + column));
+				for (int channel = 0; channel < 4; channel++)
+				{
+					planes[(BLOCK_TEXELS * channel) + (4 * y) + x] = texel[channel];
+				}
+			}
+		}
+	}
+
+	static unsigned int selectIndices(const short* planes, int channelCount, const int* palette, int entryCount, unsigned char* indices)
+	{
+		// NOTE: Picks the closest palette entry for every texel (the lowest one on ties) and returns the summed squared error
+		int distances[BLOCK_TEXELS];
+		int choices[BLOCK_TEXELS];
+#if defined(BLOCKCOMPRESS_AVX2)
+		// NOTE: Unpacking works within 128-bit lanes, so the low pairs are texels 0-3 and 8-11, the high ones 4-7 and 12-15
+		__m256i zero = _mm256_setzero_si256();
+		__m256i channels[4];
+		for (int channel = 0; channel < 4; channel++)
+		{
+			channels[channel] = (channel < channelCount) ? _mm256_loadu_si256((const __m256i*)(planes + (BLOCK_TEXELS * channel))) : zero;
+		}
+		__m256i bestLow = _mm256_set1_epi32(INT_MAX);
+		__m256i bestHigh = bestLow;
+		__m256i choiceLow = zero;
+		__m256i choiceHigh = zero;
+		for (int entry = 0; entry < entryCount; entry++)
+		{
+			__m256i low = zero;
+			__m256i high = zero;
+			for (int channel = 0; channel < channelCount; channel += 2)
+			{
+				__m256i difference0 = _mm256_sub_epi16(channels[channel], _mm256_set1_epi16((short)palette[(entry * channelCount) + channel]));
+				__m256i difference1 = ((channel + 1) < channelCount)
+					? _mm256_sub_epi16(channels[channel + 1], _mm256_set1_epi16((short)palette[(entry * channelCount) + channel + 1])) : zero;
+				__m256i lowPairs = _mm256_unpacklo_epi16(difference0, difference1);
+				__m256i highPairs = _mm256_unpackhi_epi16(difference0, difference1);
+				low = _mm256_add_epi32(low, _mm256_madd_epi16(lowPairs, lowPairs));
+				high = _mm256_add_epi32(high, _mm256_madd_epi16(highPairs, highPairs));
+			}
+			__m256i entryIndex = _mm256_set1_epi32(entry);
+			__m256i closerLow = _mm256_cmpgt_epi32(bestLow, low);
+			__m256i closerHigh = _mm256_cmpgt_epi32(bestHigh, high);
+			bestLow = _mm256_blendv_epi8(bestLow, low, closerLow);
+			bestHigh = _mm256_blendv_epi8(bestHigh, high, closerHigh);
+			choiceLow = _mm256_blendv_epi8(choiceLow, entryIndex, closerLow);
+			choiceHigh = _mm256_blendv_epi8(choiceHigh, entryIndex, closerHigh);
+		}
+		int lanes[4][8];
+		_mm256_storeu_si256((__m256i*)lanes[0], bestLow);
+		_mm256_storeu_si256((__m256i*)lanes[1], bestHigh);
+		_mm256_storeu_si256((__m256i*)lanes[2], choiceLow);
+		_mm256_storeu_si256((__m256i*)lanes[3], choiceHigh);
+		for (int lane = 0; lane < 4; lane++)
+		{
+			distances[lane] = lanes[0][lane];
+			distances[lane + 4] = lanes[1][lane];
+			distances[lane + 8] = lanes[0][lane + 4];
+			distances[lane + 12] = lanes[1][lane + 4];
+			choices[lane] = lanes[2][lane];
+			choices[lane + 4] = lanes[3][lane];
+			choices[lane + 8] = lanes[2][lane + 4];
+			choices[lane + 12] = lanes[3][lane + 4];
+		}
+#elif defined(BLOCKCOMPRESS_SSE2)
+		__m128i zero = _mm_setzero_si128();
+		for (int half = 0; half < 2; half++)
+		{
+			__m128i channels[4];
+			for (int channel = 0; channel < 4; channel++)
+			{
+				channels[channel] = (channel < channelCount) ? _mm_loadu_si128((const __m128i*)(planes + (BLOCK_TEXELS * channel) + (8 * half))) : zero;
+			}
+			__m128i bestLow = _mm_set1_epi32(INT_MAX);
+			__m128i bestHigh = bestLow;
+			__m128i choiceLow = zero;
+			__m128i choiceHigh = zero;
+			for (int entry = 0; entry < entryCount; entry++)
+			{
+				__m128i low = zero;
+				__m128i high = zero;
+				for (int channel = 0; channel < channelCount; channel += 2)
+				{
+					__m128i difference0 = _mm_sub_epi16(channels[channel], _mm_set1_epi16((short)palette[(entry * channelCount) + channel]));
+					__m128i difference1 = ((channel + 1) < channelCount)
+						? _mm_sub_epi16(channels[channel + 1], _mm_set1_epi16((short)palette[(entry * channelCount) + channel + 1])) : zero;
+					__m128i lowPairs = _mm_unpacklo_epi16(difference0, difference1);
+					__m128i highPairs = _mm_unpackhi_epi16(difference0, difference1);
+					low = _mm_add_epi32(low, _mm_madd_epi16(lowPairs, lowPairs));
+					high = _mm_add_epi32(high, _mm_madd_epi16(highPairs, highPairs));
+				}
+				__m128i entryIndex = _mm_set1_epi32(entry);
+				__m128i closerLow = _mm_cmplt_epi32(low, bestLow);
+				__m128i closerHigh = _mm_cmplt_epi32(high, bestHigh);
+				bestLow = _mm_or_si128(_mm_and_si128(closerLow, low), _mm_andnot_si128(closerLow, bestLow));
+				bestHigh = _mm_or_si128(_mm_and_si128(closerHigh, high), _mm_andnot_si128(closerHigh, bestHigh));
+				choiceLow = _mm_or_si128(_mm_and_si128(closerLow, entryIndex), _mm_andnot_si128(closerLow, choiceLow));
+				choiceHigh = _mm_or_si128(_mm_and_si128(closerHigh, entryIndex), _mm_andnot_si128(closerHigh, choiceHigh));
+			}
+			_mm_storeu_si128((__m128i*)(distances + (8 * half)), bestLow);
+			_mm_storeu_si128((__m128i*)(distances + (8 * half) + 4), bestHigh);
+			_mm_storeu_si128((__m128i*)(choices + (8 * half)), choiceLow);
+			_mm_storeu_si128((__m128i*)(choices + (8 * half) + 4), choiceHigh);
+		}
+#else
+		for (int texel = 0; texel < BLOCK_TEXELS; texel++)
+		{
+			distances[texel] = INT_MAX;
+			choices[texel] = 0;
+			for (int entry = 0; entry < entryCount; entry++)
+			{
+				int distance = 0;
+				for (int channel = 0; channel < channelCount; channel++)
+				{
+					int difference = planes[(BLOCK_TEXELS * channel) + texel] - palette[(entry * channelCount) + channel];
+					distance += difference * difference;
+				}
+				if (distance < distances[texel])
+				{
+					distances[texel] = distance;
+					choices[texel] = entry;
+				}
+			}
+		}
+#endif
+		unsigned int error = 0;
+		for (int texel = 0; texel < BLOCK_TEXELS; texel++)
+		{
+			error += (unsigned int)distances[texel];
+			indices[texel] = (unsigned char)choices[texel];
+		}
+		return error;
+	}
+
+	static bool refitEndpoints(const short* planes, int channelCount, const unsigned char* indices, const float* weights, float* high, float* low)
+	{
+		// NOTE: Least squares for the two endpoints with every texel's index (its share of each endpoint) held fixed
+		float highHigh = 0.0f, highLow = 0.0f, lowLow = 0.0f;
+		float highSums[3] = {0.0f, 0.0f, 0.0f};
+		float lowSums[3] = {0.0f, 0.0f, 0.0f};
+		for (int texel = 0; texel < BLOCK_TEXELS; texel++)
+		{
+			float highShare = weights[indices[texel]];
+			float lowShare = 1.0f - highShare;
+			highHigh += highShare * highShare;
+			highLow += highShare * lowShare;
+			lowLow += lowShare * lowShare;
+			for (int channel = 0; channel < channelCount; channel++)
+			{
+				highSums[channel] += highShare * planes[(BLOCK_TEXELS * channel) + texel];
+				lowSums[channel] += lowShare * planes[(BLOCK_TEXELS * channel) + texel];
+			}
+		}
+		float determinant = (highHigh * lowLow) - (highLow * highLow);
+		if (fabsf(determinant) < 1e-3f)
+		{
+			return false;
+		}
+		for (int channel = 0; channel < channelCount; channel++)
+		{
+			high[channel] = min(max(((highSums[channel] * lowLow) - (lowSums[channel] * highLow)) / determinant, 0.0f), 255.0f);
+			low[channel] = min(max(((lowSums[channel] * highHigh) - (highSums[channel] * highLow)) / determinant, 0.0f), 255.0f);
+		}
+		return true;
+	}
+
+	static inline void expand565(unsigned short color, int* rgb)
+	{
+		int red = (color >> 11) & 31;
+		int green = (color >> 5) & 63;
+		int blue = color & 31;
+		rgb[0] = (red << 3) | (red >> 2);
+		rgb[1] = (green << 2) | (green >> 4);
+		rgb[2] = (blue << 3) | (blue >> 2);
+	}
+
+	static inline unsigned short quantize565(const float* rgb)
+	{
+		int red = min(max((int)((rgb[0] * (31.0f / 255.0f)) + 0.5f), 0), 31);
+		int green = min(max((int)((rgb[1] * (63.0f / 255.0f)) + 0.5f), 0), 63);
+		int blue = min(max((int)((rgb[2] * (31.0f / 255.0f)) + 0.5f), 0), 31);
+		return (unsigned short)((red << 11) | (green << 5) | blue);
+	}
+
+	static void colorPalette(unsigned short color0, unsigned short color1, bool fourColors, int* palette)
+	{
+		// NOTE: color0 > color1 (or any BC3 block) interpolates 4 colours, otherwise it's 3 and black
+		expand565(color0, palette);
+		expand565(color1, palette + 3);
+		for (int channel = 0; channel < 3; channel++)
+		{
+			if (fourColors || (color0 > color1))
+			{
+				palette[6 + channel] = ((2 * palette[channel]) + palette[3 + channel] + 1) / 3;
+				palette[9 + channel] = (palette[channel] + (2 * palette[3 + channel]) + 1) / 3;
+			}
+			else
+			{
+				palette[6 + channel] = (palette[channel] + palette[3 + channel] + 1) / 2;
+				palette[9 + channel] = 0;
+			}
+		}
+	}
+
+	static void channelPalette(int value0, int value1, int* palette)
+	{
+		// NOTE: value0 > value1 interpolates 8 values, otherwise it's 6 plus 0 and 255
+		palette[0] = value0;
+		palette[1] = value1;
+		if (value0 > value1)
+		{
+			for (int index = 2; index < 8; index++)
+			{
+				palette[index] = (((8 - index) * value0) + ((index - 1) * value1) + 3) / 7;
+			}
+		}
+		else
+		{
+			for (int index = 2; index < 6; index++)
+			{
+				palette[index] = (((6 - index) * value0) + ((index - 1) * value1) + 2) / 5;
+			}
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+	}
+
+	static void principalAxis(const short* planes, float* axis)
+	{
+		// NOTE: Power iteration on the colour covariance, starting from the channel ranges
+		float mean[3] = {0.0f, 0.0f, 0.0f};
+		float lowest[3] = {255.0f, 255.0f, 255.0f};
+		float highest[3] = {0.0f, 0.0f, 0.0f};
+		for (int channel = 0; channel < 3; channel++)
+		{
+			for (int texel = 0; texel < BLOCK_TEXELS; texel++)
+			{
+				float value = planes[(BLOCK_TEXELS * channel) + texel];
+				mean[channel] += value;
+				lowest[channel] = min(lowest[channel], value);
+				highest[channel] = max(highest[channel], value);
+			}
+			mean[channel] /= BLOCK_TEXELS;
+			axis[channel] = highest[channel] - lowest[channel];
+		}
+		float covariance[3][3] = {};
+		for (int texel = 0; texel < BLOCK_TEXELS; texel++)
+		{
+			float centred[3];
+			for (int channel = 0; channel < 3; channel++)
+			{
+				centred[channel] = planes[(BLOCK_TEXELS * channel) + texel] - mean[channel];
+			}
+			for (int row = 0; row < 3; row++)
+			{
+				for (int column = 0; column < 3; column++)
+				{
+					covariance[row][column] += centred[row] * centred[column];
+				}
+			}
+		}
+		for (int iteration = 0; iteration < POWER_ITERATIONS; iteration++)
+		{
+			float next[3];
+			for (int row = 0; row < 3; row++)
+			{
+				next[row] = (covariance[row][0] * axis[0]) + (covariance[row][1] * axis[1]) + (covariance[row][2] * axis[2]);
+			}
+			float largest = max(fabsf(next[0]), max(fabsf(next[1]), fabsf(next[2])));
+			if (largest <= 0.0f)
+			{
+				break;
+			}
+			for (int channel = 0; channel < 3; channel++)
+			{
+				axis[channel] = next[channel] / largest;
+			}
+		}
+	}
+
+	static void encodeColorBlock(const short* planes, unsigned char* target)
+	{
+		// start from the texels furthest apart along the principal axis
+		float axis[3];
+		principalAxis(planes, axis);
+		int highTexel = 0, lowTexel = 0;
+		float highProjection = -1e30f, lowProjection = 1e30f;
+		for (int texel = 0; texel < BLOCK_TEXELS; texel++)
+		{
+			float projection = (planes[texel] * axis[0]) + (planes[BLOCK_TEXELS + texel] * axis[1]) + (planes[(2 * BLOCK_TEXELS) + texel] * axis[2]);
+			if (projection > highProjection)
+			{
+				highProjection = projection;
+				highTexel = texel;
+			}
+			if (projection < lowProjection)
+			{
+				lowProjection = projection;
+				lowTexel = texel;
+			}
+		}
+		float high[3], low[3];
+		for (int channel = 0; channel < 3; channel++)
+		{
+			high[channel] = planes[(BLOCK_TEXELS * channel) + highTexel];
+			low[channel] = planes[(BLOCK_TEXELS * channel) + lowTexel];
+		}
+
+		// quantize, pick indices and refit, keeping the best pair
+		unsigned int bestError = UINT_MAX;
+		unsigned short bestColors[2] = {0, 0};
+		unsigned char bestIndices[BLOCK_TEXELS] = {};
+		for (int pass = 0; pass <= REFIT_PASSES; pass++)
+		{
+			unsigned short color0 = quantize565(high);
+			unsigned short color1 = quantize565(low);
+			if (color0 < color1)
+			{
+				swap(color0, color1);
+			}
+			// NOTE: Equal endpoints would decode as 3 colours, so they only use index 0
+			int palette[12];
+			unsigned char indices[BLOCK_TEXELS];
+			colorPalette(color0, color1, true, palette);
+			unsigned int error = selectIndices(planes, 3, palette, (color0 == color1) ? 1 : 4, indices);
+			if (error < bestError)
+			{
+				bestError = error;
+				bestColors[0] = color0;
+				bestColors[1] = color1;
+				memcpy(bestIndices, indices, sizeof(indices));
+			}
+			if ((error == 0) || (color0 == color1) || !refitEndpoints(planes, 3, indices, COLOR_WEIGHTS, high, low))
+			{
+				break;
+			}
+		}
+
+		// write
+		unsigned int indexBits = 0;
+		for (int texel = 0; texel < BLOCK_TEXELS; texel++)
+		{
+			indexBits |= (unsigned int)bestIndices[texel] << (2 * texel);
+		}
+		target[0] = (unsigned char)(bestColors[0] & 0xFF);
+		target[1] = (unsigned char)(bestColors[0] >> 8);
+		target[2] = (unsigned char)(bestColors[1] & 0xFF);
+		target[3] = (unsigned char)(bestColors[1] >> 8);
+		for (int byte = 0; byte < 4; byte++)
+		{
+			target[4 + byte] = (unsigned char)(indexBits >> (8 * byte));
+		}
+	}
+
+	static void encodeChannelBlock(const short* values, unsigned char* target)
+	{
+		// start from the channel's range
+		float high = 0.0f, low = 255.0f;
+		for (int texel = 0; texel < BLOCK_TEXELS; texel++)
+		{
+			high = max(high, (float)values[texel]);
+			low = min(low, (float)values[texel]);
+		}
+
+		// quantize, pick indices and refit, keeping the best pair
+		unsigned int bestError = UINT_MAX;
+		int bestValues[2] = {0, 0};
+		unsigned char bestIndices[BLOCK_TEXELS] = {};
+		for (int pass = 0; pass <= REFIT_PASSES; pass++)
+		{
+			int value0 = (int)(high + 0.5f);
+			int value1 = (int)(low + 0.5f);
+			if (value0 < value1)
+			{
+				swap(value0, value1);
+			}
+			// NOTE: Equal endpoints would decode as 6 values, so they only use index 0
+			int palette[8];
+			unsigned char indices[BLOCK_TEXELS];
+			channelPalette(value0, value1, palette);
+			unsigned int error = selectIndices(values, 1, palette, (value0 == value1) ? 1 : 8, indices);
+			if (error < bestError)
+			{
+				bestError = error;
+				bestValues[0] = value0;
+				bestValues[1] = value1;
+				memcpy(bestIndices, indices, sizeof(indices));
+			}
+			if ((error == 0) || (value0 == value1) || !refitEndpoints(values, 1, indices, CHANNEL_WEIGHTS, &high, &low))
+			{
+				break;
+			}
+		}
+
+		// write
+		unsigned long long indexBits = 0;
+		for (int texel = 0; texel < BLOCK_TEXELS; texel++)
+		{
+			indexBits |= (unsigned long long)bestIndices[texel] << (3 * texel);
+		}
+		target[0] = (unsigned char)bestValues[0];
+		target[1] = (unsigned char)bestValues[1];
+		for (int byte = 0; byte < 6; byte++)
+		{
+			target[2 + byte] = (unsigned char)(indexBits >> (8 * byte));
+		}
+	}
+
+	static void decodeColorBlock(const unsigned char* source, bool fourColors, unsigned char* texels)
+	{
+		int palette[12];
+		colorPalette((unsigned short)(source[0] | (source[1] << 8)), (unsigned short)(source[2] | (source[3] << 8)), fourColors, palette);
+		unsigned int indexBits = source[4] | (source[5] << 8) | (source[6] << 16) | ((unsigned int)source[7] << 24);
+		for (int texel = 0; texel < BLOCK_TEXELS; texel++)
+		{
+			const int* color = palette + (3 * ((indexBits >> (2 * texel)) & 3));
+			texels[(4 * texel)] = (unsigned char)color[0];
+			texels[(4 * texel) + 1] = (unsigned char)color[1];
+			texels[(4 * texel) + 2] = (unsigned char)color[2];
+			texels[(4 * texel) + 3] = 255;
+		}
+	}
+
+	static void decodeChannelBlock(const unsigned char* source, unsigned char* texels, int channel)
+	{
+		int palette[8];
+		channelPalette(source[0], source[1], palette);
+		unsigned long long indexBits = 0;
+		for (int byte = 0; byte < 6; byte++)
+		{
+			indexBits |= (unsigned long long)source[2 + byte] << (8 * byte);
+		}
+		for (int texel = 0; texel < BLOCK_TEXELS; texel++)
+		{
+			texels[(4 * texel) + channel] = (unsigned char)palette[(indexBits >> (3 * texel)) & 7];
+		}
+	}
+
+	static void decodeLevel(const unsigned char* blocks, TextureFormat format, int width, int height, unsigned char* rgba, int threadCount)
+	{
+		size_t blocksWide = (size_t)(width + 3) / 4;
+		size_t blockRows = (size_t)(height + 3) / 4;
+		parallelFor(blockRows, threadCount, [&](size_t blockRow)
+		{
+			const unsigned char* block = blocks + (blockRow * blocksWide * blockBytes(format));
+			for (size_t blockX = 0; blockX < blocksWide; blockX++, block += blockBytes(format))
+			{
+				unsigned char texels[4 * BLOCK_TEXELS];
+				if (format == BC1_TEXTURE)
+				{
+					decodeColorBlock(block, false, texels);
+				}
+				else if (format == BC3_TEXTURE)
+				{
+					decodeColorBlock(block + 8, true, texels);
+					decodeChannelBlock(block, texels, 3);
+				}
+				else
+				{
+					for (int texel = 0; texel < BLOCK_TEXELS; texel++)
+					{
+						texels[(4 * texel) + 2] = 0;
+						texels[(4 * texel) + 3] = 255;
+					}
+					decodeChannelBlock(block, texels, 0);
+					decodeChannelBlock(block + 8, texels, 1);
+				}
+				for (int y = 0; y < 4; y++)
+				{
+					size_t row = (4 * blockRow) + y;
+					for (int x = 0; (row < (size_t)height) && (x < 4); x++)
+					{
+						size_t column = (4 * blockX) + x;
+						if (column < (size_t)width)
+						{
+							memcpy(rgba + (4 * ((row * width) + column)), texels + (4 * ((4 * y) + x)), 4);
+						}
+					}
+				}
+			}
+		});
+	}
+
+	////////////////////////////////
+	// Block Compression Routines //
+	////////////////////////////////
+
+	size_t textureLevelSize(TextureFormat format, int width, int height)
+	{
+		if (format == RGBA8_TEXTURE)
+		{
+			return (size_t)width * height * 4;
+		}
+		return ((size_t)(width + 3) / 4) * ((size_t)(height + 3) / 4) * blockBytes(format);
+	}
+
+	TextureFormat chooseBlockFormat(const MipChain& chain, MipMode mode)
+	{
+		if (mode == NORMAL_MIPS)
+		{
+			return BC5_TEXTURE;
+		}
+		if (!chain.levels.empty())
+		{
+			size_t texelCount = (size_t)chain.levels[0].width * chain.levels[0].height;
+			for (size_t texel = 0; texel < texelCount; texel++)
+			{
+				if (mipLevelTexels(chain, 0)[(4 * texel) + 3] != 255)
+				{
+					return BC3_TEXTURE;
+				}
+			}
+		}
+		return BC1_TEXTURE;
+	}
+
+	void compressMipChain(const MipChain& source, TextureFormat format, MipChain& target, int threadCount)
+	{
+		if ((format == RGBA8_TEXTURE) || (source.format != RGBA8_TEXTURE))
+		{
+			target = source;
+			return;
+		}
+
+		// lay out the levels
+		target.format = format;
+		target.bumpStrength = source.bumpStrength;
+		target.mappedTexels = NULL;
+		target.levels.clear();
+		size_t totalBytes = 0;
+		for (size_t levelIndex = 0; levelIndex < source.levels.size(); levelIndex++)
+		{
+			MipLevel level = {source.levels[levelIndex].width, source.levels[levelIndex].height, totalBytes};
+			target.levels.push_back(level);
+			totalBytes += textureLevelSize(format, level.width, level.height);
+		}
+		target.texels.resize(totalBytes);
+
+		// encode every level, a row of blocks per task
+		for (size_t levelIndex = 0; levelIndex < target.levels.size(); levelIndex++)
+		{
+			const MipLevel& level = target.levels[levelIndex];
+			const unsigned char* sourceTexels = mipLevelTexels(source, levelIndex);
+			size_t blocksWide = (size_t)(level.width + 3) / 4;
+			size_t blockRows = (size_t)(level.height + 3) / 4;
+			parallelFor(blockRows, threadCount, [&](size_t blockRow)
+			{
+				unsigned char* block = &target.texels[level.offset + (blockRow * blocksWide * blockBytes(format))];
+				for (size_t blockX = 0; blockX < blocksWide; blockX++, block += blockBytes(format))
+				{
+					short planes[4 * BLOCK_TEXELS];
+					gatherBlock(sourceTexels, level.width, level.height, (int)blockX, (int)blockRow, planes);
+					if (format == BC1_TEXTURE)
+					{
+						encodeColorBlock(planes, block);
+					}
+					else if (format == BC3_TEXTURE)
+					{
+						encodeChannelBlock(planes + (3 * BLOCK_TEXELS), block);
+						encodeColorBlock(planes, block + 8);
+					}
+					else
+					{
+						encodeChannelBlock(planes, block);
+						encodeChannelBlock(planes + BLOCK_TEXELS, block + 8);
+					}
+				}
+			});
+		}
+
+		// decode level 0 back to see what was lost
+		target.psnr = 0.0f;
+		if (!target.levels.empty())
+		{
+			const MipLevel& level = target.levels[0];
+			vector<unsigned char> decoded((size_t)level.width * level.height * 4);
+			decodeLevel(&target.texels[level.offset], format, level.width, level.height, &decoded[0], threadCount);
+			target.psnr = (float)measurePSNR(mipLevelTexels(source, 0), &decoded[0], (size_t)level.width * level.height, format);
+		}
+	}
+
+	void decompressMipChain(const MipChain& source, MipChain& target, int threadCount)
+	{
+		if (source.format == RGBA8_TEXTURE)
+		{
+			target = source;
+			return;
+		}
+		target.format = RGBA8_TEXTURE;
+		target.psnr = 0.0f;
+		target.bumpStrength = source.bumpStrength;
+		target.mappedTexels = NULL;
+		target.levels.clear();
+		size_t totalBytes = 0;
+		for (size_t levelIndex = 0; levelIndex < source.levels.size(); levelIndex++)
+		{
+			MipLevel level = {source.levels[levelIndex].width, source.levels[levelIndex].height, totalBytes};
+			target.levels.push_back(level);
+			totalBytes += textureLevelSize(RGBA8_TEXTURE, level.width, level.height);
+		}
+		target.texels.resize(totalBytes);
+		for (size_t levelIndex = 0; levelIndex < target.levels.size(); levelIndex++)
+		{
+			const MipLevel& level = target.levels[levelIndex];
+			decodeLevel(mipLevelTexels(source, levelIndex), source.format, level.width, level.height, &target.texels[level.offset], threadCount);
+		}
+	}
+
+	double measurePSNR(const unsigned char* original, const unsigned char* decoded, size_t texelCount, TextureFormat format)
+	{
+		int channelCount = (format == BC1_TEXTURE) ? 3 : ((format == BC5_TEXTURE) ? 2 : 4);
+		double squaredError = 0.0;
+		for (size_t texel = 0; texel < texelCount; texel++)
+		{
+			for (int channel = 0; channel < channelCount; channel++)
+			{
+				double difference = (double)original[(4 * texel) + channel] - decoded[(4 * texel) + channel];
+				squaredError += difference * difference;
+			}
+		}
+		if (squaredError <= 0.0)
+		{
+			return HUGE_VAL;
+		}
+		double meanSquaredError = squaredError / ((double)texelCount * channelCount);
+		return 10.0 * log10((255.0 * 255.0) / meanSquaredError);
+	}
+}
@@ -0,0 +1,34 @@
+//// Declaration Guards
+#ifndef BLOCKCOMPRESS_H
+#define BLOCKCOMPRESS_H
+
+//// Imports
+#include <stddef.h>
+#include "mipmaps.h"
+
+namespace SWPTAS001
+{
+	//// Block Compression Routines
+	size_t textureLevelSize(TextureFormat format, int width, int height);
+	TextureFormat chooseBlockFormat(const MipChain& chain, MipMode mode);
+	void compressMipChain(const MipChain& source, TextureFormat format, MipChain& target, int threadCount);
+	void decompressMipChain(const MipChain& source, MipChain& target, int threadCount);
+	double measurePSNR(const unsigned char* original, const unsigned char* decoded, size_t texelCount, TextureFormat format);
+}
+
+#endif
+
+// NOTE: Block formats store every 4 x 4 texels in 8 bytes (BC1) or 16 bytes (BC3, BC5), laid out as
+//       OpenGL expects them for GL_COMPRESSED_RGB_S3TC_DXT1_EXT, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT and
+//       GL_COMPRESSED_RG_RGTC2. Levels that aren't a multiple of 4 pad their last blocks with edge texels
+// NOTE: chooseBlockFormat() picks BC5 for NORMAL_MIPS (only x and y are kept, phong.frag rebuilds z),
+//       BC1 for an opaque COLOR_MIPS chain and BC3 when level 0 has any alpha below 255
+// NOTE: compressMipChain() encodes each level's block rows in parallel. Colour endpoints start from the
+//       extremes along the block's principal axis and alpha, red and green endpoints from the channel's
+//       range, then both are refit by least squares to the indices picked, keeping whichever fit errs
+//       least. Index picking, the inner loop, compares squared errors in integers with AVX2 or SSE2
+//       where available, so every path writes the same blocks. Level 0 is decoded back afterwards and
+//       its PSNR kept in MipChain::psnr
+// NOTE: decompressMipChain() is the CPU decoder, giving RGBA the way the GPU samples it (BC5 decodes to
+//       (x, y, 0, 255)), for PSNR and for drivers without S3TC. measurePSNR() compares only the channels
+//       the format stores and is infinite when they match exactly
@@ -0,0 +1,454 @@
+//// Header
+#include "bounds.h"
+
+//// Imports
+#include <vector>
+#include <algorithm>
+#include <string.h>
+#include <math.h>
+#include "parallel.h"
+
+//// Configurations
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define BOUNDS_SSE2
+#include <emmintrin.h>
+#endif
+
+//// Namespaces
+using namespace std;
+
+namespace SWPTAS001
+{
+	//// Constants
+	static const size_t BOUNDS_BLOCK_SIZE = 4096;
+	static const int CENTER_CANDIDATES = 3;
+
+	//// Structures
+	// Box, sums and products of one block of positions, taken relative to the first position
+	struct MomentPartial
+	{
+		float minimum[3];
+		float maximum[3];
+		double sums[3];
+		double products[6]; // xx, xy, xz, yy, yz, zz
+	};
+
+	// Farthest squared distance to each candidate centre, and the extent along each axis from the first one
+	struct ExtentPartial
+	{
+		float distances[CENTER_CANDIDATES];
+		float axisMinimum[3];
+		float axisMaximum[3];
+	};
+
+	/////////////
+	// Helpers //
+	/////////////
+
+#ifdef BOUNDS_SSE2
+	// Loads 4 xyz positions and transposes them into 4 x, 4 y and 4 z values
+	static inline void loadPositions4(const float* positions, __m128& x, __m128& y, __m128& z)
+	{
+		__m128 a = _mm_loadu_ps(positions);
+		__m128 b = _mm_loadu_ps(positions + 4);
+		__m128 c = _mm_loadu_ps(positions + 8);
+		x = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 3, 0));
+		y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)), _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+		z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+	}
+
+	static inline float horizontalMin(__m128 value)
+	{
+		value = _mm_min_ps(value, _mm_shuffle_ps(value, value, _MM_SHUFFLE(1, 0, 3, 2)));
+		value = _mm_min_ps(value, _mm_shuffle_ps(value, value, _MM_SHUFFLE(2, 3, 0, 1)));
+		return _mm_cvtss_f32(value);
+	}
+
+	static inline float horizontalMax(__m128 value)
+	{
+		value = _mm_max_ps(value, _mm_shuffle_ps(value, value, _MM_SHUFFLE(1, 0, 3, 2)));
+		value = _mm_max_ps(value, _mm_shuffle_ps(value, value, _MM_SHUFFLE(2, 3, 0, 1)));
+		return _mm_cvtss_f32(value);
+	}
+
+	static inline double horizontalSum(__m128 value)
+	{
+		float lanes[4];
+		_mm_storeu_ps(lanes, value);
+		return ((double)lanes[0] + lanes[1]) + ((double)lanes[2] + lanes[3]);
+	}
+#endif
+
+	static void accumulateMoments(const float* positions, size_t begin, size_t end, const float* origin, MomentPartial& partial)
+	{
+		// NOTE: Sums are kept in float only within a block and relative to the first position, which keeps
+		//       the covariance accurate for meshes far from the origin
+		float minimum[3] = {positions[3 * begin], positions[(3 * begin) + 1], positions[(3 * begin) + 2]};
+		float maximum[3] = {minimum[0], minimum[1], minimum[2]};
+		float sums[3] = {0.0f, 0.0f, 0.0f};
+		float products[6] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+		size_t vertex = begin;
+#ifdef BOUNDS_SSE2
+		__m128 minimumX = _mm_set1_ps(minimum[0]);
+		__m128 minimumY = _mm_set1_ps(minimum[1]);
+		__m128 minimumZ = _mm_set1_ps(minimum[2]);
+		__m128 maximumX = minimumX;
+		__m128 maximumY = minimumY;
+		__m128 maximumZ = minimumZ;
+		__m128 originX = _mm_set1_ps(origin[0]);
+		__m128 originY = _mm_set1_ps(origin[1]);
+		__m128 originZ = _mm_set1_ps(origin[2]);
+		__m128 sumX = _mm_setzero_ps();
+		__m128 sumY = _mm_setzero_ps();
+		__m128 sumZ = _mm_setzero_ps();
+		__m128 productXX = _mm_setzero_ps();
+		__m128 productXY = _mm_setzero_ps();
+		__m128 productXZ = _mm_setzero_ps();
+		__m128 productYY = _mm_setzero_ps();
+		__m128 productYZ = _mm_setzero_ps();
+		__m128 productZZ = _mm_setzero_ps();
+		for (; (vertex + 4) <= end; vertex += 4)
+		{
+			__m128 x;
+			__m128 y;
+			__m128 z;
+			loadPositions4(positions + (3 * vertex), x, y, z);
+			minimumX = _mm_min_ps(minimumX, x);
+			minimumY = _mm_min_ps(minimumY, y);
+			minimumZ = _mm_min_ps(minimumZ, z);
+			maximumX = _mm_max_ps(maximumX, x);
+			maximumY = _mm_max_ps(maximumY, y);
+			maximumZ = _mm_max_ps(maximumZ, z);
+			x = _mm_sub_ps(x, originX);
+			y = _mm_sub_ps(y, originY);
+			z = _mm_sub_ps(z, originZ);
+			sumX = _mm_add_ps(sumX, x);
+			sumY = _mm_add_ps(sumY, y);
+			sumZ = _mm_add_ps(sumZ, z);
+			productXX = _mm_add_ps(productXX, _mm_mul_ps(x, x));
+			productXY = _mm_add_ps(productXY, _mm_mul_ps(x, y));
+			productXZ = _mm_add_ps(productXZ, _mm_mul_ps(x, z));
+			productYY = _mm_add_ps(productYY, _mm_mul_ps(y, y));
+			productYZ = _mm_add_ps(productYZ, _mm_mul_ps(y, z));
+			productZZ = _mm_add_ps(productZZ, _mm_mul_ps(z, z));
+		}
+		minimum[0] = horizontalMin(minimumX);
+		minimum[1] = horizontalMin(minimumY);
+		minimum[2] = horizontalMin(minimumZ);
+		maximum[0] = horizontalMax(maximumX);
+		maximum[1] = horizontalMax(maximumY);
+		maximum[2] = horizontalMax(maximumZ);
+		partial.sums[0] = horizontalSum(sumX);
+		partial.sums[1] = horizontalSum(sumY);
+		partial.sums[2] = horizontalSum(sumZ);
+		partial.products[0] = horizontalSum(productXX);
+		partial.products[1] = horizontalSum(productXY);
+		partial.products[2] = horizontalSum(productXZ);
+		partial.products[3] = horizontalSum(productYY);
+		partial.products[4] = horizontalSum(productYZ);
+		partial.products[5] = horizontalSum(productZZ);
+#else
+		memset(partial.sums, 0, sizeof(partial.sums));
+		memset(partial.products, 0, sizeof(partial.products));
+#endif
+		// remaining vertices
+		for (; vertex < end; vertex++)
+		{
+			const float* position = positions + (3 * vertex);
+			float offset[3];
+			for (int axis = 0; axis < 3; axis++)
+			{
+				minimum[axis] = min(minimum[axis], position[axis]);
+				maximum[axis] = max(maximum[axis], position[axis]);
+				offset[axis] = position[axis] - origin[axis];
+				sums[axis] += offset[axis];
+			}
+			products[0] += offset[0] * offset[0];
+			products[1] += offset[0] * offset[1];
+			products[2] += offset[0] * offset[2];
+			products[3] += offset[1] * offset[1];
+			products[4] += offset[1] * offset[2];
+			products[5] += offset[2] * offset[2];
+		}
+		for (int axis = 0; axis < 3; axis++)
+		{
+			partial.minimum[axis] = minimum[axis];
+			partial.maximum[axis] = maximum[axis];
+			partial.sums[axis] += sums[axis];
+		}
+		for (int product = 0; product < 6; product++)
+		{
+			partial.products[product] += products[product];
+		}
+	}
+
+	static void measureExtents(const float* positions, size_t begin, size_t end, const float centers[CENTER_CANDIDATES][3],
+		const float axes[3][3], ExtentPartial& partial)
+	{
+		for (int candidate = 0; candidate < CENTER_CANDIDATES; candidate++)
+		{
+			partial.distances[candidate] = 0.0f;
+		}
+		for (int axis = 0; axis < 3; axis++)
+		{
+			const float* position = positions + (3 * begin);
+			partial.axisMinimum[axis] = partial.axisMaximum[axis] = ((position[0] - centers[0][0]) * axes[axis][0]) +
+				((position[1] - centers[0][1]) * axes[axis][1]) + ((position[2] - centers[0][2]) * axes[axis][2]);
+		}
+		size_t vertex = begin;
+#ifdef BOUNDS_SSE2
+		__m128 distances[CENTER_CANDIDATES];
+		for (int candidate = 0; candidate < CENTER_CANDIDATES; candidate++)
+		{
+			distances[candidate] = _mm_setzero_ps();
+		}
+		__m128 axisMinimum[3];
+		__m128 axisMaximum[3];
+		for (int axis = 0; axis < 3; axis++)
+		{
+			axisMinimum[axis] = axisMaximum[axis] = _mm_set1_ps(partial.axisMinimum[axis]);
+		}
+		for (; (vertex + 4) <= end; vertex += 4)
+		{
+			__m128 x;
+			__m128 y;
+			__m128 z;
+			loadPositions4(positions + (3 * vertex), x, y, z);
+			for (int candidate = 0; candidate < CENTER_CANDIDATES; candidate++)
+			{
+				__m128 offsetX = _mm_sub_ps(x, _mm_set1_ps(centers[candidate][0]));
+				__m128 offsetY = _mm_sub_ps(y, _mm_set1_ps(centers[candidate][1]));
+				__m128 offsetZ = _mm_sub_ps(z, _mm_set1_ps(centers[candidate][2]));
+				__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(offsetX, offsetX), _mm_mul_ps(offsetY, offsetY)), _mm_mul_ps(offsetZ, offsetZ));
+				distances[candidate] = _mm_max_ps(distances[candidate], distance);
+			}
+			x = _mm_sub_ps(x, _mm_set1_ps(centers[0][0]));
+			y = _mm_sub_ps(y, _mm_set1_ps(centers[0][1]));
+			z = _mm_sub_ps(z, _mm_set1_ps(centers[0][2]));
+			for (int axis = 0; axis < 3; axis++)
+			{
+				__m128 projection = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(axes[axis][0])), _mm_mul_ps(y, _mm_set1_ps(axes[axis][1]))),
+					_mm_mul_ps(z, _mm_set1_ps(axes[axis][2])));
+				axisMinimum[axis] = _mm_min_ps(axisMinimum[axis], projection);
+				axisMaximum[axis] = _mm_max_ps(axisMaximum[axis], projection);
+			}
+		}
+		for (int candidate = 0; candidate < CENTER_CANDIDATES; candidate++)
+		{
+			partial.distances[candidate] = horizontalMax(distances[candidate]);
+		}
+		for (int axis = 0; axis < 3; axis++)
+		{
+			partial.axisMinimum[axis] = horizontalMin(axisMinimum[axis]);
+			partial.axisMaximum[axis] = horizontalMax(axisMaximum[axis]);
+		}
+#endif
+		// remaining vertices
+		for (; vertex < end; vertex++)
+		{
+			const float* position = positions + (3 * vertex);
+			for (int candidate = 0; candidate < CENTER_CANDIDATES; candidate++)
+			{
+				float offset[3] = {position[0] - centers[candidate][0], position[1] - centers[candidate][1], position[2] - centers[candidate][2]};
+				partial.distances[candidate] = max(partial.distances[candidate], (offset[0] * offset[0]) + (offset[1] * offset[1]) + (offset[2] * offset[2]));
+			}
+			for (int axis = 0; axis < 3; axis++)
+			{
+				float projection = ((position[0] - centers[0][0]) * axes[axis][0]) + ((position[1] - centers[0][1]) * axes[axis][1]) +
+					((position[2] - centers[0][2]) * axes[axis][2]);
+				partial.axisMinimum[axis] = min(partial.axisMinimum[axis], projection);
+				partial.axisMaximum[axis] = max(partial.axisMaximum[axis], projection);
+			}
+		}
+	}
+
+	// Diagonalizes the symmetric matrix with cyclic Jacobi rotations, leaving the eigenvectors as rows of axes
+	static void principalAxes(double matrix[3][3], float axes[3][3])
+	{
+		double vectors[3][3] = {{1.0, 0.0, 0.0}, {0.0, 1.0, 0.0}, {0.0, 0.0, 1.0}};
+		for (int sweep = 0; sweep < 16; sweep++)
+		{
+			double offDiagonal = fabs(matrix[0][1]) + fabs(matrix[0][2]) + fabs(matrix[1][2]);
+			if (offDiagonal <= (1e-12 * (fabs(matrix[0][0]) + fabs(matrix[1][1]) + fabs(matrix[2][2]))))
+			{
+				break;
+			}
+			for (int p = 0; p < 2; p++)
+			{
+				for (int q = p + 1; q < 3; q++)
+				{
+					if (matrix[p][q] == 0.0)
+					{
+						continue;
+					}
+					// rotate rows/columns p and q so that matrix[p][q] becomes 0
+					double theta = (matrix[q][q] - matrix[p][p]) / (2.0 * matrix[p][q]);
+					double tangent = ((theta >= 0.0) ? 1.0 : -1.0) / (fabs(theta) + sqrt((theta * theta) + 1.0));
+					double cosine = 1.0 / sqrt((tangent * tangent) + 1.0);
+					double sine = tangent * cosine;
+					for (int k = 0; k < 3; k++)
+					{
+						double kp = matrix[k][p];
+						double kq = matrix[k][q];
+						matrix[k][p] = (cosine * kp) - (sine * kq);
+						matrix[k][q] = (sine * kp) + (cosine * kq);
+					}
+					for (int k = 0; k < 3; k++)
+					{
+						double pk = matrix[p][k];
+						double qk = matrix[q][k];
+						matrix[p][k] = (cosine * pk) - (sine * qk);
+						matrix[q][k] = (sine * pk) + (cosine * qk);
+					}
+					for (int k = 0; k < 3; k++)
+					{
+						double vp = vectors[k][p];
+						double vq = vectors[k][q];
+						vectors[k][p] = (cosine * vp) - (sine * vq);
+						vectors[k][q] = (sine * vp) + (cosine * vq);
+					}
+				}
+			}
+		}
+
+		// order the axes by decreasing spread, and keep them right handed
+		int order[3] = {0, 1, 2};
+		sort(order, order + 3, [&](int a, int b)
+		{
+			return matrix[a][a] > matrix[b][b];
+		});
+		for (int axis = 0; axis < 3; axis++)
+		{
+			for (int k = 0; k < 3; k++)
+			{
+				axes[axis][k] = (float)vectors[k][order[axis]];
+			}
+		}
+		axes[2][0] = (axes[0][1] * axes[1][2]) - (axes[0][2] * axes[1][1]);
+		axes[2][1] = (axes[0][2] * axes[1][0]) - (axes[0][0] * axes[1][2]);
+		axes[2][2] = (axes[0][0] * axes[1][1]) - (axes[0][1] * axes[1][0]);
+	}
+
+	/////////////////////
+	// Bounds Routines //
+	/////////////////////
+
+	void computeMeshBounds(const float* positions, size_t vertexCount, bool orientedBox, int threadCount, MeshBounds& bounds)
+	{
+		memset(&bounds, 0, sizeof(MeshBounds));
+		for (int axis = 0; axis < 3; axis++)
+		{
+			bounds.obbAxes[axis][axis] = 1.0f;
+		}
+		if (vertexCount == 0)
+		{
+			return;
+		}
+
+		// pass 1: box and moments
+		size_t blockCount = (vertexCount + BOUNDS_BLOCK_SIZE - 1) / BOUNDS_BLOCK_SIZE;
+		vector<MomentPartial> moments(blockCount);
+		parallelFor(blockCount, threadCount, [&](size_t block)
+		{
+			accumulateMoments(positions, block * BOUNDS_BLOCK_SIZE, min(vertexCount, (block + 1) * BOUNDS_BLOCK_SIZE), positions, moments[block]);
+		});
+		double sums[3] = {0.0, 0.0, 0.0};
+		double products[6] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+		for (int axis = 0; axis < 3; axis++)
+		{
+			bounds.aabbMin[axis] = moments[0].minimum[axis];
+			bounds.aabbMax[axis] = moments[0].maximum[axis];
+		}
+		for (size_t block = 0; block < blockCount; block++)
+		{
+			for (int axis = 0; axis < 3; axis++)
+			{
+				bounds.aabbMin[axis] = min(bounds.aabbMin[axis], moments[block].minimum[axis]);
+				bounds.aabbMax[axis] = max(bounds.aabbMax[axis], moments[block].maximum[axis]);
+				sums[axis] += moments[block].sums[axis];
+			}
+			for (int product = 0; product < 6; product++)
+			{
+				products[product] += moments[block].products[product];
+			}
+		}
+
+		// principal axes of the covariance
+		double mean[3] = {sums[0] / vertexCount, sums[1] / vertexCount, sums[2] / vertexCount};
+		float axes[3][3] = {{1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}};
+		if (orientedBox)
+		{
+			double covariance[3][3];
+			covariance[0][0] = (products[0] / vertexCount) - (mean[0] * mean[0]);
+			covariance[0][1] = covariance[1][0] = (products[1] / vertexCount) - (mean[0] * mean[1]);
+			covariance[0][2] = covariance[2][0] = (products[2] / vertexCount) - (mean[0] * mean[2]);
+			covariance[1][1] = (products[3] / vertexCount) - (mean[1] * mean[1]);
+			covariance[1][2] = covariance[2][1] = (products[4] / vertexCount) - (mean[1] * mean[2]);
+			covariance[2][2] = (products[5] / vertexCount) - (mean[2] * mean[2]);
+			principalAxes(covariance, axes);
+		}
+
+		// pass 2: sphere radii and extents along the axes
+		// NOTE: The oriented box centre isn't known before this pass, so the third candidate is the box
+		//       centre pulled halfway to the mean instead
+		float centers[CENTER_CANDIDATES][3];
+		for (int axis = 0; axis < 3; axis++)
+		{
+			centers[0][axis] = (bounds.aabbMin[axis] + bounds.aabbMax[axis]) * 0.5f;
+			centers[1][axis] = (float)(positions[axis] + mean[axis]);
+			centers[2][axis] = (centers[0][axis] + centers[1][axis]) * 0.5f;
+		}
+		vector<ExtentPartial> extents(blockCount);
+		parallelFor(blockCount, threadCount, [&](size_t block)
+		{
+			measureExtents(positions, block * BOUNDS_BLOCK_SIZE, min(vertexCount, (block + 1) * BOUNDS_BLOCK_SIZE), centers, axes, extents[block]);
+		});
+		ExtentPartial total = extents[0];
+		for (size_t block = 1; block < blockCount; block++)
+		{
+			for (int candidate = 0; candidate < CENTER_CANDIDATES; candidate++)
+			{
+				total.distances[candidate] = max(total.distances[candidate], extents[block].distances[candidate]);
+			}
+			for (int axis = 0; axis < 3; axis++)
+			{
+				total.axisMinimum[axis] = min(total.axisMinimum[axis], extents[block].axisMinimum[axis]);
+				total.axisMaximum[axis] = max(total.axisMaximum[axis], extents[block].axisMaximum[axis]);
+			}
+		}
+
+		// pick the tightest sphere
+		int bestCandidate = 0;
+		for (int candidate = 1; candidate < CENTER_CANDIDATES; candidate++)
+		{
+			bestCandidate = (total.distances[candidate] < total.distances[bestCandidate]) ? candidate : bestCandidate;
+		}
+		memcpy(bounds.sphereCenter, centers[bestCandidate], sizeof(bounds.sphereCenter));
+		bounds.sphereRadius = sqrtf(total.distances[bestCandidate]);
+
+		// assemble the oriented box, unless the principal axes fit worse than the world axes
+		float orientedVolume = (total.axisMaximum[0] - total.axisMinimum[0]) * (total.axisMaximum[1] - total.axisMinimum[1]) *
+			(total.axisMaximum[2] - total.axisMinimum[2]);
+		float boxVolume = (bounds.aabbMax[0] - bounds.aabbMin[0]) * (bounds.aabbMax[1] - bounds.aabbMin[1]) * (bounds.aabbMax[2] - bounds.aabbMin[2]);
+		if (orientedVolume >= boxVolume)
+		{
+			for (int axis = 0; axis < 3; axis++)
+			{
+				bounds.obbCenter[axis] = centers[0][axis];
+				bounds.obbHalfExtents[axis] = (bounds.aabbMax[axis] - bounds.aabbMin[axis]) * 0.5f;
+			}
+			return;
+		}
+		memcpy(bounds.obbAxes, axes, sizeof(bounds.obbAxes));
+		memcpy(bounds.obbCenter, centers[0], sizeof(bounds.obbCenter));
+		for (int axis = 0; axis < 3; axis++)
+		{
+			float middle = (total.axisMinimum[axis] + total.axisMaximum[axis]) * 0.5f;
+			bounds.obbHalfExtents[axis] = (total.axisMaximum[axis] - total.axisMinimum[axis]) * 0.5f;
+			for (int component = 0; component < 3; component++)
+			{
+				bounds.obbCenter[component] += middle * axes[axis][component];
+			}
+		}
+	}
+}
@@ -0,0 +1,37 @@
+//// Declaration Guards
+#ifndef BOUNDS_H
+#define BOUNDS_H
+
+//// Imports
+#include <stddef.h>
+
+namespace SWPTAS001
+{
+	//// Structures
+	struct MeshBounds
+	{
+		float aabbMin[3];
+		float aabbMax[3];
+		float sphereCenter[3];
+		float sphereRadius;
+		float obbCenter[3];
+		float obbHalfExtents[3];
+		float obbAxes[3][3]; // unit axes, obbAxes[0] has the largest spread
+	};
+
+	//// Bounds Routines
+	void computeMeshBounds(const float* positions, size_t vertexCount, bool orientedBox, int threadCount, MeshBounds& bounds);
+}
+
+#endif
+
+// NOTE: computeMeshBounds() reads the xyz position stream twice, 4 vertices at a time with SSE2 where
+//       available. The first pass finds the axis aligned box together with the mean and covariance of
+//       the positions, and the second measures the sphere and oriented box around what the first found
+// NOTE: The sphere is centred on whichever of the box centre, the mean and the point halfway between
+//       them gives the smallest radius, and its radius is the distance to the farthest vertex, so it
+//       always contains the mesh
+// NOTE: The oriented box is aligned with the principal axes of the positions (the eigenvectors of their
+//       covariance), which is a lot tighter than the axis aligned box for elongated meshes at an angle.
+//       When it isn't any smaller (or without orientedBox) it is just the axis aligned box
+// NOTE: Empty meshes get all-zero bounds (with identity axes)
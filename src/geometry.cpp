@@ -1,267 +1,1119 @@
 //// Header
 #include "geometry.h"
 
+//// Imports
+#include "mappedfile.h"
+#include "objscanner.h"
+#include "parallel.h"
+#include "tangents.h"
+#include "quantize.h"
+#include "meshopt.h"
+#include "simplify.h"
+#include "bounds.h"
+#include "normals.h"
+#include <chrono>
+#include <algorithm>
+#include <string.h>
+#include <limits.h>
+
+//// Configurations
+#if defined(__AVX2__)
+#define GEOMETRY_AVX2
+#include <immintrin.h>
+#endif
+
 //// Namespaces
 using namespace std;
 
 namespace SWPTAS001
 {
 	/////////////
-	// Loaders //
+	// Helpers //
 	/////////////
 
-	void GeometryData::loadFromOBJFile(string filename)
+	static bool faceIndicesValid(const FaceData& face, const OBJRecordCounts& counts, bool hasTextureCoords, bool hasNormals)
+	{
+		for (int index = 0; index < 3; index++)
+		{
+			if ((face.vertexIndex[index] < 0) || ((size_t)face.vertexIndex[index] >= counts.vertices))
+			{
+				return false;
+			}
+			if (hasTextureCoords && ((face.texCoordIndex[index] < 0) || ((size_t)face.texCoordIndex[index] >= counts.textureCoords)))
+			{
+				return false;
+			}
+			if (hasNormals && ((face.normalIndex[index] < 0) || ((size_t)face.normalIndex[index] >= counts.normals)))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	static const unsigned int EMPTY_VERTEX_SLOT = 0xFFFFFFFF;
+	static const int VERTEX_CACHE_SIZE = 16;
+	static const float OVERDRAW_THRESHOLD = 1.05f;
+	static const size_t GATHER_BLOCK_SIZE = 16384;
+
+	// Hashes the loader settings that change what ends up in the cache, so one built with others is passed over
+	static unsigned long long hashLoaderSettings(const LoaderSettings& settings, bool streamed)
 	{
-		GeometryData tempGeom;
+		// NOTE: Any level count below 2 builds the same single level, and any angle from 180 up smooths every edge
+		unsigned long long keyParts[7] = {settings.qtangents, settings.optimizeMesh, (unsigned long long)max(settings.lodLevels, 1), 0, streamed,
+			settings.buildMeshlets, settings.orientedBounds};
+		float creaseAngle = min(settings.creaseAngle, 180.0f);
+		memcpy(&keyParts[3], &creaseAngle, sizeof(float));
+		return hashBytes(keyParts, sizeof(keyParts));
+	}
 
-		ifstream inStream;
-		inStream.open(filename, ifstream::in);
-		if (inStream.fail())
+	// Moves every used vertex's components to its remapped slot, dropping unused vertices
+	static void remapAttribute(ArenaVector<float>& attribute, const vector<unsigned int>& remap, int components, size_t usedCount)
+	{
+		// NOTE: Remapped from a copy back into the same array, so no arena memory is left behind
+		if (attribute.empty())
 		{
-			cout << "Unable to open obj file: " << filename << endl;
 			return;
 		}
+		vector<float> original(attribute.begin(), attribute.end());
+		for (size_t vertIndex = 0; vertIndex < remap.size(); vertIndex++)
+		{
+			if (remap[vertIndex] < usedCount)
+			{
+				memcpy(&attribute[remap[vertIndex] * components], &original[vertIndex * components], components * sizeof(float));
+			}
+		}
+		attribute.resize(usedCount * components);
+	}
 
-		OBJDataType currentDataType = NONE;
-		while (!inStream.eof())
+	// Copies every vertex's components out of an attribute pool, picking the pool entry from one slot of its v/vt/vn triple
+	static void gatherAttribute(const float* pool, size_t poolCount, int components, const int* triples, int tripleSlot,
+		size_t vertexCount, float* destination, int threadCount)
+	{
+		size_t blockCount = (vertexCount + GATHER_BLOCK_SIZE - 1) / GATHER_BLOCK_SIZE;
+		parallelFor(blockCount, threadCount, [&](size_t block)
 		{
-			switch (currentDataType)
+			size_t vertIndex = block * GATHER_BLOCK_SIZE;
+			size_t blockEnd = min(vertexCount, vertIndex + GATHER_BLOCK_SIZE);
+#ifdef GEOMETRY_AVX2
+			// NOTE: 8 vertices at a time: one gather fetches their pool entries, and then one gather per component
+			//       fetches 8 values already in output order, each lane picking its vertex with a permute
+			if ((poolCount * components) <= INT_MAX)
 			{
-			case NONE:
+				const __m256i tripleOffsets = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+				__m256i lanePermutes[3];
+				__m256i laneComponents[3];
+				for (int store = 0; store < components; store++)
+				{
+					int permutes[8];
+					int laneComponent[8];
+					for (int lane = 0; lane < 8; lane++)
+					{
+						permutes[lane] = ((8 * store) + lane) / components;
+						laneComponent[lane] = ((8 * store) + lane) % components;
+					}
+					lanePermutes[store] = _mm256_loadu_si256((const __m256i*)permutes);
+					laneComponents[store] = _mm256_loadu_si256((const __m256i*)laneComponent);
+				}
+				const __m256i poolLimit = _mm256_set1_epi32((int)poolCount);
+				for (; (vertIndex + 8) <= blockEnd; vertIndex += 8)
+				{
+					__m256i entries = _mm256_i32gather_epi32(triples + (3 * vertIndex) + tripleSlot, tripleOffsets, 4);
+					__m256i inPool = _mm256_and_si256(_mm256_cmpgt_epi32(entries, _mm256_set1_epi32(-1)), _mm256_cmpgt_epi32(poolLimit, entries));
+					if (_mm256_movemask_epi8(inPool) != -1)
+					{
+						break;
+					}
+					entries = _mm256_mullo_epi32(entries, _mm256_set1_epi32(components));
+					for (int store = 0; store < components; store++)
+					{
+						__m256i elements = _mm256_add_epi32(_mm256_permutevar8x32_epi32(entries, lanePermutes[store]), laneComponents[store]);
+						_mm256_storeu_ps(destination + (components * vertIndex) + (8 * store), _mm256_i32gather_ps(pool, elements, 4));
+					}
+				}
+			}
+#endif
+			// remaining vertices
+			// NOTE: Entries outside the pool (faces are validated first, so only ever from a bad caller) read as
+			//       zeros instead of past the pool, and the vector path leaves any 8 holding one to this loop
+			for (; vertIndex < blockEnd; vertIndex++)
 			{
-				inStream >> ws;
-				char typeChar1 = inStream.get();
-				if (inStream.eof())
+				int entry = triples[(3 * vertIndex) + tripleSlot];
+				if ((entry >= 0) && ((size_t)entry < poolCount))
 				{
-					break;
+					memcpy(destination + (components * vertIndex), pool + (components * entry), components * sizeof(float));
 				}
-				char typeChar2 = inStream.get();
-				if (typeChar1 == '#')
+				else
 				{
-					currentDataType = COMMENT;
+					memset(destination + (components * vertIndex), 0, components * sizeof(float));
 				}
-				else if (typeChar1 == 'f')
+			}
+		});
+	}
+
+	// Open addressing hash table mapping v/vt/vn triples to unique vertex indices
+	class VertexTable
+	{
+		public:
+			void reserve(size_t expectedCount)
+			{
+				size_t capacity = 64;
+				while (capacity < (expectedCount * 2))
 				{
-					currentDataType = FACE;
+					capacity *= 2;
 				}
-				else if (typeChar1 != 'v')
+				slots.assign(capacity, EMPTY_VERTEX_SLOT);
+				triples.reserve(expectedCount * 3);
+			}
+
+			unsigned int insert(int vertexIndex, int texCoordIndex, int normalIndex)
+			{
+				// grow at 50% load
+				if (((triples.size() / 3) + 1) * 2 > slots.size())
 				{
-					cout << "OBJ parse error: Expected 'v', 'f' or '#' at the start of the line" << endl;
-					cout << "Found: " << typeChar1 << typeChar2 << endl;
+					rehash(slots.size() * 2);
 				}
-				else
+				size_t mask = slots.size() - 1;
+				size_t slot = hashTriple(vertexIndex, texCoordIndex, normalIndex) & mask;
+				while (slots[slot] != EMPTY_VERTEX_SLOT)
 				{
-					if ((typeChar2 == ' ') || (typeChar2 == '\t'))
-					{
-						currentDataType = VERTEX;
-					}
-					else if (typeChar2 == 't')
-					{
-						currentDataType = TEXTURECOORD;
-					}
-					else if (typeChar2 == 'n')
+					const int* existing = &triples[3 * slots[slot]];
+					if ((existing[0] == vertexIndex) && (existing[1] == texCoordIndex) && (existing[2] == normalIndex))
 					{
-						currentDataType = NORMAL;
-					}
-					else if (typeChar2 == 'p')
-					{
-						cout << "OBJ parse error: Free-form geometry is not supported, ignoring" << endl;
-						currentDataType = COMMENT;
-					}
-					else
-					{
-						cout << "Unsupported data entry v" << (char)typeChar2 << ", ignoring" << endl;
-						currentDataType = COMMENT;
+						return slots[slot];
 					}
+					slot = (slot + 1) & mask;
 				}
+				unsigned int newIndex = (unsigned int)(triples.size() / 3);
+				slots[slot] = newIndex;
+				triples.push_back(vertexIndex);
+				triples.push_back(texCoordIndex);
+				triples.push_back(normalIndex);
+				return newIndex;
+			}
+
+			size_t size()
+			{
+				return triples.size() / 3;
+			}
+
+			void releaseTriples(vector<int>& destination)
+			{
+				destination.swap(triples);
+				triples.clear();
+				slots.clear();
+			}
+
+		private:
+			std::vector<unsigned int> slots;
+			std::vector<int> triples;
+
+			static size_t hashTriple(int vertexIndex, int texCoordIndex, int normalIndex)
+			{
+				unsigned long long hash = (unsigned int)vertexIndex * 0x9E3779B97F4A7C15ULL;
+				hash ^= (unsigned int)texCoordIndex * 0xC2B2AE3D27D4EB4FULL;
+				hash ^= (unsigned int)normalIndex * 0x165667B19E3779F9ULL;
+				return (size_t)(hash ^ (hash >> 29));
+			}
 
-			} break;
-
-			case VERTEX:
-			{
-				float x;
-				float y;
-				float z;
-				inStream >> x >> y >> z;
-				tempGeom.vertices.push_back(x);
-				tempGeom.vertices.push_back(y);
-				tempGeom.vertices.push_back(z);
-				currentDataType = COMMENT;
-			} break;
-
-			case TEXTURECOORD:
-			{
-				float u;
-				float v;
-				inStream >> u >> v;
-				tempGeom.textureCoords.push_back(u);
-				tempGeom.textureCoords.push_back(v);
-				currentDataType = COMMENT;
-			} break;
-
-			case NORMAL:
-			{
-				float x;
-				float y;
-				float z;
-				inStream >> x >> y >> z;
-				tempGeom.normals.push_back(x);
-				tempGeom.normals.push_back(y);
-				tempGeom.normals.push_back(z);
-				currentDataType = COMMENT;
-			} break;
-
-			case FACE:
-			{
-				// NOTE: Here is where we assume that exactly 3 vertices are used to specify a face
-				int vertIndex = 0;
-				int texCoordIndex = 0;
-				int normalIndex = 0;
-
-				FaceData face = {};
-				for (int index = 0; index<3; index++)
+			void rehash(size_t capacity)
+			{
+				slots.assign(capacity, EMPTY_VERTEX_SLOT);
+				size_t mask = capacity - 1;
+				for (size_t index = 0; index < (triples.size() / 3); index++)
 				{
-					inStream >> vertIndex;
-					char postVertexCheckChar = inStream.get();
-					if (postVertexCheckChar == '/')
+					size_t slot = hashTriple(triples[3 * index], triples[(3 * index) + 1], triples[(3 * index) + 2]) & mask;
+					while (slots[slot] != EMPTY_VERTEX_SLOT)
 					{
-						char texCoordExistCheckChar = inStream.get();
-						inStream.unget();
-						if (texCoordExistCheckChar != '/')
-						{
-							inStream >> texCoordIndex;
-						}
-
-						char postTexCoordCheckChar = inStream.get();
-						if (postTexCoordCheckChar == '/')
-						{
-							inStream >> normalIndex;
-						}
-						else
-						{
-							inStream.unget(); // This is just to prevent us from consuming a newline
-						}
+						slot = (slot + 1) & mask;
 					}
-
-					// NOTE: We subtract 1 here because the OBJ format uses 1-based indices
-					face.vertexIndex[index] = vertIndex - 1;
-					face.texCoordIndex[index] = texCoordIndex - 1;
-					face.normalIndex[index] = normalIndex - 1;
+					slots[slot] = (unsigned int)index;
 				}
-				tempGeom.faces.push_back(face);
-				currentDataType = COMMENT;
-			} break;
+			}
+	};
+
+	//////////////////
+	// Constructors //
+	//////////////////
+
+	GeometryData::GeometryData() : vertices(&meshArena), textureCoords(&meshArena), normals(&meshArena), tangents(&meshArena),
+		bitangents(&meshArena), qtangents(&meshArena)
+	{
+		memset(&meshHeader, 0, sizeof(MeshCacheHeader));
+		memset(&streams, 0, sizeof(MeshStreams));
+		memset(&bounds, 0, sizeof(MeshBounds));
+		meshHeader.indexSize = sizeof(unsigned int);
+		interleavedVertices = NULL;
+	}
+
+	/////////////
+	// Loaders //
+	/////////////
+
+	void GeometryData::loadFromOBJFile(string filename, LoaderSettings settings)
+	{
+		// reset
+		resetMesh();
 
-			case COMMENT:
+		// key the displacement, so a cache displaced any other way is passed over
+		unsigned long long displacementKey = 0;
+		if (!settings.displacementMap.empty() && (settings.displacementScale != 0.0f))
+		{
+			MappedFile mapFile;
+			if (mapFile.open(settings.displacementMap))
 			{
-				int nextChar = inStream.get();
-				if (nextChar == '\n')
-				{
-					currentDataType = NONE;
-				}
-			} break;
+				unsigned long long keyParts[2] = {hashBytes(mapFile.data(), mapFile.size()), 0};
+				memcpy(&keyParts[1], &settings.displacementScale, sizeof(float));
+				displacementKey = hashBytes(keyParts, sizeof(keyParts));
+			}
+			else
+			{
+				cout << "Unable to open displacement map: " << settings.displacementMap << endl;
+			}
+		}
+
+		// try the cache first
+		// NOTE: A streamed cache holds less than a full one (one level, no meshlets, vertices only shared within
+		//       a batch), so it is keyed apart and only taken by a load with a budget, while a full cache serves any
+		unsigned long long settingsKey = hashLoaderSettings(settings, false);
+		unsigned long long streamedKey = hashLoaderSettings(settings, true);
+		if (settings.useMeshCache && (loadFromMeshCache(filename, displacementKey, settingsKey) ||
+			((settings.memoryBudget > 0) && loadFromMeshCache(filename, displacementKey, streamedKey))))
+		{
+			return;
+		}
+
+		// map file
+		MappedFile objFile;
+		if (!objFile.open(filename))
+		{
+			cout << "Unable to open obj file: " << filename << endl;
+			return;
+		}
+
+		// stamp the source for the cache
+		SourceStamp sourceStamp;
+		if (settings.useMeshCache && readSourceStamp(filename, sourceStamp))
+		{
+			sourceStamp.hash = hashBytes(objFile.data(), objFile.size());
+		}
+		else
+		{
+			settings.useMeshCache = false;
+		}
+
+		// stream large meshes through the cache in bounded batches
+		if (settings.memoryBudget > 0)
+		{
+			if (!settings.useMeshCache)
+			{
+				cout << "    - Streaming needs the mesh cache, loading the whole mesh instead" << endl;
+			}
+			else if (displacementKey != 0)
+			{
+				cout << "    - Displacing needs the whole mesh, loading it whole" << endl;
+			}
+			else if (streamOBJFile(objFile, filename, sourceStamp, settings) && loadFromMeshCache(filename, 0, streamedKey))
+			{
+				return;
+			}
+			else
+			{
+				cout << "    - Streaming failed, loading the whole mesh instead" << endl;
+			}
+		}
+
+		// parse records, sizing every array exactly once
+		chrono::high_resolution_clock::time_point parseStart = chrono::high_resolution_clock::now();
+		MemoryArena loaderArena;
+		OBJRawData tempGeom(&loaderArena);
+		OBJRecordCounts recordCounts;
+		size_t parseChunks = parseOBJRecords(objFile.data(), objFile.end(), tempGeom, recordCounts, settings.threadCount);
+		double parseTime = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - parseStart).count();
+		cout << "    - Parsed " << (objFile.size() / 1024) << " KB in " << parseTime << " ms using "
+			<< parseChunks << " thread(s)" << endl;
+		objFile.close();
 
-			default:
-			{}
+		// build the indexed mesh
+		bool hasTextureCoords;
+		bool hasNormals;
+		chooseAttributes(recordCounts, hasTextureCoords, hasNormals);
+		resetAttributes(settings.qtangents && hasTextureCoords);
+		chrono::high_resolution_clock::time_point indexStart = chrono::high_resolution_clock::now();
+		vector<int> vertexTriples;
+		size_t invalidFaces = buildIndexedMesh(tempGeom.faces, recordCounts, hasTextureCoords, hasNormals, vertexTriples);
+		if (invalidFaces > 0)
+		{
+			cout << "OBJ parse error: Ignored " << invalidFaces << " faces referencing undefined data" << endl;
+		}
+		chrono::high_resolution_clock::time_point gatherStart = chrono::high_resolution_clock::now();
+		gatherAttributes(tempGeom, vertexTriples, hasTextureCoords, hasNormals, settings.threadCount);
+		chrono::high_resolution_clock::time_point gatherEnd = chrono::high_resolution_clock::now();
+		cout << "    - Indexed " << (indices.size() / 3) << " faces in " << chrono::duration<double, milli>(gatherStart - indexStart).count()
+			<< " ms, gathered " << (vertices.size() / 3) << " vertices in " << chrono::duration<double, milli>(gatherEnd - gatherStart).count()
+			<< " ms using " << resolveThreadCount(settings.threadCount) << " thread(s)" << endl;
+
+		// drop the parse temporaries in one step
+		vector<int>().swap(vertexTriples);
+		tempGeom = OBJRawData();
+		cout << "    - Loader arena: " << loaderArena.allocationCount() << " allocation(s), peak " << (loaderArena.peakBytes() / 1024)
+			<< " KB (" << (loaderArena.hugePageBytes() / 1024) << " KB on huge pages)" << endl;
+		loaderArena.release();
+
+		// generate missing normals
+		if (!hasNormals && !indices.empty())
+		{
+			generateNormals(settings.creaseAngle, settings.threadCount);
+			hasNormals = true;
+		}
+
+		// displace
+		if (displacementKey != 0)
+		{
+			HeightMap heightMap;
+			if (!hasTextureCoords || !hasNormals)
+			{
+				cout << "    - Displacing needs normals and texture coords, leaving the mesh as it is" << endl;
+				displacementKey = 0;
+			}
+			else if (loadHeightMap(settings.displacementMap, heightMap, settings.threadCount))
+			{
+				displaceVertices(heightMap, settings.displacementScale, settings.threadCount);
 			}
+			else
+			{
+				displacementKey = 0;
+			}
+		}
+
+		// optimize
+		if (settings.optimizeMesh)
+		{
+			chrono::high_resolution_clock::time_point optimizeStart = chrono::high_resolution_clock::now();
+			VertexCacheStats before;
+			VertexCacheStats after;
+			optimizeMesh(before, after);
+			double optimizeTime = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - optimizeStart).count();
+			cout << "    - Optimized in " << optimizeTime << " ms: ACMR " << before.acmr << " -> " << after.acmr
+				<< ", ATVR " << before.atvr << " -> " << after.atvr << endl;
 		}
+		size_t uniqueCount = vertices.size() / 3;
 
+		// cluster
+		if (settings.buildMeshlets)
+		{
+			groupMeshlets();
+		}
 
-		// NOTE: Since our rendering pipeline supports only 1 set of indices for our data, we need to
-		//       do some post-processing here in order to lay out all the unique v/vt/vn triples
-		// TODO: We're currently just assuming all the triples are distinct, but its probably worth doing
-		//       at least a little bit of checking on that front
-		// TODO: We're deciding whether or not to add texture coords and normals on a per-face basis,
-		//       which doesn't really make sense because if there are any then there should be for all
-		//       vertices, but this way that might not be the case
-		for (int faceIndex = 0; faceIndex<tempGeom.faces.size(); faceIndex++)
+		// compute the (bi)tangents
+		if (hasTextureCoords && hasNormals)
 		{
-			FaceData face = tempGeom.faces[faceIndex];
-			bool hasTextureCoords = (face.texCoordIndex[0] >= 0);
-			bool hasNormals = (face.normalIndex[0] >= 0);
-			for (int vertIndex = 0; vertIndex<3; vertIndex++)
+			computeTangents(settings.threadCount);
+			if (settings.qtangents)
 			{
-				for (int i = 0; i<3; i++)
-				{
-					vertices.push_back(tempGeom.vertices[(3 * face.vertexIndex[vertIndex]) + i]);
-				}
+				encodeQTangents(settings.threadCount);
+			}
+		}
+		size_t fullIndexCount = indices.size();
+
+		// simplify
+		if (settings.lodLevels > 1)
+		{
+			buildLODChain(settings.lodLevels);
+		}
 
-				if (hasTextureCoords)
+		// finalize indices
+		buildCompactIndices();
+		computeBounds(settings.orientedBounds, settings.threadCount);
+		publishStreams();
+		meshHeader.displacement = displacementKey;
+		meshHeader.settings = settingsKey;
+
+		// report
+		size_t bytesPerVertex = sizeof(float) * (3 + (hasTextureCoords ? 2 : 0) + (hasNormals ? 3 : 0) +
+			((hasTextureCoords && hasNormals) ? 6 : 0));
+		size_t expandedBytes = fullIndexCount * bytesPerVertex;
+		size_t indexedBytes = (uniqueCount * bytesPerVertex) + (fullIndexCount * indexSize());
+		cout << "    - Successfully loaded an OBJ with " << uniqueCount << " unique vertices and " << fullIndexCount / 3 << " faces" << endl;
+		cout << "    - Indexing reduced vertex data from " << (expandedBytes / 1024) << " KB to " << (indexedBytes / 1024)
+			<< " KB (" << indexSize() * 8 << "-bit indices)" << endl;
+		cout << "    - Mesh arena: " << meshArena.allocationCount() << " allocation(s), peak " << (meshArena.peakBytes() / 1024)
+			<< " KB, " << (meshArena.bytesInUse() / 1024) << " KB in use" << endl;
+
+		// cache
+		if (settings.useMeshCache)
+		{
+			saveToMeshCache(filename, sourceStamp);
+		}
+	}
+
+	bool GeometryData::streamOBJFile(MappedFile& objFile, string filename, const SourceStamp& stamp, LoaderSettings settings)
+	{
+		// pass 1: gather only the v/vt/vn pools
+		chrono::high_resolution_clock::time_point streamStart = chrono::high_resolution_clock::now();
+		MemoryArena loaderArena;
+		OBJRawData pools(&loaderArena);
+		OBJRecordCounts recordCounts;
+		parseOBJRecords(objFile.data(), objFile.end(), pools, recordCounts, settings.threadCount, POOL_RECORDS);
+		objFile.discard(objFile.data(), objFile.end());
+		bool hasTextureCoords;
+		bool hasNormals;
+		chooseAttributes(recordCounts, hasTextureCoords, hasNormals);
+		if (!hasNormals)
+		{
+			cout << "    - Generating normals needs the whole mesh" << endl;
+			return false;
+		}
+
+		// size the batches to fit whatever the pools leave of the budget
+		// NOTE: Per face, a batch holds the FaceData, and per corner at most one index, one vertex table
+		//       entry (2 slots + a triple) and one output vertex with every attribute
+		const size_t bytesPerFace = sizeof(FaceData) + (3 * ((3 * sizeof(unsigned int)) + (3 * sizeof(int)) + (14 * sizeof(float))));
+		const size_t minimumBatchFaces = 4096;
+		size_t poolBytes = (pools.vertices.size() + pools.textureCoords.size() + pools.normals.size()) * sizeof(float);
+		size_t batchFaces = (settings.memoryBudget > poolBytes) ? ((settings.memoryBudget - poolBytes) / bytesPerFace) : 0;
+		if (batchFaces < minimumBatchFaces)
+		{
+			cout << "    - Memory budget of " << (settings.memoryBudget >> 20) << " MB is too small for "
+				<< (poolBytes >> 20) << " MB of vertex pools, using " << minimumBatchFaces << " face batches" << endl;
+			batchFaces = minimumBatchFaces;
+		}
+
+		// pass 2: index each batch of faces and spool it into the cache
+		// NOTE: Vertices are only shared within a batch, so a vertex used on both sides of a batch
+		//       boundary is written once per batch, and its tangent only averages that batch's faces
+		MeshCacheWriter writer;
+		if (!writer.begin(filename))
+		{
+			return false;
+		}
+		MeshCacheHeader header = {};
+		header.settings = hashLoaderSettings(settings, true);
+		// NOTE: The position pool holds every position any batch can use, so the bounds are taken from it
+		//       up front (an unused position can only make them a little larger than needed)
+		computeMeshBounds(pools.vertices.data(), pools.vertices.size() / 3, settings.orientedBounds, settings.threadCount, header.bounds);
+		OBJRecordCounts batchOrigin = {};
+		const char* batchBegin = objFile.data();
+		size_t vertexBase = 0;
+		size_t indexTotal = 0;
+		size_t batchCount = 0;
+		size_t invalidFaces = 0;
+		double missesBefore = 0.0;
+		double missesAfter = 0.0;
+		MemoryArena batchArena;
+		while (batchBegin < objFile.end())
+		{
+			// NOTE: Each batch starts from empty arenas, the previous batch having been spooled
+			batchArena.release();
+			resetAttributes(settings.qtangents && hasTextureCoords && hasNormals);
+
+			// parse
+			OBJRecordCounts nextOrigin = batchOrigin;
+			const char* batchEnd = findOBJBatchEnd(batchBegin, objFile.end(), batchFaces, nextOrigin);
+			OBJRawData batchGeom(&batchArena);
+			OBJRecordCounts batchCounts;
+			parseOBJRecords(batchBegin, batchEnd, batchGeom, batchCounts, settings.threadCount, FACE_RECORDS, batchOrigin);
+			objFile.discard(batchBegin, batchEnd);
+
+			// index
+			vector<int> vertexTriples;
+			invalidFaces += buildIndexedMesh(batchGeom.faces, recordCounts, hasTextureCoords, hasNormals, vertexTriples);
+			gatherAttributes(pools, vertexTriples, hasTextureCoords, hasNormals, settings.threadCount);
+			if (settings.optimizeMesh)
+			{
+				VertexCacheStats before;
+				VertexCacheStats after;
+				optimizeMesh(before, after);
+				missesBefore += before.acmr * (indices.size() / 3);
+				missesAfter += after.acmr * (indices.size() / 3);
+			}
+			if (hasTextureCoords && hasNormals)
+			{
+				computeTangents(settings.threadCount);
+				if (settings.qtangents)
 				{
-					for (int i = 0; i<2; i++)
-					{
-						textureCoords.push_back(
-							tempGeom.textureCoords[(2 * face.texCoordIndex[vertIndex]) + i]);
-					}
+					encodeQTangents(settings.threadCount);
 				}
-				if (hasNormals)
+			}
+			for (size_t i = 0; i < indices.size(); i++)
+			{
+				indices[i] += (unsigned int)vertexBase;
+			}
+
+			// spool
+			bool appended = writer.append(POSITION_STREAM, vertices.data(), vertices.size() * sizeof(float));
+			appended = appended && writer.append(NORMAL_STREAM, normals.data(), normals.size() * sizeof(float));
+			appended = appended && writer.append(TEXCOORD_STREAM, textureCoords.data(), textureCoords.size() * sizeof(float));
+			appended = appended && writer.append(TANGENT_STREAM, tangents.data(), tangents.size() * sizeof(float));
+			appended = appended && writer.append(BITANGENT_STREAM, bitangents.data(), bitangents.size() * sizeof(float));
+			appended = appended && writer.append(QTANGENT_STREAM, qtangents.data(), qtangents.size() * sizeof(short));
+			appended = appended && writer.append(INDEX_STREAM, indices.data(), indices.size() * sizeof(unsigned int));
+			if (!appended)
+			{
+				cout << "    - Unable to write mesh cache spool files" << endl;
+				return false;
+			}
+			vertexBase += vertices.size() / 3;
+			indexTotal += indices.size();
+			batchBegin = batchEnd;
+			batchOrigin = nextOrigin;
+			batchCount++;
+		}
+		if (invalidFaces > 0)
+		{
+			cout << "OBJ parse error: Ignored " << invalidFaces << " faces referencing undefined data" << endl;
+		}
+
+		// release the batch buffers before the cache gets mapped
+		resetAttributes(false);
+		vector<unsigned int>().swap(indices);
+
+		// assemble the cache
+		header.vertexCount = (unsigned int)vertexBase;
+		header.indexCount = (unsigned int)indexTotal;
+		header.indexSize = (vertexBase <= 65536) ? sizeof(unsigned short) : sizeof(unsigned int);
+		if (!writer.finish(stamp, header))
+		{
+			return false;
+		}
+		double streamTime = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - streamStart).count();
+		cout << "    - Streamed " << (objFile.size() / 1024) << " KB in " << streamTime << " ms as " << batchCount
+			<< " batch(es) of up to " << batchFaces << " faces (" << (poolBytes >> 20) << " MB of pools, "
+			<< (settings.memoryBudget >> 20) << " MB budget)" << endl;
+		cout << "    - Arenas: loader " << loaderArena.allocationCount() << " allocation(s) peaking at " << (loaderArena.peakBytes() / 1024)
+			<< " KB, batches " << batchArena.allocationCount() << " peaking at " << (batchArena.peakBytes() / 1024) << " KB, mesh "
+			<< meshArena.allocationCount() << " peaking at " << (meshArena.peakBytes() / 1024) << " KB" << endl;
+		if (settings.optimizeMesh && (indexTotal > 0))
+		{
+			cout << "    - Optimized every batch: ACMR " << (missesBefore / (indexTotal / 3)) << " -> " << (missesAfter / (indexTotal / 3))
+				<< ", ATVR " << (missesBefore / vertexBase) << " -> " << (missesAfter / vertexBase) << endl;
+		}
+		return true;
+	}
+
+	void GeometryData::resetMesh()
+	{
+		cacheFile.close();
+		resetAttributes(false);
+		indices.clear();
+		compactIndices.clear();
+		lods.clear();
+		meshlets.clear();
+		memset(&bounds, 0, sizeof(MeshBounds));
+		interleavedStorage.clear();
+		interleavedVertices = NULL;
+		quantizedVertices.clear();
+		publishStreams();
+	}
+
+	void GeometryData::chooseAttributes(const OBJRecordCounts& counts, bool& hasTextureCoords, bool& hasNormals)
+	{
+		// NOTE: Since our rendering pipeline supports only 1 set of indices, texture coords and normals are
+		//       only kept when every face references them, otherwise some vertices would be missing them
+		hasTextureCoords = (counts.texturedFaces > 0) && (counts.texturedFaces == counts.faces);
+		hasNormals = (counts.normalFaces > 0) && (counts.normalFaces == counts.faces);
+		if ((counts.texturedFaces > 0) && !hasTextureCoords)
+		{
+			cout << "OBJ parse error: Only some faces have texture coordinates, ignoring them" << endl;
+		}
+		if ((counts.normalFaces > 0) && !hasNormals)
+		{
+			cout << "OBJ parse error: Only some faces have normals, ignoring them" << endl;
+		}
+	}
+
+	void GeometryData::resetAttributes(bool temporaryFrames)
+	{
+		// NOTE: Frames that get encoded into QTangents right away come from the heap instead, so they
+		//       can really be freed once encoded rather than linger in the arena
+		ArenaAllocator<float> frameAllocator(temporaryFrames ? NULL : &meshArena);
+		ArenaVector<float>(&meshArena).swap(vertices);
+		ArenaVector<float>(&meshArena).swap(textureCoords);
+		ArenaVector<float>(frameAllocator).swap(normals);
+		ArenaVector<float>(frameAllocator).swap(tangents);
+		ArenaVector<float>(frameAllocator).swap(bitangents);
+		ArenaVector<short>(&meshArena).swap(qtangents);
+		meshArena.release();
+	}
+
+	size_t GeometryData::buildIndexedMesh(const ArenaVector<FaceData>& faces, const OBJRecordCounts& counts, bool hasTextureCoords,
+		bool hasNormals, vector<int>& vertexTriples)
+	{
+		// build the unique vertex table
+		// NOTE: Every distinct v/vt/vn triple becomes one output vertex, shared by every face corner
+		//       that references it, and the faces themselves become an index buffer
+		VertexTable vertexTable;
+		vertexTable.reserve(min(faces.size() * 3, max(counts.vertices, max(counts.textureCoords, counts.normals))));
+		indices.clear();
+		indices.reserve(faces.size() * 3);
+		size_t invalidFaces = 0;
+		for (size_t faceIndex = 0; faceIndex < faces.size(); faceIndex++)
+		{
+			const FaceData& face = faces[faceIndex];
+			if (!faceIndicesValid(face, counts, hasTextureCoords, hasNormals))
+			{
+				invalidFaces++;
+				continue;
+			}
+			for (int vertIndex = 0; vertIndex < 3; vertIndex++)
+			{
+				indices.push_back(vertexTable.insert(face.vertexIndex[vertIndex],
+					hasTextureCoords ? face.texCoordIndex[vertIndex] : -1,
+					hasNormals ? face.normalIndex[vertIndex] : -1));
+			}
+		}
+		vertexTable.releaseTriples(vertexTriples);
+		return invalidFaces;
+	}
+
+	void GeometryData::gatherAttributes(const OBJRawData& pools, const vector<int>& vertexTriples, bool hasTextureCoords,
+		bool hasNormals, int threadCount)
+	{
+		// NOTE: Every output vertex is written exactly once from its own triple, so the blocks are independent
+		//       and the result is the same whatever the thread count or instruction set
+		size_t uniqueCount = vertexTriples.size() / 3;
+		const int* triples = vertexTriples.empty() ? NULL : &vertexTriples[0];
+		vertices.resize(uniqueCount * 3);
+		textureCoords.resize(hasTextureCoords ? uniqueCount * 2 : 0);
+		normals.resize(hasNormals ? uniqueCount * 3 : 0);
+		gatherAttribute(pools.vertices.data(), pools.vertices.size() / 3, 3, triples, 0, uniqueCount, vertices.data(), threadCount);
+		if (hasTextureCoords)
+		{
+			gatherAttribute(pools.textureCoords.data(), pools.textureCoords.size() / 2, 2, triples, 1, uniqueCount, textureCoords.data(), threadCount);
+		}
+		if (hasNormals)
+		{
+			gatherAttribute(pools.normals.data(), pools.normals.size() / 3, 3, triples, 2, uniqueCount, normals.data(), threadCount);
+		}
+	}
+
+	bool GeometryData::loadFromMeshCache(string filename, unsigned long long displacementKey, unsigned long long settingsKey)
+	{
+		chrono::high_resolution_clock::time_point loadStart = chrono::high_resolution_clock::now();
+		MeshStreams cachedStreams;
+		MeshCacheHeader cachedHeader;
+		if (!openMeshCache(filename, cacheFile, cachedHeader, cachedStreams))
+		{
+			return false;
+		}
+		if ((cachedHeader.displacement != displacementKey) || (cachedHeader.settings != settingsKey))
+		{
+			cacheFile.close();
+			return false;
+		}
+		// NOTE: A cache whose streams disagree with its own header is treated like a stale one
+		size_t vertexBytes = cachedHeader.vertexCount * 3 * sizeof(float);
+		if ((cachedStreams.size[POSITION_STREAM] != vertexBytes) ||
+			((cachedHeader.indexSize != sizeof(unsigned short)) && (cachedHeader.indexSize != sizeof(unsigned int))) ||
+			(cachedStreams.size[INDEX_STREAM] != (cachedHeader.indexCount * cachedHeader.indexSize)) ||
+			((cachedStreams.size[LOD_STREAM] % sizeof(MeshLOD)) != 0) ||
+			((cachedStreams.size[MESHLET_STREAM] % sizeof(Meshlet)) != 0))
+		{
+			cacheFile.close();
+			return false;
+		}
+		// NOTE: Meshlets have to lie within the first level, which is the whole index stream without a level table
+		size_t meshletLimit = (cachedStreams.size[LOD_STREAM] >= sizeof(MeshLOD)) ?
+			((const MeshLOD*)cachedStreams.data[LOD_STREAM])[0].indexCount : cachedHeader.indexCount;
+		const Meshlet* cachedMeshlets = (const Meshlet*)cachedStreams.data[MESHLET_STREAM];
+		for (size_t m = 0; m < (cachedStreams.size[MESHLET_STREAM] / sizeof(Meshlet)); m++)
+		{
+			if ((cachedMeshlets[m].indexOffset > meshletLimit) || ((3 * (size_t)cachedMeshlets[m].triangleCount) > (meshletLimit - cachedMeshlets[m].indexOffset)))
+			{
+				cacheFile.close();
+				return false;
+			}
+		}
+		const MeshLOD* cachedLODs = (const MeshLOD*)cachedStreams.data[LOD_STREAM];
+		for (size_t level = 0; level < (cachedStreams.size[LOD_STREAM] / sizeof(MeshLOD)); level++)
+		{
+			if ((cachedLODs[level].indexOffset > cachedHeader.indexCount) ||
+				(cachedLODs[level].indexCount > (cachedHeader.indexCount - cachedLODs[level].indexOffset)))
+			{
+				cacheFile.close();
+				return false;
+			}
+		}
+		meshHeader = cachedHeader;
+		streams = cachedStreams;
+		double loadTime = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - loadStart).count();
+		cout << "    - Mapped mesh cache " << meshCachePath(filename) << " (" << (cacheFile.size() / 1024) << " KB) in "
+			<< loadTime << " ms" << endl;
+		cout << "    - Successfully loaded an OBJ with " << vertexCount() << " unique vertices and " << indexCount() / 3 << " faces" << endl;
+		return true;
+	}
+
+	void GeometryData::saveToMeshCache(string filename, const SourceStamp& stamp)
+	{
+		if (writeMeshCache(filename, stamp, meshHeader, streams))
+		{
+			cout << "    - Wrote mesh cache " << meshCachePath(filename) << endl;
+		}
+	}
+
+	void GeometryData::generateNormals(float creaseAngle, int threadCount)
+	{
+		// NOTE: Pooled by position alone, so vertices only split by their texture coords shade as one
+		chrono::high_resolution_clock::time_point generateStart = chrono::high_resolution_clock::now();
+		size_t vertexTotal = vertices.size() / 3;
+		vector<unsigned int> positionGroups;
+		weldVertices(vertices.data(), NULL, vertexTotal, positionGroups);
+		if (creaseAngle >= 180.0f)
+		{
+			normals.assign(vertexTotal * 3, 0.0f);
+			generateVertexNormals(vertices.data(), vertexTotal, indices.data(), indices.size(), positionGroups.data(), normals.data(), threadCount);
+			double generateTime = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - generateStart).count();
+			cout << "    - Generated smooth normals for " << vertexTotal << " vertices in " << generateTime << " ms" << endl;
+			return;
+		}
+		vector<float> cornerNormals(indices.size() * 3);
+		generateCornerNormals(vertices.data(), vertexTotal, indices.data(), indices.size(), positionGroups.data(),
+			cosf(creaseAngle * 3.14159265f / 180.0f), cornerNormals.data(), threadCount);
+
+		// give every vertex the normal of its first corner, corners that disagree take (or make) a copy of it
+		// NOTE: Corners smoothed over the same faces get bit-identical sums, so an exact match is enough
+		const unsigned int NO_COPY = UINT_MAX;
+		vector<float> vertexNormals(vertexTotal * 3, 0.0f);
+		vector<unsigned char> assigned(vertexTotal, 0);
+		vector<unsigned int> nextCopy(vertexTotal, NO_COPY);
+		vector<unsigned int> copySources;
+		for (size_t corner = 0; corner < indices.size(); corner++)
+		{
+			const float* normal = &cornerNormals[3 * corner];
+			unsigned int vertIndex = indices[corner];
+			if ((normal[0] == 0.0f) && (normal[1] == 0.0f) && (normal[2] == 0.0f))
+			{
+				continue;
+			}
+			if (!assigned[vertIndex])
+			{
+				copy(normal, normal + 3, &vertexNormals[3 * vertIndex]);
+				assigned[vertIndex] = 1;
+				continue;
+			}
+			unsigned int target = vertIndex;
+			while (!equal(normal, normal + 3, &vertexNormals[3 * target]) && (nextCopy[target] != NO_COPY))
+			{
+				target = nextCopy[target];
+			}
+			if (!equal(normal, normal + 3, &vertexNormals[3 * target]))
+			{
+				unsigned int copyIndex = (unsigned int)(vertexTotal + copySources.size());
+				copySources.push_back(vertIndex);
+				vertexNormals.insert(vertexNormals.end(), normal, normal + 3);
+				nextCopy.push_back(NO_COPY);
+				nextCopy[target] = copyIndex;
+				target = copyIndex;
+			}
+			indices[corner] = target;
+		}
+
+		// append the copies
+		size_t copyCount = copySources.size();
+		vertices.resize((vertexTotal + copyCount) * 3);
+		textureCoords.resize(textureCoords.empty() ? 0 : ((vertexTotal + copyCount) * 2));
+		for (size_t copyIndex = 0; copyIndex < copyCount; copyIndex++)
+		{
+			size_t source = copySources[copyIndex];
+			copy(&vertices[3 * source], &vertices[3 * source] + 3, &vertices[3 * (vertexTotal + copyIndex)]);
+			if (!textureCoords.empty())
+			{
+				copy(&textureCoords[2 * source], &textureCoords[2 * source] + 2, &textureCoords[2 * (vertexTotal + copyIndex)]);
+			}
+		}
+		normals.assign(vertexNormals.begin(), vertexNormals.end());
+		double generateTime = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - generateStart).count();
+		cout << "    - Generated normals creased at " << creaseAngle << " degrees for " << vertexTotal << " vertices in "
+			<< generateTime << " ms, splitting off " << copyCount << " more" << endl;
+	}
+
+	void GeometryData::displaceVertices(const HeightMap& map, float scale, int threadCount)
+	{
+		// sample every vertex's height
+		chrono::high_resolution_clock::time_point displaceStart = chrono::high_resolution_clock::now();
+		size_t vertexTotal = vertices.size() / 3;
+		size_t blockCount = (vertexTotal + GATHER_BLOCK_SIZE - 1) / GATHER_BLOCK_SIZE;
+		vector<float> heights(vertexTotal);
+		parallelFor(blockCount, threadCount, [&](size_t block)
+		{
+			size_t first = block * GATHER_BLOCK_SIZE;
+			sampleHeights(map, &textureCoords[2 * first], min(vertexTotal - first, GATHER_BLOCK_SIZE), &heights[first]);
+		});
+
+		// pool the heights and normals of vertices sharing a position
+		vector<unsigned int> positionGroups;
+		weldVertices(vertices.data(), NULL, vertexTotal, positionGroups);
+		vector<float> groupSums(vertexTotal * 5, 0.0f);
+		size_t groupCount = 0;
+		for (size_t vertIndex = 0; vertIndex < vertexTotal; vertIndex++)
+		{
+			float* sum = &groupSums[5 * positionGroups[vertIndex]];
+			groupCount += (positionGroups[vertIndex] == vertIndex);
+			sum[0] += normals[3 * vertIndex];
+			sum[1] += normals[(3 * vertIndex) + 1];
+			sum[2] += normals[(3 * vertIndex) + 2];
+			sum[3] += heights[vertIndex];
+			sum[4] += 1.0f;
+		}
+
+		// move each vertex by its group's average height along the group's average normal
+		parallelFor(blockCount, threadCount, [&](size_t block)
+		{
+			for (size_t vertIndex = block * GATHER_BLOCK_SIZE; vertIndex < min(vertexTotal, (block + 1) * GATHER_BLOCK_SIZE); vertIndex++)
+			{
+				const float* sum = &groupSums[5 * positionGroups[vertIndex]];
+				float length = sqrtf((sum[0] * sum[0]) + (sum[1] * sum[1]) + (sum[2] * sum[2]));
+				float offset = (length > 0.0f) ? ((sum[3] / sum[4]) * scale / length) : 0.0f;
+				vertices[3 * vertIndex] += sum[0] * offset;
+				vertices[(3 * vertIndex) + 1] += sum[1] * offset;
+				vertices[(3 * vertIndex) + 2] += sum[2] * offset;
+			}
+		});
+
+		// the displaced faces give the new normals
+		// NOTE: Pooled across vertices sharing a position and a normal, which keeps hard edges hard
+		vector<unsigned int> frameGroups;
+		weldVertices(vertices.data(), normals.data(), vertexTotal, frameGroups);
+		generateVertexNormals(vertices.data(), vertexTotal, indices.data(), indices.size(), frameGroups.data(), normals.data(), threadCount);
+		double displaceTime = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - displaceStart).count();
+		cout << "    - Displaced " << vertexTotal << " vertices (" << groupCount << " positions) by up to " << scale
+			<< " along their normals in " << displaceTime << " ms" << endl;
+	}
+
+	void GeometryData::optimizeMesh(VertexCacheStats& before, VertexCacheStats& after)
+	{
+		// reorder triangles
+		size_t vertexTotal = vertices.size() / 3;
+		before = analyzeVertexCache(indices.data(), indices.size(), vertexTotal, VERTEX_CACHE_SIZE);
+		optimizeVertexCache(indices.data(), indices.size(), vertexTotal, VERTEX_CACHE_SIZE);
+		optimizeOverdraw(indices.data(), indices.size(), vertices.data(), vertexTotal, VERTEX_CACHE_SIZE, OVERDRAW_THRESHOLD);
+		after = analyzeVertexCache(indices.data(), indices.size(), vertexTotal, VERTEX_CACHE_SIZE);
+
+		// reorder vertices to match
+		vector<unsigned int> remap;
+		size_t usedCount = optimizeVertexFetch(indices.data(), indices.size(), vertexTotal, remap);
+		remapAttribute(vertices, remap, 3, usedCount);
+		remapAttribute(textureCoords, remap, 2, usedCount);
+		remapAttribute(normals, remap, 3, usedCount);
+	}
+
+	void GeometryData::groupMeshlets()
+	{
+		// NOTE: Only the full detail level is grouped, coarser levels may already follow it in the buffer
+		size_t fullIndexCount = lods.empty() ? indices.size() : lods[0].indexCount;
+		chrono::high_resolution_clock::time_point groupStart = chrono::high_resolution_clock::now();
+		buildMeshlets(indices.data(), fullIndexCount, vertices.data(), vertices.size() / 3, meshlets);
+		double groupTime = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - groupStart).count();
+		size_t meshletVertices = 0;
+		for (size_t m = 0; m < meshlets.size(); m++)
+		{
+			meshletVertices += meshlets[m].vertexCount;
+		}
+		cout << "    - Grouped " << (fullIndexCount / 3) << " faces into " << meshlets.size() << " meshlets in " << groupTime
+			<< " ms (" << ((float)fullIndexCount / 3 / max(meshlets.size(), (size_t)1)) << " faces and "
+			<< ((float)meshletVertices / max(meshlets.size(), (size_t)1)) << " vertices each on average)" << endl;
+	}
+
+	void GeometryData::computeTangents(int threadCount)
+	{
+		tangents.resize(vertices.size());
+		bitangents.resize(vertices.size());
+		generateTangentFrames(vertices.data(), normals.data(), textureCoords.data(), vertices.size() / 3,
+			indices.data(), indices.size(), tangents.data(), bitangents.data(), threadCount);
+	}
+
+	void GeometryData::encodeQTangents(int threadCount)
+	{
+		// NOTE: Replaces the normal, tangent and bitangent streams (36 bytes per vertex) with one
+		//       QTangent (8 bytes per vertex), keeping track of how far the decoded frames turn
+		size_t vertexTotal = vertices.size() / 3;
+		qtangents.resize(vertexTotal * 4);
+		size_t blockCount = (vertexTotal + GATHER_BLOCK_SIZE - 1) / GATHER_BLOCK_SIZE;
+		vector<float> blockCosines(blockCount, 1.0f);
+		parallelFor(blockCount, threadCount, [&](size_t block)
+		{
+			for (size_t vertIndex = block * GATHER_BLOCK_SIZE; vertIndex < min(vertexTotal, (block + 1) * GATHER_BLOCK_SIZE); vertIndex++)
+			{
+				const float* frame[3] = {&normals[3 * vertIndex], &tangents[3 * vertIndex], &bitangents[3 * vertIndex]};
+				packQTangent(frame[0], frame[1], frame[2], &qtangents[4 * vertIndex]);
+				float decoded[3][3];
+				unpackQTangent(&qtangents[4 * vertIndex], decoded[0], decoded[1], decoded[2]);
+				for (int direction = 0; direction < 3; direction++)
 				{
-					for (int i = 0; i<3; i++)
+					const float* value = frame[direction];
+					float valueLength = sqrtf((value[0] * value[0]) + (value[1] * value[1]) + (value[2] * value[2]));
+					if (valueLength > 0.0f)
 					{
-						normals.push_back(tempGeom.normals[(3 * face.normalIndex[vertIndex]) + i]);
+						float cosine = ((decoded[direction][0] * value[0]) + (decoded[direction][1] * value[1]) + (decoded[direction][2] * value[2])) / valueLength;
+						blockCosines[block] = min(blockCosines[block], cosine);
 					}
 				}
 			}
+		});
+		float directionCosine = blockCosines.empty() ? 1.0f : *min_element(blockCosines.begin(), blockCosines.end());
+		ArenaVector<float>(normals.get_allocator()).swap(normals);
+		ArenaVector<float>(tangents.get_allocator()).swap(tangents);
+		ArenaVector<float>(bitangents.get_allocator()).swap(bitangents);
+		cout << "    - Encoded " << vertexTotal << " tangent frames as QTangents (" << ((vertexTotal * 36) / 1024) << " KB to "
+			<< ((vertexTotal * 8) / 1024) << " KB, at most " << (acosf(max(-1.0f, min(directionCosine, 1.0f))) * 180.0f / 3.14159265f)
+			<< " degrees off)" << endl;
+	}
 
-			// Compute the (bi)tangent for the face, and add it for each vertex
-			if (hasTextureCoords && hasNormals)
+	void GeometryData::buildLODChain(int levelCount)
+	{
+		// NOTE: Every level is simplified from the one before it, so its error builds on the previous level's
+		chrono::high_resolution_clock::time_point simplifyStart = chrono::high_resolution_clock::now();
+		size_t vertexTotal = vertices.size() / 3;
+		MeshLOD fullDetail = {0, (unsigned int)indices.size(), 0.0f, 0};
+		lods.assign(1, fullDetail);
+		vector<unsigned int> levelIndices(indices.size());
+		for (int level = 1; level < levelCount; level++)
+		{
+			MeshLOD previous = lods.back();
+			float levelError;
+			size_t targetIndexCount = ((previous.indexCount / 3) / 2) * 3;
+			size_t levelIndexCount = simplifyMesh(&indices[previous.indexOffset], previous.indexCount, vertices.data(), vertexTotal,
+				targetIndexCount, levelIndices.data(), levelError);
+			// stop once a level hardly gets any smaller
+			if ((levelIndexCount == 0) || (levelIndexCount > ((previous.indexCount * 3) / 4)))
 			{
-				int vertexStartIndex = vertices.size() - 9;
-				int uvStartIndex = textureCoords.size() - 6;
-				float* vertices = &this->vertices[vertexStartIndex];
-				float* texCoords = &textureCoords[uvStartIndex];
-
-				float deltaX1 = vertices[3] - vertices[0];
-				float deltaY1 = vertices[4] - vertices[1];
-				float deltaZ1 = vertices[5] - vertices[2];
-				float deltaX2 = vertices[6] - vertices[0];
-				float deltaY2 = vertices[7] - vertices[1];
-				float deltaZ2 = vertices[8] - vertices[2];
-
-				float deltaU1 = texCoords[2] - texCoords[0];
-				float deltaV1 = texCoords[3] - texCoords[1];
-				float deltaU2 = texCoords[4] - texCoords[0];
-				float deltaV2 = texCoords[5] - texCoords[1];
-
-				float inverseDet = 1.0f / (deltaU1*deltaV2 - deltaU2*deltaV1);
-
-				float tangentX = inverseDet * (deltaV2*deltaX1 - deltaV1*deltaX2);
-				float tangentY = inverseDet * (deltaV2*deltaY1 - deltaV1*deltaY2);
-				float tangentZ = inverseDet * (deltaV2*deltaZ1 - deltaV1*deltaZ2);
-
-				float bitangentX = inverseDet * (deltaU1*deltaX2 - deltaU2*deltaX1);
-				float bitangentY = inverseDet * (deltaU1*deltaY2 - deltaU2*deltaY1);
-				float bitangentZ = inverseDet * (deltaU1*deltaZ2 - deltaU2*deltaZ1);
-
-				float tangentLength = sqrt(tangentX*tangentX +
-					tangentY*tangentY +
-					tangentZ*tangentZ);
-				float bitangentLength = sqrt(bitangentX*bitangentX +
-					bitangentY*bitangentY +
-					bitangentZ*bitangentZ);
-
-				tangentX /= tangentLength;
-				tangentY /= tangentLength;
-				tangentZ /= tangentLength;
-				bitangentX /= bitangentLength;
-				bitangentY /= bitangentLength;
-				bitangentZ /= bitangentLength;
-
-				// NOTE: Each vertex in the face gets the same (bi)tangent pair
-				for (int vertIndex = 0; vertIndex<3; vertIndex++)
-				{
-					tangents.push_back(tangentX);
-					tangents.push_back(tangentY);
-					tangents.push_back(tangentZ);
+				break;
+			}
+			optimizeVertexCache(levelIndices.data(), levelIndexCount, vertexTotal, VERTEX_CACHE_SIZE);
+			MeshLOD lod = {(unsigned int)indices.size(), (unsigned int)levelIndexCount, previous.error + levelError, 0};
+			indices.insert(indices.end(), levelIndices.begin(), levelIndices.begin() + levelIndexCount);
+			lods.push_back(lod);
+		}
 
-					bitangents.push_back(bitangentX);
-					bitangents.push_back(bitangentY);
-					bitangents.push_back(bitangentZ);
-				}
+		// report
+		double simplifyTime = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - simplifyStart).count();
+		cout << "    - Built " << lods.size() << " level(s) of detail in " << simplifyTime << " ms:";
+		for (size_t level = 0; level < lods.size(); level++)
+		{
+			cout << " " << (lods[level].indexCount / 3) << " faces (error " << lods[level].error << ")" << ((level + 1 < lods.size()) ? "," : "");
+		}
+		cout << endl;
+	}
+
+	void GeometryData::buildCompactIndices()
+	{
+		// NOTE: Meshes with at most 65536 vertices can be drawn with 16-bit indices, halving the index buffer
+		// NOTE: Counted from the positions, as vertexCount() reads the streams, which are only published afterwards
+		compactIndices.clear();
+		if ((vertices.size() / 3) <= 65536)
+		{
+			compactIndices.assign(indices.begin(), indices.end());
+		}
+	}
+
+	void GeometryData::computeBounds(bool orientedBox, int threadCount)
+	{
+		chrono::high_resolution_clock::time_point boundsStart = chrono::high_resolution_clock::now();
+		computeMeshBounds(vertices.data(), vertices.size() / 3, orientedBox, threadCount, bounds);
+		double boundsTime = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - boundsStart).count();
+		float boxVolume = (bounds.aabbMax[0] - bounds.aabbMin[0]) * (bounds.aabbMax[1] - bounds.aabbMin[1]) * (bounds.aabbMax[2] - bounds.aabbMin[2]);
+		float orientedVolume = 8.0f * bounds.obbHalfExtents[0] * bounds.obbHalfExtents[1] * bounds.obbHalfExtents[2];
+		cout << "    - Bounds in " << boundsTime << " ms: sphere radius " << bounds.sphereRadius << ", box "
+			<< (bounds.aabbMax[0] - bounds.aabbMin[0]) << " x " << (bounds.aabbMax[1] - bounds.aabbMin[1]) << " x "
+			<< (bounds.aabbMax[2] - bounds.aabbMin[2]);
+		if (orientedBox && (boxVolume > 0.0f))
+		{
+			cout << ", oriented box " << (100.0f * orientedVolume / boxVolume) << "% of its volume";
+		}
+		cout << endl;
+	}
+
+	void GeometryData::publishStreams()
+	{
+		// NOTE: Empty arrays are published as NULL rather than a pointer into an empty vector
+		memset(&streams, 0, sizeof(MeshStreams));
+		streams.data[POSITION_STREAM] = vertices.empty() ? NULL : &vertices[0];
+		streams.size[POSITION_STREAM] = vertices.size() * sizeof(float);
+		streams.data[NORMAL_STREAM] = normals.empty() ? NULL : &normals[0];
+		streams.size[NORMAL_STREAM] = normals.size() * sizeof(float);
+		streams.data[TEXCOORD_STREAM] = textureCoords.empty() ? NULL : &textureCoords[0];
+		streams.size[TEXCOORD_STREAM] = textureCoords.size() * sizeof(float);
+		streams.data[TANGENT_STREAM] = tangents.empty() ? NULL : &tangents[0];
+		streams.size[TANGENT_STREAM] = tangents.size() * sizeof(float);
+		streams.data[BITANGENT_STREAM] = bitangents.empty() ? NULL : &bitangents[0];
+		streams.size[BITANGENT_STREAM] = bitangents.size() * sizeof(float);
+		streams.data[QTANGENT_STREAM] = qtangents.empty() ? NULL : &qtangents[0];
+		streams.size[QTANGENT_STREAM] = qtangents.size() * sizeof(short);
+		if (compactIndices.empty())
+		{
+			streams.data[INDEX_STREAM] = indices.empty() ? NULL : &indices[0];
+			streams.size[INDEX_STREAM] = indices.size() * sizeof(unsigned int);
+		}
+		else
+		{
+			streams.data[INDEX_STREAM] = &compactIndices[0];
+			streams.size[INDEX_STREAM] = compactIndices.size() * sizeof(unsigned short);
+		}
+		streams.data[LOD_STREAM] = lods.empty() ? NULL : &lods[0];
+		streams.size[LOD_STREAM] = lods.size() * sizeof(MeshLOD);
+		streams.data[MESHLET_STREAM] = meshlets.empty() ? NULL : &meshlets[0];
+		streams.size[MESHLET_STREAM] = meshlets.size() * sizeof(Meshlet);
+
+		// describe them
+		memset(&meshHeader, 0, sizeof(MeshCacheHeader));
+		meshHeader.vertexCount = vertices.size() / 3;
+		meshHeader.indexCount = indices.size();
+		meshHeader.indexSize = compactIndices.empty() ? sizeof(unsigned int) : sizeof(unsigned short);
+		meshHeader.bounds = bounds;
+	}
+
+	////////////////
+	// Generators //
+	////////////////
+
+	void GeometryData::generateSphere(SphereShape shape, int subdivisions, LoaderSettings settings)
+	{
+		// reset
+		resetMesh();
+		resetAttributes(settings.qtangents);
+
+		// build every level straight into the mesh arrays
+		chrono::high_resolution_clock::time_point buildStart = chrono::high_resolution_clock::now();
+		buildSphere(shape, subdivisions, settings.lodLevels, vertices, textureCoords, normals, tangents, bitangents, indices, lods);
+		double buildTime = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - buildStart).count();
+		size_t vertexTotal = vertices.size() / 3;
+		cout << "    - Generated " << ((shape == CUBE_SPHERE) ? "a cube-sphere" : "an icosphere") << " with " << vertexTotal
+			<< " vertices in " << buildTime << " ms, " << lods.size() << " level(s) of detail:";
+		for (size_t level = 0; level < lods.size(); level++)
+		{
+			cout << " " << (lods[level].indexCount / 3) << " faces (error " << lods[level].error << ")" << ((level + 1 < lods.size()) ? "," : "");
+		}
+		cout << endl;
+
+		// optimize
+		// NOTE: Only the triangles are reordered, the vertices are shared by every level and keep their order
+		if (settings.optimizeMesh)
+		{
+			VertexCacheStats before = analyzeVertexCache(indices.data(), lods[0].indexCount, vertexTotal, VERTEX_CACHE_SIZE);
+			for (size_t level = 0; level < lods.size(); level++)
+			{
+				optimizeVertexCache(&indices[lods[level].indexOffset], lods[level].indexCount, vertexTotal, VERTEX_CACHE_SIZE);
 			}
+			VertexCacheStats after = analyzeVertexCache(indices.data(), lods[0].indexCount, vertexTotal, VERTEX_CACHE_SIZE);
+			cout << "    - Optimized: ACMR " << before.acmr << " -> " << after.acmr << ", ATVR " << before.atvr << " -> " << after.atvr << endl;
+		}
+
+		// cluster
+		if (settings.buildMeshlets)
+		{
+			groupMeshlets();
 		}
 
-		cout << "    - Successfully loaded an OBJ with " << vertices.size() / 3 << " vertices " << endl;
+		// encode the frames
+		if (settings.qtangents)
+		{
+			encodeQTangents(settings.threadCount);
+		}
+
+		// finalize
+		buildCompactIndices();
+		computeBounds(settings.orientedBounds, settings.threadCount);
+		publishStreams();
 	}
 
 	//////////////
@@ -270,27 +1122,47 @@ namespace SWPTAS001
 
 	int GeometryData::vertexCount()
 	{
-		return vertices.size() / 3;
+		return streams.size[POSITION_STREAM] / (3 * sizeof(float));
 	}
 
 	int GeometryData::normalCount()
 	{
-		return normals.size() / 3;
+		return streams.size[NORMAL_STREAM] / (3 * sizeof(float));
 	}
 
 	int GeometryData::textureCoordCount()
 	{
-		return textureCoords.size() / 2;
+		return streams.size[TEXCOORD_STREAM] / (2 * sizeof(float));
 	}
 
 	int GeometryData::tangentCount()
 	{
-		return tangents.size() / 3;
+		return streams.size[TANGENT_STREAM] / (3 * sizeof(float));
 	}
 
 	int GeometryData::bitangentCount()
 	{
-		return bitangents.size() / 3;
+		return streams.size[BITANGENT_STREAM] / (3 * sizeof(float));
+	}
+
+	int GeometryData::qtangentCount()
+	{
+		return streams.size[QTANGENT_STREAM] / (4 * sizeof(short));
+	}
+
+	int GeometryData::indexCount()
+	{
+		return lodIndexCount(0);
+	}
+
+	int GeometryData::indexSize()
+	{
+		return meshHeader.indexSize;
+	}
+
+	int GeometryData::indexBufferSize()
+	{
+		return streams.size[INDEX_STREAM];
 	}
 
 	///////////////
@@ -299,55 +1171,312 @@ namespace SWPTAS001
 
 	void* GeometryData::vertexData()
 	{
-		return (void*)&vertices[0];
+		return (void*)streams.data[POSITION_STREAM];
 	}
 	
 	void* GeometryData::normalData()
 	{
-		return (void*)&normals[0];
+		return (void*)streams.data[NORMAL_STREAM];
 	}
 
 	void* GeometryData::textureCoordData()
 	{
-		return (void*)&textureCoords[0];
+		return (void*)streams.data[TEXCOORD_STREAM];
 	}
 
 	void* GeometryData::tangentData()
 	{
-		return (void*)&tangents[0];
+		return (void*)streams.data[TANGENT_STREAM];
 	}
 
 	
 	void* GeometryData::bitangentData()
 	{
-		return (void*)&bitangents[0];
+		return (void*)streams.data[BITANGENT_STREAM];
 	}
 
-	///////////////
-	// Utilities //
-	///////////////
+	void* GeometryData::qtangentData()
+	{
+		return (void*)streams.data[QTANGENT_STREAM];
+	}
 
-	glm::vec3 GeometryData::findMaxDimensions()
+	void* GeometryData::indexData()
+	{
+		return (void*)streams.data[INDEX_STREAM];
+	}
+
+	//////////////////
+	// Interleaving //
+	//////////////////
+
+	VertexLayout GeometryData::interleavedLayout()
+	{
+		// pack attributes in stream order, skipping the ones the mesh doesn't have
+		// NOTE: QTangents are already compact, so they keep their 16-bit format even here
+		VertexLayout layout;
+		int attributeCounts[VERTEX_ATTRIBUTE_COUNT] = {vertexCount(), normalCount(), textureCoordCount(), tangentCount(),
+			bitangentCount(), qtangentCount()};
+		int attributeSizes[VERTEX_ATTRIBUTE_COUNT] = {3, 3, 2, 3, 3, 4};
+		int componentBytes[VERTEX_ATTRIBUTE_COUNT] = {4, 4, 4, 4, 4, 2};
+		int offset = 0;
+		for (int attribute = 0; attribute < VERTEX_ATTRIBUTE_COUNT; attribute++)
+		{
+			bool present = (vertexCount() > 0) && (attributeCounts[attribute] == vertexCount());
+			layout.components[attribute] = present ? attributeSizes[attribute] : 0;
+			layout.offsets[attribute] = offset;
+			layout.formats[attribute] = (attribute == QTANGENT_ATTRIBUTE) ? SNORM16_FORMAT : FLOAT_FORMAT;
+			offset += layout.components[attribute] * componentBytes[attribute];
+		}
+		layout.stride = (offset + 15) & ~15;
+		return layout;
+	}
+
+	void* GeometryData::interleavedData()
 	{
-		// initialize
-		glm::vec3 result(-999999.0f, -999999.0f, -999999.0f);
-		// check vertices
-		for (int i = 0; i < vertexCount(); i = i + 3)
+		if (interleavedVertices || (vertexCount() == 0))
+		{
+			return interleavedVertices;
+		}
+
+		// allocate, with room to align the start to 16 bytes
+		VertexLayout layout = interleavedLayout();
+		size_t vertexFloats = layout.stride / sizeof(float);
+		interleavedStorage.assign((vertexCount() * vertexFloats) + 3, 0.0f);
+		size_t misalignment = ((size_t)interleavedStorage.data() & 15) / sizeof(float);
+		interleavedVertices = interleavedStorage.data() + ((4 - misalignment) & 3);
+
+		// scatter each stream into its slot
+		void* attributeData[VERTEX_ATTRIBUTE_COUNT] = {vertexData(), normalData(), textureCoordData(), tangentData(), bitangentData(),
+			qtangentData()};
+		for (int attribute = 0; attribute < VERTEX_ATTRIBUTE_COUNT; attribute++)
 		{
-			if (vertices[i] > result.x)
+			size_t attributeBytes = layout.components[attribute] * ((layout.formats[attribute] == SNORM16_FORMAT) ? sizeof(short) : sizeof(float));
+			if (attributeBytes == 0)
 			{
-				result.x = vertices[i];
+				continue;
 			}
-			if (vertices[i+1] > result.y)
+			const unsigned char* source = (const unsigned char*)attributeData[attribute];
+			unsigned char* destination = (unsigned char*)interleavedVertices + layout.offsets[attribute];
+			for (int vertIndex = 0; vertIndex < vertexCount(); vertIndex++)
 			{
-				result.y = vertices[i+1];
+				memcpy(destination + (vertIndex * layout.stride), source + (vertIndex * attributeBytes), attributeBytes);
 			}
-			if (vertices[i+2] > result.z)
+		}
+		return interleavedVertices;
+	}
+
+	int GeometryData::interleavedSize()
+	{
+		return vertexCount() * interleavedLayout().stride;
+	}
+
+	//////////////////
+	// Quantization //
+	//////////////////
+
+	VertexLayout GeometryData::quantizedLayout()
+	{
+		// same attributes as the float layout, in the compact formats
+		// NOTE: Positions take 8 bytes rather than 6, so every attribute stays 4-byte aligned
+		VertexLayout layout = interleavedLayout();
+		int attributeBytes[VERTEX_ATTRIBUTE_COUNT] = {8, 4, 4, 4, 4, 8};
+		int attributeSizes[VERTEX_ATTRIBUTE_COUNT] = {3, 4, 2, 4, 4, 4};
+		VertexFormat attributeFormats[VERTEX_ATTRIBUTE_COUNT] = {UNORM16_FORMAT, SNORM_1010102_FORMAT, HALF_FORMAT,
+			SNORM_1010102_FORMAT, SNORM_1010102_FORMAT, SNORM16_FORMAT};
+		int offset = 0;
+		for (int attribute = 0; attribute < VERTEX_ATTRIBUTE_COUNT; attribute++)
+		{
+			bool present = layout.components[attribute] > 0;
+			layout.components[attribute] = present ? attributeSizes[attribute] : 0;
+			layout.offsets[attribute] = offset;
+			layout.formats[attribute] = attributeFormats[attribute];
+			offset += present ? attributeBytes[attribute] : 0;
+		}
+		layout.stride = offset;
+		return layout;
+	}
+
+	void* GeometryData::quantizedData()
+	{
+		if (!quantizedVertices.empty() || (vertexCount() == 0))
+		{
+			return quantizedVertices.empty() ? NULL : quantizedVertices.data();
+		}
+
+		// allocate
+		VertexLayout layout = quantizedLayout();
+		size_t vertexWords = layout.stride / sizeof(unsigned int);
+		quantizedVertices.assign(vertexCount() * vertexWords, 0);
+		glm::vec3 offset = quantizedOffset();
+		glm::vec3 scale = quantizedScale();
+
+		// encode every vertex, measuring the round trip error as we go
+		const float* positions = (const float*)vertexData();
+		const float* textureCoords = (const float*)textureCoordData();
+		const float* directions[3] = {(const float*)normalData(), (const float*)tangentData(), (const float*)bitangentData()};
+		int directionAttributes[3] = {NORMAL_ATTRIBUTE, TANGENT_ATTRIBUTE, BITANGENT_ATTRIBUTE};
+		float positionError = 0.0f;
+		float textureCoordError = 0.0f;
+		float directionCosine = 1.0f;
+		for (int vertIndex = 0; vertIndex < vertexCount(); vertIndex++)
+		{
+			unsigned char* vertex = (unsigned char*)&quantizedVertices[vertIndex * vertexWords];
+			// positions
+			unsigned short* position = (unsigned short*)(vertex + layout.offsets[POSITION_ATTRIBUTE]);
+			for (int axis = 0; axis < 3; axis++)
 			{
-				result.z = vertices[i+2];
+				float value = positions[(3 * vertIndex) + axis];
+				position[axis] = quantizeUnorm16(value, offset[axis], scale[axis]);
+				positionError = max(positionError, fabsf(dequantizeUnorm16(position[axis], offset[axis], scale[axis]) - value));
 			}
+			// texture coords
+			if (layout.components[TEXCOORD_ATTRIBUTE] > 0)
+			{
+				unsigned short* textureCoord = (unsigned short*)(vertex + layout.offsets[TEXCOORD_ATTRIBUTE]);
+				for (int axis = 0; axis < 2; axis++)
+				{
+					float value = textureCoords[(2 * vertIndex) + axis];
+					textureCoord[axis] = floatToHalf(value);
+					textureCoordError = max(textureCoordError, fabsf(halfToFloat(textureCoord[axis]) - value));
+				}
+			}
+			// qtangents are copied as they are
+			if (layout.components[QTANGENT_ATTRIBUTE] > 0)
+			{
+				memcpy(vertex + layout.offsets[QTANGENT_ATTRIBUTE], (const short*)qtangentData() + (4 * vertIndex), 4 * sizeof(short));
+			}
+			// normals, tangents and bitangents
+			for (int direction = 0; direction < 3; direction++)
+			{
+				if (layout.components[directionAttributes[direction]] == 0)
+				{
+					continue;
+				}
+				const float* value = directions[direction] + (3 * vertIndex);
+				unsigned int* packed = (unsigned int*)(vertex + layout.offsets[directionAttributes[direction]]);
+				*packed = packSnorm1010102(value);
+				// NOTE: The shader renormalizes, so only the change in direction matters
+				float decoded[3];
+				unpackSnorm1010102(*packed, decoded);
+				float decodedLength = sqrtf((decoded[0] * decoded[0]) + (decoded[1] * decoded[1]) + (decoded[2] * decoded[2]));
+				float valueLength = sqrtf((value[0] * value[0]) + (value[1] * value[1]) + (value[2] * value[2]));
+				if ((decodedLength > 0.0f) && (valueLength > 0.0f))
+				{
+					float cosine = ((decoded[0] * value[0]) + (decoded[1] * value[1]) + (decoded[2] * value[2])) / (decodedLength * valueLength);
+					directionCosine = min(directionCosine, cosine);
+				}
+			}
+		}
+
+		// report
+		VertexLayout floatLayout = interleavedLayout();
+		int floatSize = 0;
+		for (int attribute = 0; attribute < VERTEX_ATTRIBUTE_COUNT; attribute++)
+		{
+			floatSize += vertexCount() * floatLayout.components[attribute] * ((floatLayout.formats[attribute] == SNORM16_FORMAT) ? sizeof(short) : sizeof(float));
 		}
-		// done
-		return result;
+		float extent = max(scale.x, max(scale.y, scale.z));
+		cout << "    - Quantized " << vertexCount() << " vertices from " << (floatSize / 1024) << " KB to " << (quantizedSize() / 1024)
+			<< " KB (" << (100 - ((100 * (long long)quantizedSize()) / max(floatSize, 1))) << "% smaller)" << endl;
+		cout << "    - Maximum quantization error: position " << positionError << " (" << ((extent > 0.0f) ? (100.0f * positionError / extent) : 0.0f)
+			<< "% of the bounds), texture coord " << textureCoordError << ", direction "
+			<< (acosf(min(directionCosine, 1.0f)) * 180.0f / 3.14159265f) << " degrees" << endl;
+		return quantizedVertices.data();
+	}
+
+	int GeometryData::quantizedSize()
+	{
+		return vertexCount() * quantizedLayout().stride;
+	}
+
+	glm::vec3 GeometryData::quantizedScale()
+	{
+		return boundsMax() - boundsMin();
+	}
+
+	glm::vec3 GeometryData::quantizedOffset()
+	{
+		return boundsMin();
+	}
+
+	//////////////////////
+	// Levels of Detail //
+	//////////////////////
+
+	int GeometryData::lodCount()
+	{
+		// NOTE: Without a level table the whole index stream is the only level
+		return max(1, (int)(streams.size[LOD_STREAM] / sizeof(MeshLOD)));
+	}
+
+	int GeometryData::lodIndexOffset(int level)
+	{
+		const MeshLOD* levels = (const MeshLOD*)streams.data[LOD_STREAM];
+		return levels ? levels[level].indexOffset : 0;
+	}
+
+	int GeometryData::lodIndexCount(int level)
+	{
+		const MeshLOD* levels = (const MeshLOD*)streams.data[LOD_STREAM];
+		return levels ? levels[level].indexCount : (streams.size[INDEX_STREAM] / meshHeader.indexSize);
+	}
+
+	float GeometryData::lodError(int level)
+	{
+		const MeshLOD* levels = (const MeshLOD*)streams.data[LOD_STREAM];
+		return levels ? levels[level].error : 0.0f;
+	}
+
+	//////////////
+	// Meshlets //
+	//////////////
+
+	int GeometryData::meshletCount()
+	{
+		return streams.size[MESHLET_STREAM] / sizeof(Meshlet);
+	}
+
+	const Meshlet* GeometryData::meshletData()
+	{
+		return (const Meshlet*)streams.data[MESHLET_STREAM];
+	}
+
+	////////////
+	// Bounds //
+	////////////
+
+	const MeshBounds& GeometryData::meshBounds()
+	{
+		return meshHeader.bounds;
+	}
+
+	glm::vec3 GeometryData::boundsMin()
+	{
+		return glm::vec3(meshHeader.bounds.aabbMin[0], meshHeader.bounds.aabbMin[1], meshHeader.bounds.aabbMin[2]);
+	}
+
+	glm::vec3 GeometryData::boundsMax()
+	{
+		return glm::vec3(meshHeader.bounds.aabbMax[0], meshHeader.bounds.aabbMax[1], meshHeader.bounds.aabbMax[2]);
+	}
+
+	glm::vec3 GeometryData::sphereCenter()
+	{
+		return glm::vec3(meshHeader.bounds.sphereCenter[0], meshHeader.bounds.sphereCenter[1], meshHeader.bounds.sphereCenter[2]);
+	}
+
+	float GeometryData::sphereRadius()
+	{
+		return meshHeader.bounds.sphereRadius;
+	}
+
+	///////////////
+	// Utilities //
+	///////////////
+
+	glm::vec3 GeometryData::findMaxDimensions()
+	{
+		// NOTE: The bounds are computed once at load time, so there's no need to scan the vertices here
+		return boundsMax();
 	}
 }
\ No newline at end of file
@@ -9,11 +9,20 @@
 #include <fstream>
 #include <string>
 #include <math.h>
+#include "mappedfile.h"
+#include "meshcache.h"
+#include "meshlets.h"
+#include "arena.h"
+#include "spheres.h"
+#include "heightmap.h"
 
 namespace SWPTAS001
 {
 	//// Enumerations
 	enum OBJDataType{ NONE, VERTEX, TEXTURECOORD, NORMAL, FACE, COMMENT};
+	enum VertexAttribute { POSITION_ATTRIBUTE, NORMAL_ATTRIBUTE, TEXCOORD_ATTRIBUTE, TANGENT_ATTRIBUTE, BITANGENT_ATTRIBUTE, QTANGENT_ATTRIBUTE, VERTEX_ATTRIBUTE_COUNT };
+	enum VertexLayoutMode { SEPARATE_LAYOUT, INTERLEAVED_LAYOUT, QUANTIZED_LAYOUT };
+	enum VertexFormat { FLOAT_FORMAT, UNORM16_FORMAT, HALF_FORMAT, SNORM_1010102_FORMAT, SNORM16_FORMAT };
 
 	//// Structures
 	struct FaceData
@@ -23,36 +32,137 @@ namespace SWPTAS001
 		int normalIndex[3];
 	};
 
+	struct VertexLayout
+	{
+		int stride; // bytes per vertex, a multiple of 16 (4 when quantized)
+		int components[VERTEX_ATTRIBUTE_COUNT]; // values per attribute, 0 when the mesh doesn't have it
+		int offsets[VERTEX_ATTRIBUTE_COUNT]; // bytes from the start of each vertex
+		VertexFormat formats[VERTEX_ATTRIBUTE_COUNT]; // how each value is stored
+	};
+
+	struct LoaderSettings
+	{
+		int threadCount = 0; // 0 uses every available core
+		bool useMeshCache = true; // load from / write to <obj>.meshcache
+		size_t memoryBudget = 0; // bytes, 0 loads the whole mesh in memory at once
+		bool optimizeMesh = true; // reorder triangles and vertices for the vertex cache and overdraw
+		int lodLevels = 4; // levels of detail, each with about half the triangles of the one before
+		bool buildMeshlets = true; // group the full detail triangles into meshlets for cluster culling
+		bool orientedBounds = true; // fit an oriented box along the principal axes of the positions
+		bool qtangents = false; // store each normal/tangent/bitangent frame as one 16-bit quaternion
+		std::string displacementMap; // height (or normal) map to displace the vertices by, empty for none
+		float displacementScale = 0.0f; // object space height of the map's highest point
+		float creaseAngle = 180.0f; // degrees, generated normals aren't smoothed across sharper edges (180 smooths every edge)
+	};
+
+	//// Declarations
+	struct OBJRawData;
+	struct OBJRecordCounts;
+	struct VertexCacheStats;
+
 	//// Classes
 	class GeometryData
 	{
 		public:
+			//// Constructors
+			GeometryData();
 			//// Loaders
-			void loadFromOBJFile(std::string filename);
+			void loadFromOBJFile(std::string filename, LoaderSettings settings = LoaderSettings());
+			//// Generators
+			void generateSphere(SphereShape shape, int subdivisions, LoaderSettings settings = LoaderSettings());
 			//// Counters
 			int vertexCount();
 			int normalCount();
 			int textureCoordCount();
 			int tangentCount();
 			int bitangentCount();
+			int qtangentCount();
+			int indexCount();
+			int indexSize();
+			int indexBufferSize();
 			//// Accessors
 			void* vertexData();
 			void* textureCoordData();
 			void* normalData();
 			void* tangentData();
 			void* bitangentData();
+			void* qtangentData();
+			void* indexData();
+			//// Interleaving
+			VertexLayout interleavedLayout();
+			void* interleavedData();
+			int interleavedSize();
+			//// Quantization
+			VertexLayout quantizedLayout();
+			void* quantizedData();
+			int quantizedSize();
+			glm::vec3 quantizedScale();
+			glm::vec3 quantizedOffset();
+			//// Levels of Detail
+			int lodCount();
+			int lodIndexOffset(int level);
+			int lodIndexCount(int level);
+			float lodError(int level);
+			//// Meshlets
+			int meshletCount();
+			const Meshlet* meshletData();
+			//// Bounds
+			const MeshBounds& meshBounds();
+			glm::vec3 boundsMin();
+			glm::vec3 boundsMax();
+			glm::vec3 sphereCenter();
+			float sphereRadius();
 			//// Utilities
 			glm::vec3 findMaxDimensions();
 
 		private:
 			//// Object Data
-			std::vector<float> vertices;
-			std::vector<float> textureCoords;
-			std::vector<float> normals;
-			std::vector<float> tangents;
-			std::vector<float> bitangents;
+			// NOTE: Allocated 64-byte aligned from meshArena, except frames that only live until they're encoded
+			MemoryArena meshArena;
+			ArenaVector<float> vertices;
+			ArenaVector<float> textureCoords;
+			ArenaVector<float> normals;
+			ArenaVector<float> tangents;
+			ArenaVector<float> bitangents;
+			ArenaVector<short> qtangents;
 			//// Object Indexing
-			std::vector<FaceData> faces;
+			std::vector<unsigned int> indices;
+			std::vector<unsigned short> compactIndices;
+			std::vector<MeshLOD> lods;
+			std::vector<Meshlet> meshlets;
+			MeshBounds bounds;
+			//// Interleaved Data
+			std::vector<float> interleavedStorage;
+			float* interleavedVertices;
+			//// Quantized Data
+			std::vector<unsigned int> quantizedVertices;
+			//// Upload Streams
+			// NOTE: Point either into the vectors above or into the mapped cache file
+			MappedFile cacheFile;
+			MeshCacheHeader meshHeader;
+			MeshStreams streams;
+			//// Processing
+			void resetMesh();
+			void chooseAttributes(const OBJRecordCounts& counts, bool& hasTextureCoords, bool& hasNormals);
+			void resetAttributes(bool temporaryFrames);
+			size_t buildIndexedMesh(const ArenaVector<FaceData>& faces, const OBJRecordCounts& counts, bool hasTextureCoords,
+				bool hasNormals, std::vector<int>& vertexTriples);
+			void gatherAttributes(const OBJRawData& pools, const std::vector<int>& vertexTriples, bool hasTextureCoords,
+				bool hasNormals, int threadCount);
+			void generateNormals(float creaseAngle, int threadCount);
+			void displaceVertices(const HeightMap& map, float scale, int threadCount);
+			void optimizeMesh(VertexCacheStats& before, VertexCacheStats& after);
+			void groupMeshlets();
+			void computeTangents(int threadCount);
+			void encodeQTangents(int threadCount);
+			void buildLODChain(int levelCount);
+			void buildCompactIndices();
+			void computeBounds(bool orientedBox, int threadCount);
+			void publishStreams();
+			//// Caching
+			bool loadFromMeshCache(std::string filename, unsigned long long displacementKey, unsigned long long settingsKey);
+			bool streamOBJFile(MappedFile& objFile, std::string filename, const SourceStamp& stamp, LoaderSettings settings);
+			void saveToMeshCache(std::string filename, const SourceStamp& stamp);
 	};
 }
 
@@ -68,4 +178,65 @@ namespace SWPTAS001
 //       exactly 3 values, and that all texture coordinate specifications contain exactly 2 values
 
 // NOTE: There is currently no support for mtl material references or anything like that,
-//       just load whatever texture you want to use manually
\ No newline at end of file
+//       just load whatever texture you want to use manually
+
+// NOTE: With a memoryBudget set, meshes are streamed rather than loaded whole: a first pass keeps only
+//       the v/vt/vn pools, and a second pass indexes the faces in batches sized to fit what is left of
+//       the budget, spooling each batch to disk and assembling the mesh cache, which is then mapped.
+//       Peak memory is then the pools plus one batch, no matter how many faces the mesh has. The cache
+//       is marked as streamed, so only later loads with a budget map it and the others build the full mesh
+
+// NOTE: Unless LoaderSettings::optimizeMesh is off, meshes are optimized right after indexing: triangles
+//       are reordered for the post-transform vertex cache and then in clusters to reduce overdraw, and
+//       vertices are renumbered in the order they are first used. The cache records the setting, so
+//       switching it rebuilds it
+
+// NOTE: With lodLevels above 1, simplified levels of detail are appended to the index buffer after the
+//       full mesh (see simplify.h), all indexing the same vertices, so a renderer switches level just by
+//       drawing a different range. indexCount() is the full mesh, indexBufferSize() covers every level.
+//       Streamed meshes only get the full level
+
+// NOTE: With buildMeshlets set, the full detail triangles are regrouped into meshlets (see meshlets.h)
+//       after optimization, each a contiguous index range with a bounding sphere and normal cone that a
+//       renderer can test before drawing it. Coarser levels and streamed meshes have no meshlets. The cache
+//       records the setting, so switching it rebuilds it
+
+// NOTE: meshBounds() holds the box, sphere and (with orientedBounds) oriented box around the positions
+//       (see bounds.h), measured once when the mesh is built. The cache records the setting, so switching
+//       it rebuilds it
+
+// NOTE: interleavedData() builds (on first use) a single array of structures holding every attribute
+//       of a vertex next to each other, as described by interleavedLayout(), so drawing touches one
+//       cache line per vertex rather than one per attribute stream. The array and every vertex in it
+//       start on a 16-byte boundary, the gaps are zero-filled
+
+// NOTE: quantizedData() builds (on first use) an interleaved array in a compact format: positions as
+//       16-bit unsigned normalized values over the mesh bounds (decoded with quantizedScale() and
+//       quantizedOffset()), texture coords as half floats, and normals, tangents and bitangents as
+//       GL_INT_2_10_10_10_REV. That is 24 bytes per vertex instead of 56, and building it reports the
+//       byte savings and the largest error each attribute picked up
+
+// NOTE: With LoaderSettings::qtangents, the normal, tangent and bitangent of every vertex that has a
+//       full tangent frame are encoded into one QTangent (see packQTangent()) right after the frames are
+//       generated, and the three float streams are dropped: 8 bytes per vertex instead of 36, in memory,
+//       in the cache and in every layout, and one attribute fetch instead of three. Meshes without
+//       texture coords keep their plain normals. The cache records the setting, so switching it rebuilds it
+
+// NOTE: OBJ files without vn records get normals generated right after indexing (see normals.h), from
+//       the faces around each position weighted by area and corner angle, so UV seams don't show in the
+//       shading. Below LoaderSettings::creaseAngle, vertices are split wherever the faces around them
+//       disagree by more than the angle, which keeps hard edges hard. Since this needs every face at once,
+//       such meshes are never streamed. The cache records the angle, so changing it rebuilds it
+
+// NOTE: generateSphere() builds a unit icosphere or cube-sphere (see spheres.h) without any file, with
+//       texture coords and exact tangent frames, and one level of detail per subdivision step (at most
+//       LoaderSettings::lodLevels of them) so the usual screen-space selection picks the subdivision level.
+//       Generated spheres are never cached, everything else in the settings applies as for loaded meshes
+
+// NOTE: With a displacementMap and a non-zero displacementScale, every vertex is pushed out along its
+//       normal by the map's height at its texture coords (see heightmap.h) right after indexing, before
+//       anything that depends on the positions. Vertices sharing a position move together, by their
+//       average height along their average normal, so seams and poles stay closed, and the normals are
+//       regenerated from the displaced faces (see normals.h) before the tangents are. The cache records
+//       which map and scale it was displaced with. Meshes without texture coords, and streamed meshes,
+//       are not displaced
@@ -39,6 +39,82 @@ namespace SWPTAS001
 		}
 	}
 
+	// Per vertex attribute: shader input, buffer name and bind name suffixes
+	static const char* VERTEX_ATTRIBUTE_NAMES[VERTEX_ATTRIBUTE_COUNT] = {"position", "normal", "textureUV", "tangent", "bitangent", "qtangent"};
+	static const char* VERTEX_BUFFER_NAMES[VERTEX_ATTRIBUTE_COUNT] = {"VertexBuffer", "NormalBuffer", "TextureCoordBuffer", "TangentBuffer",
+		"BitangentBuffer", "QTangentBuffer"};
+	static const char* VERTEX_BIND_NAMES[VERTEX_ATTRIBUTE_COUNT] = {"position", "normal", "texturecoord", "tangent", "bitangent", "qtangent"};
+
+	// Subdivisions of the light gizmos at full detail, selectLOD() drops to coarser ones when they're small on screen
+	static const int LIGHT_SPHERE_SUBDIVISIONS = 4;
+
+	GLenum glIndexType(GeometryData& geometry)
+	{
+		return (geometry.indexSize() == sizeof(unsigned short)) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+	}
+
+	const void* glIndexOffset(GeometryData& geometry, int level)
+	{
+		return (const void*)((size_t)geometry.lodIndexOffset(level) * geometry.indexSize());
+	}
+
+	GLenum glVertexFormat(VertexFormat format)
+	{
+		switch (format)
+		{
+			case UNORM16_FORMAT: return GL_UNSIGNED_SHORT;
+			case HALF_FORMAT: return GL_HALF_FLOAT;
+			case SNORM_1010102_FORMAT: return GL_INT_2_10_10_10_REV;
+			case SNORM16_FORMAT: return GL_SHORT;
+			default: return GL_FLOAT;
+		}
+	}
+
+	GLenum glTextureFormat(TextureFormat format)
+	{
+		switch (format)
+		{
+			case BC1_TEXTURE: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+			case BC3_TEXTURE: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+			case BC5_TEXTURE: return GL_COMPRESSED_RG_RGTC2;
+			default: return GL_RGBA;
+		}
+	}
+
+	void uploadMipChain(const MipChain& chain, int threadCount)
+	{
+		// NOTE: S3TC is an extension even in core profiles (RGTC isn't), so without it BC1 and BC3 are decoded here instead
+		if (((chain.format == BC1_TEXTURE) || (chain.format == BC3_TEXTURE)) && !GLEW_EXT_texture_compression_s3tc)
+		{
+			MipChain decoded;
+			decompressMipChain(chain, decoded, threadCount);
+			cout << "    - S3TC isn't supported, uploading decoded texels" << endl;
+			uploadMipChain(decoded, threadCount);
+			return;
+		}
+		// NOTE: Every level is uploaded and the chain is capped at the last one, so it's complete for trilinear filtering
+		size_t uploadedBytes = 0;
+		size_t uncompressedBytes = 0;
+		for (size_t levelIndex = 0; levelIndex < chain.levels.size(); levelIndex++)
+		{
+			const MipLevel& level = chain.levels[levelIndex];
+			size_t levelSize = textureLevelSize(chain.format, level.width, level.height);
+			if (chain.format == RGBA8_TEXTURE)
+			{
+				glTexImage2D(GL_TEXTURE_2D, (GLint)levelIndex, GL_RGBA, level.width, level.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, mipLevelTexels(chain, levelIndex));
+			}
+			else
+			{
+				glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)levelIndex, glTextureFormat(chain.format), level.width, level.height, 0,
+					(GLsizei)levelSize, mipLevelTexels(chain, levelIndex));
+			}
+			uploadedBytes += levelSize;
+			uncompressedBytes += textureLevelSize(RGBA8_TEXTURE, level.width, level.height);
+		}
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, chain.levels.empty() ? 0 : (GLint)(chain.levels.size() - 1));
+		cout << "    - Uploaded " << (uploadedBytes >> 10) << " KB of texels (" << (uncompressedBytes >> 10) << " KB as RGBA)" << endl;
+	}
+
 	GLuint loadShader(const char* shaderFilename, GLenum shaderType)
 	{
 		// check if file is accessible
@@ -164,6 +240,13 @@ namespace SWPTAS001
 		bufferBindMap["phongShader"] = loadShaderProgram("Shaders/phong.vert", "Shaders/phong.frag");
 		glUseProgram(bufferBindMap["phongShader"]);
 
+		// NOTE: Textures are normally already decoding on worker threads since main() started, otherwise
+		//       they start here, still overlapping the meshes below
+		TextureDecoder localDecoder;
+		TextureDecoder& textureDecoder = fTextureDecoder ? *fTextureDecoder : localDecoder;
+		textureDecoder.start(MODEL_TEXTURE_PATH, COLOR_MIPS);
+		textureDecoder.start(MODEL_BUMPMAP_PATH, NORMAL_MIPS);
+
 		////////////////////
 		// VAO 1  - Model //
 		////////////////////
@@ -173,77 +256,64 @@ namespace SWPTAS001
 		glBindVertexArray(bufferBindMap["modelVAO"]);
 		
 		/////////////////////////
-		// VBO 1 - Model Vertex//
+		// VBOs - Model Vertex //
 		/////////////////////////
 		
-		// Load Geometry
-		fModelGeometry.loadFromOBJFile("Objects/planet.obj");
-		
-		// read vertex positions
-		glGenBuffers(1, &bufferBindMap["modelVertexBuffer"]);
-		glBindBuffer(GL_ARRAY_BUFFER, bufferBindMap["modelVertexBuffer"]);
-		glBufferData(GL_ARRAY_BUFFER, (fModelGeometry.vertexCount() * 3 * sizeof(float)), fModelGeometry.vertexData(), GL_STATIC_DRAW);
-		
-		// bind vertex positions
-		shaderBindMap["modelposition"] = glGetAttribLocation(bufferBindMap["phongShader"], "position");
-		glVertexAttribPointer(shaderBindMap["modelposition"], 3, GL_FLOAT, GL_FALSE, 0, NULL);
-		glEnableVertexAttribArray(shaderBindMap["modelposition"]);
-		
-		//////////////////////////
-		// VBO 2 - Model Normal //		
-		//////////////////////////
-
-		// read normal positions
-		glGenBuffers(1, &bufferBindMap["modelNormalBuffer"]);
-		glBindBuffer(GL_ARRAY_BUFFER, bufferBindMap["modelNormalBuffer"]);
-		glBufferData(GL_ARRAY_BUFFER, ((fModelGeometry.normalCount()) * 3  * sizeof(float)), fModelGeometry.normalData(), GL_STATIC_DRAW);
-		
-		// bind normal positions
-		shaderBindMap["modelnormal"] = glGetAttribLocation(bufferBindMap["phongShader"], "normal");
-		glVertexAttribPointer(shaderBindMap["modelnormal"], 3, GL_FLOAT, GL_FALSE, 0, NULL);
-		glEnableVertexAttribArray(shaderBindMap["modelnormal"]);
-		
-		//////////////////////
-		// VBO 3 - Model UV //
-		//////////////////////
+		// NOTE: The planet is either the chunked terrain, whose vertex pool is refilled every frame, or the
+		//       fixed planet.obj mesh. Either one can be raised by the heights under venusbump.png
+		if (fTerrainEnabled)
+		{
+			// Load Heights
+			if (fLoaderSettings.displacementScale > 0.0f)
+			{
+				// NOTE: A compressed bump map keeps no RGBA texels, so the image is decoded again for its heights
+				const DecodedImage& bumpImage = textureDecoder.wait(MODEL_BUMPMAP_PATH, NORMAL_MIPS);
+				bool heightsLoaded = false;
+				if (bumpImage.pixels)
+				{
+					buildHeightMap(bumpImage.pixels, bumpImage.width, bumpImage.height, fHeightMap, fLoaderSettings.threadCount);
+					heightsLoaded = true;
+				}
+				else if (!bumpImage.mips.levels.empty())
+				{
+					heightsLoaded = loadHeightMap(MODEL_BUMPMAP_PATH, fHeightMap, fLoaderSettings.threadCount);
+				}
+				if (heightsLoaded)
+				{
+					fTerrainSettings.heightMap = &fHeightMap;
+					fTerrainSettings.maxHeight = fLoaderSettings.displacementScale;
+				}
+			}
 
-		// read textureUV positions
-		glGenBuffers(1, &bufferBindMap["modelTextureCoordBuffer"]);
-		glBindBuffer(GL_ARRAY_BUFFER, bufferBindMap["modelTextureCoordBuffer"]);
-		glBufferData(GL_ARRAY_BUFFER, ((fModelGeometry.textureCoordCount()) * 2  * sizeof(float)), fModelGeometry.textureCoordData(), GL_STATIC_DRAW);
-		
-		// bind textureUV positions
-		shaderBindMap["modeltexturecoord"] = glGetAttribLocation(bufferBindMap["phongShader"], "textureUV");
-		glVertexAttribPointer(shaderBindMap["modeltexturecoord"], 2, GL_FLOAT, GL_FALSE, 0, NULL);
-		glEnableVertexAttribArray(shaderBindMap["modeltexturecoord"]);
+			// Generate Terrain
+			fTerrainSettings.threadCount = fLoaderSettings.threadCount;
+			fTerrain.create(fTerrainSettings);
 
-		////////////////////////////
-		// VBO 3 - Model Tangents //
-		////////////////////////////
+			// allocate the pool, bind every vertex attribute and upload the root chunks
+			uploadTerrainPool();
+		}
+		else
+		{
+			// Load Geometry
+			LoaderSettings planetSettings = fLoaderSettings;
+			if (planetSettings.displacementScale != 0.0f)
+			{
+				planetSettings.displacementMap = MODEL_BUMPMAP_PATH;
+			}
+			fModelGeometry.loadFromOBJFile("Objects/planet.obj", planetSettings);
 
-		// read normal positions
-		glGenBuffers(1, &bufferBindMap["modelTangentBuffer"]);
-		glBindBuffer(GL_ARRAY_BUFFER, bufferBindMap["modelTangentBuffer"]);
-		glBufferData(GL_ARRAY_BUFFER, ((fModelGeometry.tangentCount()) * 3  * sizeof(float)), fModelGeometry.tangentData(), GL_STATIC_DRAW);
-		
-		// bind normal positions
-		shaderBindMap["modeltangent"] = glGetAttribLocation(bufferBindMap["phongShader"], "tangent");
-		glVertexAttribPointer(shaderBindMap["modeltangent"], 3, GL_FLOAT, GL_FALSE, 0, NULL);
-		glEnableVertexAttribArray(shaderBindMap["modeltangent"]);
+			// upload and bind every vertex attribute
+			uploadVertexData(fModelGeometry, "model");
 
-		/////////////////////////////
-		// VBO 3 - Model Bitangent //
-		/////////////////////////////
+			/////////////////////////
+			// EBO - Model Indices //
+			/////////////////////////
 
-		// read normal positions
-		glGenBuffers(1, &bufferBindMap["modelBitangetBuffer"]);
-		glBindBuffer(GL_ARRAY_BUFFER, bufferBindMap["modelBitangetBuffer"]);
-		glBufferData(GL_ARRAY_BUFFER, ((fModelGeometry.bitangentCount()) * 3  * sizeof(float)), fModelGeometry.bitangentData(), GL_STATIC_DRAW);
-		
-		// bind normal positions
-		shaderBindMap["modelbitangent"] = glGetAttribLocation(bufferBindMap["phongShader"], "bitangent");
-		glVertexAttribPointer(shaderBindMap["modelbitangent"], 3, GL_FLOAT, GL_FALSE, 0, NULL);
-		glEnableVertexAttribArray(shaderBindMap["modelbitangent"]);
+			// read indices (the element buffer binding is stored in the bound VAO)
+			glGenBuffers(1, &bufferBindMap["modelIndexBuffer"]);
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bufferBindMap["modelIndexBuffer"]);
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, fModelGeometry.indexBufferSize(), fModelGeometry.indexData(), GL_STATIC_DRAW);
+		}
 
 		////////////////////////////
 		// Texture - Model Texture//
@@ -254,25 +324,24 @@ namespace SWPTAS001
 		glGenTextures(1, &bufferBindMap["modelTexture"]);
 		glBindTexture(GL_TEXTURE_2D, bufferBindMap["modelTexture"]);
 
-		// load texture
-		int width, height, bpp;
- 		unsigned char * textureData = stbi_load( "Textures/venusmap.png", &width, &height, &bpp, 4);
+		// wait for the decoded texture
+		const DecodedImage& textureImage = textureDecoder.wait(MODEL_TEXTURE_PATH, COLOR_MIPS);
 
 		// config
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
 		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
 		// upload image
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, textureData);
+		uploadMipChain(textureImage.mips, fLoaderSettings.threadCount);
 
 		// setup sampler
 		shaderBindMap["modeltexture"] = glGetUniformLocation(bufferBindMap["phongShader"], "modelTexture");
 		glUniform1i(shaderBindMap["modeltexture"], 0);
 
 		// clean up
-		stbi_image_free(textureData);
+		textureDecoder.release(MODEL_TEXTURE_PATH);
 
 		/////////////////////////////
 		// Texture - Model BumpMap //
@@ -283,24 +352,25 @@ namespace SWPTAS001
 		glGenTextures(1, &bufferBindMap["modelBumpMap"]);
 		glBindTexture(GL_TEXTURE_2D, bufferBindMap["modelBumpMap"]);
 
-		// load texture
- 		unsigned char * bumpMapData = stbi_load( "Textures/venusbump.png", &width, &height, &bpp, 4);
+		// wait for the decoded texture
+		const DecodedImage& bumpMapImage = textureDecoder.wait(MODEL_BUMPMAP_PATH, NORMAL_MIPS);
 
 		// config
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
 		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
 		// upload image
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, bumpMapData);
+		uploadMipChain(bumpMapImage.mips, fLoaderSettings.threadCount);
 
 		// setup sampler
 		shaderBindMap["modelBumpMap"] = glGetUniformLocation(bufferBindMap["phongShader"], "modelBumpMap");
 		glUniform1i(shaderBindMap["modelBumpMap"], 1);
 
 		// clean up
-		stbi_image_free(bumpMapData);
+		textureDecoder.release(MODEL_BUMPMAP_PATH);
+		cout << "    - Decoding textures alongside startup saved " << textureDecoder.savedTime() << " ms" << endl;
 
 		///////////////////
 		// VAO 2 - Light //
@@ -311,35 +381,23 @@ namespace SWPTAS001
 		glBindVertexArray(bufferBindMap["lightVAO"]);
 		
 		//////////////////////////
-		// VBO 1 - Light Vertex //
+		// VBOs - Light Vertex //
 		//////////////////////////
 
-		// Load Geometry
-		fLightGeometry.loadFromOBJFile("Objects/sphere.obj");
-		
-		// read vertex positions
-		glGenBuffers(1, &bufferBindMap["lightVertexBuffer"]);
-		glBindBuffer(GL_ARRAY_BUFFER, bufferBindMap["lightVertexBuffer"]);
-		glBufferData(GL_ARRAY_BUFFER, (fLightGeometry.vertexCount() * 3 * sizeof(float)), fLightGeometry.vertexData(), GL_STATIC_DRAW);
-		
-		// bind vertex positions
-		shaderBindMap["lightposition"] = glGetAttribLocation(bufferBindMap["phongShader"], "position");
-		glVertexAttribPointer(shaderBindMap["lightposition"], 3, GL_FLOAT, GL_FALSE, 0, NULL);
-		glEnableVertexAttribArray(shaderBindMap["lightposition"]);
+		// Generate Geometry
+		fLightGeometry.generateSphere(fLightShape, LIGHT_SPHERE_SUBDIVISIONS, fLoaderSettings);
 
-		//////////////////////////
-		// VBO 2 - Light Normal //		
-		//////////////////////////
+		// upload and bind every vertex attribute
+		uploadVertexData(fLightGeometry, "light");
 
-		// read normal positions
-		glGenBuffers(1, &bufferBindMap["lightNormalBuffer"]);
-		glBindBuffer(GL_ARRAY_BUFFER, bufferBindMap["lightNormalBuffer"]);
-		glBufferData(GL_ARRAY_BUFFER, ((fLightGeometry.normalCount()) * 3  * sizeof(float)), fLightGeometry.normalData(), GL_STATIC_DRAW);
-		
-		// bind normal positions
-		shaderBindMap["lightnormal"] = glGetAttribLocation(bufferBindMap["phongShader"], "normal");
-		glVertexAttribPointer(shaderBindMap["lightnormal"], 3, GL_FLOAT, GL_FALSE, 0, NULL);
-		glEnableVertexAttribArray(shaderBindMap["lightnormal"]);
+		/////////////////////////
+		// EBO - Light Indices //
+		/////////////////////////
+
+		// read indices
+		glGenBuffers(1, &bufferBindMap["lightIndexBuffer"]);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bufferBindMap["lightIndexBuffer"]);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, fLightGeometry.indexBufferSize(), fLightGeometry.indexData(), GL_STATIC_DRAW);
 
 		//////////////////////
 		// Uniforms - Model //
@@ -402,6 +460,18 @@ namespace SWPTAS001
 		shaderBindMap["transformN"] = glGetUniformLocation(bufferBindMap["phongShader"], "transformN");
 		glUniformMatrix3fv(shaderBindMap["transformN"], 1, GL_FALSE, &fNTransformBuffer[0][0]);
 
+		// Vertex Decoding
+		shaderBindMap["positionScale"] = glGetUniformLocation(bufferBindMap["phongShader"], "positionScale");
+		shaderBindMap["positionOffset"] = glGetUniformLocation(bufferBindMap["phongShader"], "positionOffset");
+		shaderBindMap["tangentFrame"] = glGetUniformLocation(bufferBindMap["phongShader"], "tangentFrame");
+		setVertexDecode(fModelGeometry);
+
+		// Terrain Morphing (off for every other mesh)
+		shaderBindMap["morphRange"] = glGetUniformLocation(bufferBindMap["phongShader"], "morphRange");
+		shaderBindMap["morphCamera"] = glGetUniformLocation(bufferBindMap["phongShader"], "morphCamera");
+		shaderBindMap["morphRadius"] = glGetUniformLocation(bufferBindMap["phongShader"], "morphRadius");
+		glUniform2f(shaderBindMap["morphRange"], 0.0f, 0.0f);
+
 		////////////
 		// Camera //
 		////////////
@@ -478,7 +548,7 @@ namespace SWPTAS001
 			}
 			else if (e.key.keysym.sym == SDLK_e)
 			{
-				if (fModelGeometry.textureCoordCount() == 0)
+				if (!fTerrainEnabled && (fModelGeometry.textureCoordCount() == 0))
 				{
 					std::cout << "\n - Object has no texture coordinates, reverting to PLAIN rendering mode.\n";
 					fRenderMode = PLAIN;
@@ -490,7 +560,7 @@ namespace SWPTAS001
 			}
 			else if (e.key.keysym.sym == SDLK_r)
 			{
-				if (fModelGeometry.textureCoordCount() == 0)
+				if (!fTerrainEnabled && (fModelGeometry.textureCoordCount() == 0))
 				{
 					std::cout << "\n - Object has no texture coordinates, reverting to PLAIN rendering mode.\n";
 					fRenderMode = PLAIN;
@@ -753,27 +823,34 @@ namespace SWPTAS001
 		
 		// Set Model Color
 		fillColorBuffer({ fModelColor.x, fModelColor.y , fModelColor.z });
+		setVertexDecode(fModelGeometry);
 
 		// render model
+		GLenum modelMode = GL_TRIANGLES;
 		switch(fRenderMode)
 		{
 			case MESH:
 				setRenderType(1);
-				glDrawArrays(GL_LINES, 0, fModelGeometry.vertexCount());
+				modelMode = GL_LINES;
 				break;
 			case PLAIN:
 				setRenderType(1);
-				glDrawArrays(GL_TRIANGLES, 0, fModelGeometry.vertexCount());
 				break;
 			case TEXTURED:
 				setRenderType(2);
-				glDrawArrays(GL_TRIANGLES, 0, fModelGeometry.vertexCount());
 				break;
 			case BUMPMAPPED:
 				setRenderType(3);
-				glDrawArrays(GL_TRIANGLES, 0, fModelGeometry.vertexCount());
 				break;
 		}
+		if (fTerrainEnabled)
+		{
+			drawTerrain(ModelMatrix, modelMode);
+		}
+		else
+		{
+			drawGeometry(fModelGeometry, ModelMatrix, modelMode);
+		}
 		
 		/////////////
 		// Light 1 //
@@ -799,9 +876,10 @@ namespace SWPTAS001
 		// set colour
 		setRenderType(0);
 		fillColorBuffer({ fLightColorBuffer[0].x, fLightColorBuffer[0].y, fLightColorBuffer[0].z});
+		setVertexDecode(fLightGeometry);
 		
 		// render light
-		glDrawArrays(GL_TRIANGLES, 0, fLightGeometry.vertexCount());
+		drawGeometry(fLightGeometry, ModelMatrix, GL_TRIANGLES);
 
 		/////////////
 		// Light 2 //
@@ -829,7 +907,7 @@ namespace SWPTAS001
 		fillColorBuffer({ fLightColorBuffer[1].x, fLightColorBuffer[1].y, fLightColorBuffer[1].z});
 		
 		// render light
-		glDrawArrays(GL_TRIANGLES, 0, fLightGeometry.vertexCount());
+		drawGeometry(fLightGeometry, ModelMatrix, GL_TRIANGLES);
 
 		//////////
 		// Done //
@@ -842,13 +920,18 @@ namespace SWPTAS001
 	void OpenGLWindow::cleanup()
 	{
 		// clear VBOs
-		glDeleteBuffers(1, &bufferBindMap["modelVertexBuffer"]);
-		glDeleteBuffers(1, &bufferBindMap["modelNormalBuffer"]);
-		glDeleteBuffers(1, &bufferBindMap["modelTextureCoordBuffer"]);
-		glDeleteBuffers(1, &bufferBindMap["modelTangentBuffer"]);
-		glDeleteBuffers(1, &bufferBindMap["modelBitangetBuffer"]);
-		glDeleteBuffers(1, &bufferBindMap["lightVertexBuffer"]);
-		glDeleteBuffers(1, &bufferBindMap["lightNormalBuffer"]);
+		for (int attribute = 0; attribute < VERTEX_ATTRIBUTE_COUNT; attribute++)
+		{
+			glDeleteBuffers(1, &bufferBindMap[string("model") + VERTEX_BUFFER_NAMES[attribute]]);
+			glDeleteBuffers(1, &bufferBindMap[string("light") + VERTEX_BUFFER_NAMES[attribute]]);
+		}
+		glDeleteBuffers(1, &bufferBindMap["modelInterleavedBuffer"]);
+		glDeleteBuffers(1, &bufferBindMap["modelIndexBuffer"]);
+		glDeleteBuffers(1, &bufferBindMap["lightInterleavedBuffer"]);
+		glDeleteBuffers(1, &bufferBindMap["lightIndexBuffer"]);
+		glDeleteBuffers(1, &bufferBindMap["terrainPoolBuffer"]);
+		glDeleteBuffers(1, &bufferBindMap["terrainIndexBuffer"]);
+		fTerrain.destroy();
 		// clear VAO
 		glDeleteVertexArrays(1, &bufferBindMap["modelVAO"]);
 		glDeleteVertexArrays(1, &bufferBindMap["lightVAO"]);
@@ -896,6 +979,295 @@ namespace SWPTAS001
 		glUniform1i(shaderBindMap["renderType"], fRenderType);
 	}
 
+	void OpenGLWindow::setLoaderSettings(LoaderSettings theSettings)
+	{
+		fLoaderSettings = theSettings;
+	}
+
+	void OpenGLWindow::setVertexLayout(VertexLayoutMode theLayout)
+	{
+		fVertexLayout = theLayout;
+	}
+
+	void OpenGLWindow::setClusterCulling(bool theCulling)
+	{
+		fClusterCulling = theCulling;
+	}
+
+	void OpenGLWindow::setLightShape(SphereShape theShape)
+	{
+		fLightShape = theShape;
+	}
+
+	void OpenGLWindow::setTerrainEnabled(bool theTerrain)
+	{
+		fTerrainEnabled = theTerrain;
+	}
+
+	void OpenGLWindow::setTextureDecoder(TextureDecoder* theDecoder)
+	{
+		fTextureDecoder = theDecoder;
+	}
+
+	void OpenGLWindow::uploadVertexData(GeometryData& geometry, string prefix)
+	{
+		// NOTE: Every layout is described by the same descriptor, the separate layout just gives every
+		//       attribute its own tightly packed buffer (stride 0, offset 0) instead of a slot in one buffer
+		bool quantized = (fVertexLayout == QUANTIZED_LAYOUT);
+		bool singleBuffer = (fVertexLayout != SEPARATE_LAYOUT);
+		VertexLayout layout = quantized ? geometry.quantizedLayout() : geometry.interleavedLayout();
+		void* attributeData[VERTEX_ATTRIBUTE_COUNT] = {geometry.vertexData(), geometry.normalData(), geometry.textureCoordData(),
+			geometry.tangentData(), geometry.bitangentData(), geometry.qtangentData()};
+
+		// upload the interleaved vertices once
+		if (singleBuffer)
+		{
+			glGenBuffers(1, &bufferBindMap[prefix + "InterleavedBuffer"]);
+			glBindBuffer(GL_ARRAY_BUFFER, bufferBindMap[prefix + "InterleavedBuffer"]);
+			if (quantized)
+			{
+				glBufferData(GL_ARRAY_BUFFER, geometry.quantizedSize(), geometry.quantizedData(), GL_STATIC_DRAW);
+			}
+			else
+			{
+				glBufferData(GL_ARRAY_BUFFER, geometry.interleavedSize(), geometry.interleavedData(), GL_STATIC_DRAW);
+			}
+		}
+
+		// bind every attribute the mesh has
+		for (int attribute = 0; attribute < VERTEX_ATTRIBUTE_COUNT; attribute++)
+		{
+			int components = layout.components[attribute];
+			if (components == 0)
+			{
+				continue;
+			}
+			if (!singleBuffer)
+			{
+				glGenBuffers(1, &bufferBindMap[prefix + VERTEX_BUFFER_NAMES[attribute]]);
+				glBindBuffer(GL_ARRAY_BUFFER, bufferBindMap[prefix + VERTEX_BUFFER_NAMES[attribute]]);
+				size_t componentSize = (layout.formats[attribute] == SNORM16_FORMAT) ? sizeof(GLshort) : sizeof(GLfloat);
+				glBufferData(GL_ARRAY_BUFFER, geometry.vertexCount() * components * componentSize, attributeData[attribute], GL_STATIC_DRAW);
+			}
+			GLsizei stride = singleBuffer ? layout.stride : 0;
+			size_t offset = singleBuffer ? layout.offsets[attribute] : 0;
+			GLboolean normalized = (layout.formats[attribute] == UNORM16_FORMAT) || (layout.formats[attribute] == SNORM_1010102_FORMAT) ||
+				(layout.formats[attribute] == SNORM16_FORMAT);
+			shaderBindMap[prefix + VERTEX_BIND_NAMES[attribute]] = glGetAttribLocation(bufferBindMap["phongShader"], VERTEX_ATTRIBUTE_NAMES[attribute]);
+			glVertexAttribPointer(shaderBindMap[prefix + VERTEX_BIND_NAMES[attribute]], components, glVertexFormat(layout.formats[attribute]),
+				normalized, stride, (const void*)offset);
+			glEnableVertexAttribArray(shaderBindMap[prefix + VERTEX_BIND_NAMES[attribute]]);
+		}
+		cout << "    - Uploaded " << geometry.vertexCount() << " " << prefix << " vertices using the "
+			<< (quantized ? "quantized" : (singleBuffer ? "interleaved" : "separate")) << " layout ("
+			<< layout.stride << " bytes per interleaved vertex)" << endl;
+	}
+
+	void OpenGLWindow::uploadTerrainPool()
+	{
+		// NOTE: Every chunk takes one slot of the pool and is drawn with the slot's first vertex as its base
+		//       vertex, so all of them share the one index buffer
+		VertexLayout layout = fTerrain.vertexLayout();
+		size_t chunkSize = (size_t)TERRAIN_CHUNK_VERTICES * fTerrain.vertexStride();
+
+		// allocate the pool
+		glGenBuffers(1, &bufferBindMap["terrainPoolBuffer"]);
+		glBindBuffer(GL_ARRAY_BUFFER, bufferBindMap["terrainPoolBuffer"]);
+		glBufferData(GL_ARRAY_BUFFER, chunkSize * fTerrain.slotCount(), NULL, GL_DYNAMIC_DRAW);
+
+		// bind every attribute, and the morph targets after them
+		for (int attribute = 0; attribute < VERTEX_ATTRIBUTE_COUNT; attribute++)
+		{
+			if (layout.components[attribute] == 0)
+			{
+				continue;
+			}
+			shaderBindMap[string("terrain") + VERTEX_BIND_NAMES[attribute]] = glGetAttribLocation(bufferBindMap["phongShader"], VERTEX_ATTRIBUTE_NAMES[attribute]);
+			glVertexAttribPointer(shaderBindMap[string("terrain") + VERTEX_BIND_NAMES[attribute]], layout.components[attribute], GL_FLOAT,
+				GL_FALSE, layout.stride, (const void*)(size_t)layout.offsets[attribute]);
+			glEnableVertexAttribArray(shaderBindMap[string("terrain") + VERTEX_BIND_NAMES[attribute]]);
+		}
+		shaderBindMap["terrainmorphtarget"] = glGetAttribLocation(bufferBindMap["phongShader"], "morphTarget");
+		glVertexAttribPointer(shaderBindMap["terrainmorphtarget"], 3, GL_FLOAT, GL_FALSE, layout.stride, (const void*)(size_t)fTerrain.morphOffset());
+		glEnableVertexAttribArray(shaderBindMap["terrainmorphtarget"]);
+
+		// indices (the element buffer binding is stored in the bound VAO)
+		glGenBuffers(1, &bufferBindMap["terrainIndexBuffer"]);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bufferBindMap["terrainIndexBuffer"]);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, fTerrain.indexCount() * sizeof(GLushort), fTerrain.indexData(), GL_STATIC_DRAW);
+
+		// the root chunks
+		for (int upload = 0; upload < fTerrain.uploadCount(); upload++)
+		{
+			const TerrainUpload& chunk = fTerrain.uploadData()[upload];
+			glBufferSubData(GL_ARRAY_BUFFER, chunk.slot * chunkSize, chunkSize, chunk.vertices);
+		}
+		fTerrain.finishUploads();
+		cout << "    - Allocated a terrain pool of " << fTerrain.slotCount() << " chunks (" << layout.stride
+			<< " bytes per vertex)" << endl;
+	}
+
+	void OpenGLWindow::setVertexDecode(GeometryData& geometry)
+	{
+		// quantized positions are stored relative to the mesh bounds, float ones are used as is
+		glm::vec3 scale = (fVertexLayout == QUANTIZED_LAYOUT) ? geometry.quantizedScale() : glm::vec3(1.0f, 1.0f, 1.0f);
+		glm::vec3 offset = (fVertexLayout == QUANTIZED_LAYOUT) ? geometry.quantizedOffset() : glm::vec3(0.0f, 0.0f, 0.0f);
+		glUniform3fv(shaderBindMap["positionScale"], 1, &scale[0]);
+		glUniform3fv(shaderBindMap["positionOffset"], 1, &offset[0]);
+		// tangent frames come either as three vectors or as one qtangent
+		glUniform1i(shaderBindMap["tangentFrame"], (geometry.qtangentCount() > 0) ? 1 : 0);
+	}
+
+	int OpenGLWindow::selectLOD(GeometryData& geometry, glm::mat4 modelMatrix)
+	{
+		// NOTE: A level's error is projected at the point of the bounding sphere nearest to the camera, and the
+		//       coarsest level whose error stays under fMaxPixelError pixels is drawn
+		float scale = glm::max(glm::length(glm::vec3(modelMatrix[0])), glm::max(glm::length(glm::vec3(modelMatrix[1])),
+			glm::length(glm::vec3(modelMatrix[2]))));
+		float radius = geometry.sphereRadius() * scale;
+		glm::vec4 viewCenter = fViewMatrix * modelMatrix * glm::vec4(geometry.sphereCenter(), 1.0f);
+		float distance = glm::length(glm::vec3(viewCenter)) - radius;
+		if (distance <= 0.0f)
+		{
+			return 0;
+		}
+		float pixelsPerUnit = fabsf(fProjectionMatrix[1][1]) * fHeight * 0.5f / distance;
+		int level = 0;
+		while (((level + 1) < geometry.lodCount()) && ((geometry.lodError(level + 1) * scale * pixelsPerUnit) <= fMaxPixelError))
+		{
+			level++;
+		}
+		return level;
+	}
+
+	void OpenGLWindow::drawGeometry(GeometryData& geometry, glm::mat4 modelMatrix, GLenum mode)
+	{
+		// NOTE: All tests happen in the mesh's own space: the frustum planes come straight out of the
+		//       MVP matrix (Gribb & Hartmann), and the camera is the view space origin moved back into it
+		glm::vec4 frustumPlanes[6];
+		getFrustumPlanes(fProjectionMatrix * fViewMatrix * modelMatrix, frustumPlanes);
+
+		// skip meshes whose bounding sphere is outside the view
+		if (fClusterCulling)
+		{
+			for (int plane = 0; plane < 6; plane++)
+			{
+				if ((glm::dot(glm::vec3(frustumPlanes[plane]), geometry.sphereCenter()) + frustumPlanes[plane].w) < -geometry.sphereRadius())
+				{
+					return;
+				}
+			}
+		}
+
+		// coarser levels are drawn whole
+		int level = selectLOD(geometry, modelMatrix);
+		if ((level > 0) || (geometry.meshletCount() == 0) || !fClusterCulling)
+		{
+			glDrawElements(mode, geometry.lodIndexCount(level), glIndexType(geometry), glIndexOffset(geometry, level));
+			return;
+		}
+		glm::vec4 cameraPosition = glm::inverse(fViewMatrix * modelMatrix) * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+
+		// gather the visible meshlets, merging neighbours into one range
+		const Meshlet* meshlets = geometry.meshletData();
+		fDrawCounts.clear();
+		fDrawOffsets.clear();
+		size_t nextOffset = 0;
+		for (int m = 0; m < geometry.meshletCount(); m++)
+		{
+			const Meshlet& meshlet = meshlets[m];
+			bool visible = true;
+			for (int plane = 0; visible && (plane < 6); plane++)
+			{
+				visible = (glm::dot(glm::vec3(frustumPlanes[plane]), glm::vec3(meshlet.center[0], meshlet.center[1], meshlet.center[2])) +
+					frustumPlanes[plane].w) >= -meshlet.radius;
+			}
+			// NOTE: Lines aren't culled by facing, so wireframes keep their back faces
+			if (!visible || ((mode == GL_TRIANGLES) && meshletFacesAway(meshlet, &cameraPosition[0])))
+			{
+				continue;
+			}
+			size_t offset = (size_t)meshlet.indexOffset * geometry.indexSize();
+			if (!fDrawCounts.empty() && (offset == nextOffset))
+			{
+				fDrawCounts.back() += 3 * meshlet.triangleCount;
+			}
+			else
+			{
+				fDrawCounts.push_back(3 * meshlet.triangleCount);
+				fDrawOffsets.push_back((const void*)offset);
+			}
+			nextOffset = offset + ((size_t)3 * meshlet.triangleCount * geometry.indexSize());
+		}
+		if (!fDrawCounts.empty())
+		{
+			glMultiDrawElements(mode, &fDrawCounts[0], glIndexType(geometry), &fDrawOffsets[0], (GLsizei)fDrawCounts.size());
+		}
+	}
+
+	void OpenGLWindow::drawTerrain(glm::mat4 modelMatrix, GLenum mode)
+	{
+		// NOTE: Like drawGeometry, everything happens in the planet's own space, so the pixels per unit at
+		//       unit distance carry the model's scale
+		glm::vec4 frustumPlanes[6];
+		getFrustumPlanes(fProjectionMatrix * fViewMatrix * modelMatrix, frustumPlanes);
+		glm::vec4 cameraPosition = glm::inverse(fViewMatrix * modelMatrix) * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+		float scale = glm::max(glm::length(glm::vec3(modelMatrix[0])), glm::max(glm::length(glm::vec3(modelMatrix[1])),
+			glm::length(glm::vec3(modelMatrix[2]))));
+		float pixelsPerUnit = fabsf(fProjectionMatrix[1][1]) * fHeight * 0.5f * scale;
+		fTerrain.update(glm::vec3(cameraPosition), fClusterCulling ? frustumPlanes : NULL, pixelsPerUnit);
+
+		// move this frame's chunks into the pool
+		// NOTE: A slot is only reused once its chunk went a whole frame undrawn, so these never overwrite
+		//       vertices the previous frame may still be drawing from
+		size_t chunkSize = (size_t)TERRAIN_CHUNK_VERTICES * fTerrain.vertexStride();
+		glBindBuffer(GL_ARRAY_BUFFER, bufferBindMap["terrainPoolBuffer"]);
+		for (int upload = 0; upload < fTerrain.uploadCount(); upload++)
+		{
+			const TerrainUpload& chunk = fTerrain.uploadData()[upload];
+			glBufferSubData(GL_ARRAY_BUFFER, chunk.slot * chunkSize, chunkSize, chunk.vertices);
+		}
+		fTerrain.finishUploads();
+
+		// terrain vertices are plain floats
+		glm::vec3 identityScale = {1.0f, 1.0f, 1.0f};
+		glm::vec3 identityOffset = {0.0f, 0.0f, 0.0f};
+		glUniform3fv(shaderBindMap["positionScale"], 1, &identityScale[0]);
+		glUniform3fv(shaderBindMap["positionOffset"], 1, &identityOffset[0]);
+		glUniform1i(shaderBindMap["tangentFrame"], 0);
+		glUniform3fv(shaderBindMap["morphCamera"], 1, &cameraPosition[0]);
+		glUniform1f(shaderBindMap["morphRadius"], fTerrainSettings.radius);
+
+		// draw the chunks, which come grouped by depth
+		const TerrainDraw* draws = fTerrain.drawData();
+		int morphDepth = -1;
+		for (int draw = 0; draw < fTerrain.drawCount(); draw++)
+		{
+			if (draws[draw].depth != morphDepth)
+			{
+				morphDepth = draws[draw].depth;
+				glUniform2f(shaderBindMap["morphRange"], draws[draw].morphStart, draws[draw].morphEnd);
+			}
+			glDrawElementsBaseVertex(mode, draws[draw].indexCount, GL_UNSIGNED_SHORT, (const void*)(draws[draw].indexOffset * sizeof(GLushort)),
+				draws[draw].slot * TERRAIN_CHUNK_VERTICES);
+		}
+		glUniform2f(shaderBindMap["morphRange"], 0.0f, 0.0f);
+	}
+
+	void OpenGLWindow::getFrustumPlanes(glm::mat4 transformMVP, glm::vec4* planes)
+	{
+		// NOTE: Gribb & Hartmann: each plane is the last row of the matrix plus or minus one of the others,
+		//       normalized so plane distances come out in the matrix's input units
+		for (int plane = 0; plane < 6; plane++)
+		{
+			int row = plane / 2;
+			float side = (plane % 2) ? -1.0f : 1.0f;
+			planes[plane] = glm::vec4(transformMVP[0][3] + (side * transformMVP[0][row]), transformMVP[1][3] + (side * transformMVP[1][row]),
+				transformMVP[2][3] + (side * transformMVP[2][row]), transformMVP[3][3] + (side * transformMVP[3][row]));
+			planes[plane] /= glm::length(glm::vec3(planes[plane]));
+		}
+	}
+
 	glm::mat4 OpenGLWindow::getViewMatrix()
 	{
 		// recalculate
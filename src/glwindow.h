@@ -18,13 +18,21 @@
 #include <iostream>
 #include <stdio.h>
 #include <map>
+#include <vector>
 
 #include "stb_image.h"
 #include "geometry.h"
+#include "terrain.h"
+#include "textures.h"
+#include "blockcompress.h"
 
 //// Classes Declarations
 namespace SWPTAS001
 {
+	//// Constants
+	static const char* const MODEL_TEXTURE_PATH = "Textures/venusmap.png";
+	static const char* const MODEL_BUMPMAP_PATH = "Textures/venusbump.png";
+
 	//// Enums
 	enum ControlMode {CAMERA, MODEL, LIGHT1, LIGHT2};
 	enum InputMode {DISABLED, TRANSLATE, ALLSCALE, SCALE, ROTATE};
@@ -44,6 +52,17 @@ namespace SWPTAS001
 			std::map<std::string, GLuint> bufferBindMap;
 			GeometryData fModelGeometry;
 			GeometryData fLightGeometry;
+			LoaderSettings fLoaderSettings;
+			VertexLayoutMode fVertexLayout = SEPARATE_LAYOUT;
+			bool fClusterCulling = true;
+			SphereShape fLightShape = ICOSPHERE;
+			PlanetTerrain fTerrain;
+			TerrainSettings fTerrainSettings;
+			HeightMap fHeightMap;
+			TextureDecoder* fTextureDecoder = NULL;
+			bool fTerrainEnabled = true;
+			std::vector<GLsizei> fDrawCounts;
+			std::vector<const void*> fDrawOffsets;
 			
 		//// Buffers
 		private:
@@ -69,6 +88,7 @@ namespace SWPTAS001
 			bool fAutoRotate = true;
 			float fRotationAngle = 0;
 			float fOrbitDistace[2] = {6.5f, 7.5f};
+			float fMaxPixelError = 1.0f;
 			
 		//// 3D World
 		private:
@@ -104,6 +124,19 @@ namespace SWPTAS001
 			void fillNTransformBuffer(glm::mat3 theData);
 			void fillColorBuffer(glm::vec3 theColor);
 			void setRenderType(int theRenderType);
+			void setLoaderSettings(LoaderSettings theSettings);
+			void setVertexLayout(VertexLayoutMode theLayout);
+			void setClusterCulling(bool theCulling);
+			void setLightShape(SphereShape theShape);
+			void setTerrainEnabled(bool theTerrain);
+			void setTextureDecoder(TextureDecoder* theDecoder);
+			void uploadVertexData(GeometryData& geometry, std::string prefix);
+			void uploadTerrainPool();
+			void setVertexDecode(GeometryData& geometry);
+			int selectLOD(GeometryData& geometry, glm::mat4 modelMatrix);
+			void drawGeometry(GeometryData& geometry, glm::mat4 modelMatrix, GLenum mode);
+			void drawTerrain(glm::mat4 modelMatrix, GLenum mode);
+			void getFrustumPlanes(glm::mat4 transformMVP, glm::vec4* planes);
 			glm::mat4 getViewMatrix();
 			glm::mat4 getProjectionMatrix();
 			void clampVector(glm::vec3 & theVector, float minValue, float maxValue);
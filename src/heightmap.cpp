@@ -0,0 +1,463 @@
+//// Configurations
+#define STB_IMAGE_IMPLEMENTATION
+
+//// Header
+#include "heightmap.h"
+
+//// Imports
+#include "stb_image.h"
+#include "parallel.h"
+#include <complex>
+#include <algorithm>
+#include <iostream>
+#include <chrono>
+#include <math.h>
+
+//// Configurations
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define HEIGHTMAP_SSE2
+#include <emmintrin.h>
+#endif
+
+//// Namespaces
+using namespace std;
+
+namespace SWPTAS001
+{
+	//// Constants
+	static const double PI = 3.14159265358979323846;
+	static const float MIN_NORMAL_Z = 0.1f; // keeps slopes finite where a normal map lies nearly flat
+	static const size_t DERIVE_ROW_BLOCK = 16;
+	static const float SCHARR_SIDE = 3.0f;
+	static const float SCHARR_CENTRE = 10.0f;
+	static const float SCHARR_SCALE = 1.0f / (2.0f * (SCHARR_SIDE + SCHARR_CENTRE + SCHARR_SIDE)); // back to height per texel
+
+	/////////////
+	// Helpers //
+	/////////////
+
+	static int nextPowerOfTwo(int value)
+	{
+		int power = 1;
+		while (power < value)
+		{
+			power <<= 1;
+		}
+		return power;
+	}
+
+	// In place radix-2 FFT of count (a power of 2) values, using a table of count / 2 forward twiddles
+	static void transform(complex<float>* data, size_t count, const vector<complex<float> >& twiddles, bool inverse)
+	{
+		// reorder by bit reversed index
+		for (size_t i = 1, j = 0; i < count; i++)
+		{
+			size_t bit = count >> 1;
+			for (; j & bit; bit >>= 1)
+			{
+				j ^= bit;
+			}
+			j ^= bit;
+			if (i < j)
+			{
+				swap(data[i], data[j]);
+			}
+		}
+		// butterflies
+		for (size_t length = 2; length <= count; length <<= 1)
+		{
+			size_t half = length / 2;
+			size_t twiddleStep = count / length;
+			for (size_t start = 0; start < count; start += length)
+			{
+				for (size_t k = 0; k < half; k++)
+				{
+					// NOTE: Multiplied out by hand, complex<float>'s operator* checks for infinities
+					const complex<float>& twiddle = twiddles[k * twiddleStep];
+					float twiddleImag = inverse ? -twiddle.imag() : twiddle.imag();
+					const complex<float>& value = data[start + k + half];
+					complex<float> even = data[start + k];
+					complex<float> odd((value.real() * twiddle.real()) - (value.imag() * twiddleImag),
+						(value.real() * twiddleImag) + (value.imag() * twiddle.real()));
+					data[start + k] = even + odd;
+					data[start + k + half] = even - odd;
+				}
+			}
+		}
+	}
+
+	static vector<complex<float> > twiddleTable(size_t count)
+	{
+		vector<complex<float> > twiddles(count / 2);
+		for (size_t k = 0; k < twiddles.size(); k++)
+		{
+			double angle = -2.0 * PI * (double)k / (double)count;
+			twiddles[k] = complex<float>((float)cos(angle), (float)sin(angle));
+		}
+		return twiddles;
+	}
+
+	// 2D FFT of a width x rows grid (both powers of 2), rows then columns
+	static void transform2D(vector<complex<float> >& grid, int width, int rows, bool inverse, int threadCount)
+	{
+		vector<complex<float> > rowTwiddles = twiddleTable(width);
+		vector<complex<float> > columnTwiddles = twiddleTable(rows);
+		parallelFor(rows, threadCount, [&](size_t row)
+		{
+			transform(&grid[row * width], width, rowTwiddles, inverse);
+		});
+		parallelFor(width, threadCount, [&](size_t column)
+		{
+			vector<complex<float> > values(rows);
+			for (int row = 0; row < rows; row++)
+			{
+				values[row] = grid[(row * width) + column];
+			}
+			transform(&values[0], rows, columnTwiddles, inverse);
+			for (int row = 0; row < rows; row++)
+			{
+				grid[(row * width) + column] = values[row];
+			}
+		});
+	}
+
+	// Recovers heights (in texels) from the slopes of an RGBA normal map
+	static void integrateNormals(const unsigned char* pixels, int width, int height, vector<float>& heights, int threadCount)
+	{
+		// NOTE: The FFT needs powers of 2, other sizes are resampled to the next ones and back. Rows are
+		//       mirrored below the map, so the field repeats in v without a jump at the poles
+		int gridWidth = nextPowerOfTwo(width);
+		int gridHeight = nextPowerOfTwo(height);
+		int gridRows = 2 * gridHeight;
+		// NOTE: Both slopes are real, so they share one transform as slopes = P + i Q
+		vector<complex<float> > slopes((size_t)gridWidth * gridRows);
+		parallelFor(gridHeight, threadCount, [&](size_t row)
+		{
+			const unsigned char* sourceRow = pixels + ((((size_t)row * height) / gridHeight) * width * 4);
+			for (int column = 0; column < gridWidth; column++)
+			{
+				const unsigned char* pixel = sourceRow + ((((size_t)column * width) / gridWidth) * 4);
+				float normalX = (pixel[0] / 255.0f) * 2.0f - 1.0f;
+				float normalY = (pixel[1] / 255.0f) * 2.0f - 1.0f;
+				float normalZ = max((pixel[2] / 255.0f) * 2.0f - 1.0f, MIN_NORMAL_Z);
+				size_t mirrored = (size_t)(gridRows - 1 - row) * gridWidth + column;
+				slopes[(row * gridWidth) + column] = complex<float>(-normalX / normalZ, -normalY / normalZ);
+				slopes[mirrored] = complex<float>(-normalX / normalZ, normalY / normalZ);
+			}
+		});
+
+		// project onto the nearest integrable field: H = -i (wx P + wy Q) / (wx^2 + wy^2)
+		transform2D(slopes, gridWidth, gridRows, false, threadCount);
+		vector<complex<float> > surface(slopes.size());
+		parallelFor(gridRows, threadCount, [&](size_t row)
+		{
+			int frequencyY = ((int)row < (gridRows / 2)) ? (int)row : ((int)row - gridRows);
+			float omegaY = (float)(2.0 * PI * frequencyY / gridRows);
+			size_t mirrorRow = (gridRows - row) % gridRows;
+			for (int column = 0; column < gridWidth; column++)
+			{
+				int frequencyX = (column < (gridWidth / 2)) ? column : (column - gridWidth);
+				float omegaX = (float)(2.0 * PI * frequencyX / gridWidth);
+				float denominator = (omegaX * omegaX) + (omegaY * omegaY);
+				complex<float> value = slopes[(row * gridWidth) + column];
+				complex<float> mirror = conj(slopes[(mirrorRow * gridWidth) + ((gridWidth - column) % gridWidth)]);
+				complex<float> slopeX = (value + mirror) * 0.5f;
+				complex<float> slopeY = (value - mirror) * 0.5f;
+				slopeY = complex<float>(slopeY.imag(), -slopeY.real());
+				complex<float> divergence = (omegaX * slopeX) + (omegaY * slopeY);
+				surface[(row * gridWidth) + column] = (denominator > 0.0f) ?
+					complex<float>(divergence.imag() / denominator, -divergence.real() / denominator) : complex<float>(0.0f, 0.0f);
+			}
+		});
+		transform2D(surface, gridWidth, gridRows, true, threadCount);
+
+		// sample the upper half back at the map's size
+		heights.resize((size_t)width * height);
+		float scale = 1.0f / ((float)gridWidth * gridRows);
+		for (int row = 0; row < height; row++)
+		{
+			size_t gridRow = ((size_t)row * gridHeight) / height;
+			for (int column = 0; column < width; column++)
+			{
+				size_t gridColumn = ((size_t)column * gridWidth) / width;
+				heights[((size_t)row * width) + column] = surface[(gridRow * gridWidth) + gridColumn].real() * scale;
+			}
+		}
+	}
+
+	static void liftGrayRow(const unsigned char* pixels, int width, float* target)
+	{
+		// NOTE: target gets one more texel at each end, wrapped around from the other side
+		for (int column = 0; column < width; column++)
+		{
+			target[column + 1] = pixels[4 * column] / 255.0f;
+		}
+		target[0] = target[width];
+		target[width + 1] = target[1];
+	}
+
+	static inline unsigned char encodeNormal(float value)
+	{
+		return (unsigned char)(min(max((value * 0.5f) + 0.5f, 0.0f), 1.0f) * 255.0f + 0.5f);
+	}
+
+	// Writes the normals of one row of heights from the lifted rows above, at and below it
+	static void deriveNormalRow(const float* above, const float* centre, const float* below, int width, float strength, unsigned char* target)
+	{
+		// NOTE: Every path takes the same steps in the same order, so they give the same bytes
+		int column = 0;
+		float slopeScale = strength * SCHARR_SCALE;
+#ifdef HEIGHTMAP_SSE2
+		const __m128 side = _mm_set1_ps(SCHARR_SIDE);
+		const __m128 middle = _mm_set1_ps(SCHARR_CENTRE);
+		const __m128 scale = _mm_set1_ps(slopeScale);
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 half = _mm_set1_ps(0.5f);
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 full = _mm_set1_ps(255.0f);
+		for (; (column + 4) <= width; column += 4)
+		{
+			__m128 aboveLeft = _mm_loadu_ps(above + column);
+			__m128 aboveMiddle = _mm_loadu_ps(above + column + 1);
+			__m128 aboveRight = _mm_loadu_ps(above + column + 2);
+			__m128 centreLeft = _mm_loadu_ps(centre + column);
+			__m128 centreRight = _mm_loadu_ps(centre + column + 2);
+			__m128 belowLeft = _mm_loadu_ps(below + column);
+			__m128 belowMiddle = _mm_loadu_ps(below + column + 1);
+			__m128 belowRight = _mm_loadu_ps(below + column + 2);
+			__m128 slopeX = _mm_add_ps(_mm_add_ps(_mm_mul_ps(side, _mm_sub_ps(aboveRight, aboveLeft)),
+				_mm_mul_ps(middle, _mm_sub_ps(centreRight, centreLeft))), _mm_mul_ps(side, _mm_sub_ps(belowRight, belowLeft)));
+			__m128 slopeY = _mm_add_ps(_mm_add_ps(_mm_mul_ps(side, _mm_sub_ps(belowLeft, aboveLeft)),
+				_mm_mul_ps(middle, _mm_sub_ps(belowMiddle, aboveMiddle))), _mm_mul_ps(side, _mm_sub_ps(belowRight, aboveRight)));
+			slopeX = _mm_mul_ps(slopeX, scale);
+			slopeY = _mm_mul_ps(slopeY, scale);
+			__m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(slopeX, slopeX), _mm_mul_ps(slopeY, slopeY)), one));
+			__m128 normals[3] = {_mm_div_ps(_mm_sub_ps(zero, slopeX), length), _mm_div_ps(_mm_sub_ps(zero, slopeY), length), _mm_div_ps(one, length)};
+			int codes[3][4];
+			for (int channel = 0; channel < 3; channel++)
+			{
+				__m128 value = _mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_mul_ps(normals[channel], half), half), zero), one);
+				_mm_storeu_si128((__m128i*)codes[channel], _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, full), half)));
+			}
+			for (int lane = 0; lane < 4; lane++)
+			{
+				unsigned char* texel = target + (4 * (column + lane));
+				texel[0] = (unsigned char)codes[0][lane];
+				texel[1] = (unsigned char)codes[1][lane];
+				texel[2] = (unsigned char)codes[2][lane];
+				texel[3] = 255;
+			}
+		}
+#endif
+		for (; column < width; column++)
+		{
+			float slopeX = ((SCHARR_SIDE * (above[column + 2] - above[column])) + (SCHARR_CENTRE * (centre[column + 2] - centre[column])))
+				+ (SCHARR_SIDE * (below[column + 2] - below[column]));
+			float slopeY = ((SCHARR_SIDE * (below[column] - above[column])) + (SCHARR_CENTRE * (below[column + 1] - above[column + 1])))
+				+ (SCHARR_SIDE * (below[column + 2] - above[column + 2]));
+			slopeX *= slopeScale;
+			slopeY *= slopeScale;
+			float length = sqrtf(((slopeX * slopeX) + (slopeY * slopeY)) + 1.0f);
+			unsigned char* texel = target + (4 * column);
+			texel[0] = encodeNormal((0.0f - slopeX) / length);
+			texel[1] = encodeNormal((0.0f - slopeY) / length);
+			texel[2] = encodeNormal(1.0f / length);
+			texel[3] = 255;
+		}
+	}
+
+	/////////////////////////
+	// Height Map Routines //
+	/////////////////////////
+
+	bool loadHeightMap(string filename, HeightMap& map, int threadCount)
+	{
+		// decode
+		int width, height, channels;
+		unsigned char* pixels = stbi_load(filename.c_str(), &width, &height, &channels, 4);
+		if (!pixels)
+		{
+			cout << "Unable to open height map: " << filename << endl;
+			return false;
+		}
+		buildHeightMap(pixels, width, height, map, threadCount);
+		stbi_image_free(pixels);
+		return true;
+	}
+
+	void buildHeightMap(const unsigned char* pixels, int width, int height, HeightMap& map, int threadCount)
+	{
+		chrono::high_resolution_clock::time_point buildStart = chrono::high_resolution_clock::now();
+		map.width = width;
+		map.height = height;
+
+		// grayscale images are heights already, anything else is a normal map
+		size_t texelCount = (size_t)width * height;
+		bool grayscale = isGrayscale(pixels, texelCount);
+		map.fromNormals = !grayscale;
+		if (grayscale)
+		{
+			map.heights.resize(texelCount);
+			for (size_t texel = 0; texel < texelCount; texel++)
+			{
+				map.heights[texel] = pixels[4 * texel] / 255.0f;
+			}
+		}
+		else
+		{
+			integrateNormals(pixels, width, height, map.heights, threadCount);
+		}
+
+		// rescale to [0, 1] and flatten the poles
+		float lowest = *min_element(map.heights.begin(), map.heights.end());
+		float highest = *max_element(map.heights.begin(), map.heights.end());
+		float range = (highest > lowest) ? (highest - lowest) : 1.0f;
+		for (size_t texel = 0; texel < texelCount; texel++)
+		{
+			map.heights[texel] = (map.heights[texel] - lowest) / range;
+		}
+		for (int pole = 0; pole < 2; pole++)
+		{
+			float* row = &map.heights[(pole == 0) ? 0 : ((size_t)(height - 1) * width)];
+			double total = 0.0;
+			for (int column = 0; column < width; column++)
+			{
+				total += row[column];
+			}
+			fill(row, row + width, (float)(total / width));
+		}
+		double buildTime = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - buildStart).count();
+		cout << "    - Built a " << width << " x " << height << " height map" << (map.fromNormals ? " (integrated from its normals)" : "")
+			<< " in " << buildTime << " ms" << endl;
+	}
+
+	float sampleHeight(const HeightMap& map, float u, float v)
+	{
+		// horizontal texels wrap
+		u -= floorf(u);
+		float x = (u * map.width) - 0.5f;
+		float columnFloor = floorf(x);
+		float across = x - columnFloor;
+		int column0 = (int)columnFloor;
+		column0 += (column0 < 0) ? map.width : 0;
+		int column1 = column0 + 1;
+		column1 -= (column1 == map.width) ? map.width : 0;
+
+		// vertical texels clamp
+		float y = min(max((v * map.height) - 0.5f, 0.0f), (float)(map.height - 1));
+		float rowFloor = floorf(y);
+		float up = y - rowFloor;
+		int row0 = (int)rowFloor;
+		int row1 = row0 + ((row0 < (map.height - 1)) ? 1 : 0);
+
+		// blend
+		const float* lower = &map.heights[(size_t)row0 * map.width];
+		const float* upper = &map.heights[(size_t)row1 * map.width];
+		float bottom = lower[column0] + ((lower[column1] - lower[column0]) * across);
+		float top = upper[column0] + ((upper[column1] - upper[column0]) * across);
+		return bottom + ((top - bottom) * up);
+	}
+
+	void sampleHeights(const HeightMap& map, const float* textureCoords, size_t count, float* heights)
+	{
+		size_t sample = 0;
+#ifdef HEIGHTMAP_SSE2
+		// NOTE: The same steps as sampleHeight(), 4 samples wide, only the texel loads stay scalar
+		const __m128 one = _mm_set1_ps(1.0f);
+		const __m128 half = _mm_set1_ps(0.5f);
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 width = _mm_set1_ps((float)map.width);
+		const __m128 height = _mm_set1_ps((float)map.height);
+		const __m128 lastRow = _mm_set1_ps((float)(map.height - 1));
+		const __m128i widthInt = _mm_set1_epi32(map.width);
+		const __m128i lastRowInt = _mm_set1_epi32(map.height - 1);
+		const __m128i oneInt = _mm_set1_epi32(1);
+		for (; (sample + 4) <= count; sample += 4)
+		{
+			__m128 pairs0 = _mm_loadu_ps(textureCoords + (2 * sample));
+			__m128 pairs1 = _mm_loadu_ps(textureCoords + (2 * sample) + 4);
+			__m128 u = _mm_shuffle_ps(pairs0, pairs1, _MM_SHUFFLE(2, 0, 2, 0));
+			__m128 v = _mm_shuffle_ps(pairs0, pairs1, _MM_SHUFFLE(3, 1, 3, 1));
+			// horizontal texels wrap
+			__m128 uFloor = _mm_cvtepi32_ps(_mm_cvttps_epi32(u));
+			uFloor = _mm_sub_ps(uFloor, _mm_and_ps(_mm_cmpgt_ps(uFloor, u), one));
+			u = _mm_sub_ps(u, uFloor);
+			__m128 x = _mm_sub_ps(_mm_mul_ps(u, width), half);
+			__m128 columnFloor = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+			columnFloor = _mm_sub_ps(columnFloor, _mm_and_ps(_mm_cmpgt_ps(columnFloor, x), one));
+			__m128 across = _mm_sub_ps(x, columnFloor);
+			__m128i column0 = _mm_cvttps_epi32(columnFloor);
+			column0 = _mm_add_epi32(column0, _mm_and_si128(_mm_cmplt_epi32(column0, _mm_setzero_si128()), widthInt));
+			__m128i column1 = _mm_add_epi32(column0, oneInt);
+			column1 = _mm_sub_epi32(column1, _mm_and_si128(_mm_cmpeq_epi32(column1, widthInt), widthInt));
+			// vertical texels clamp
+			__m128 y = _mm_min_ps(_mm_max_ps(_mm_sub_ps(_mm_mul_ps(v, height), half), zero), lastRow);
+			__m128 rowFloor = _mm_cvtepi32_ps(_mm_cvttps_epi32(y));
+			__m128 up = _mm_sub_ps(y, rowFloor);
+			__m128i row0 = _mm_cvttps_epi32(rowFloor);
+			__m128i row1 = _mm_add_epi32(row0, _mm_and_si128(_mm_cmplt_epi32(row0, lastRowInt), oneInt));
+			// fetch
+			int columns0[4], columns1[4], rows0[4], rows1[4];
+			_mm_storeu_si128((__m128i*)columns0, column0);
+			_mm_storeu_si128((__m128i*)columns1, column1);
+			_mm_storeu_si128((__m128i*)rows0, row0);
+			_mm_storeu_si128((__m128i*)rows1, row1);
+			float texels[4][4];
+			for (int lane = 0; lane < 4; lane++)
+			{
+				const float* lower = &map.heights[(size_t)rows0[lane] * map.width];
+				const float* upper = &map.heights[(size_t)rows1[lane] * map.width];
+				texels[0][lane] = lower[columns0[lane]];
+				texels[1][lane] = lower[columns1[lane]];
+				texels[2][lane] = upper[columns0[lane]];
+				texels[3][lane] = upper[columns1[lane]];
+			}
+			// blend
+			__m128 lowerLeft = _mm_loadu_ps(texels[0]);
+			__m128 upperLeft = _mm_loadu_ps(texels[2]);
+			__m128 bottom = _mm_add_ps(lowerLeft, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(texels[1]), lowerLeft), across));
+			__m128 top = _mm_add_ps(upperLeft, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(texels[3]), upperLeft), across));
+			_mm_storeu_ps(heights + sample, _mm_add_ps(bottom, _mm_mul_ps(_mm_sub_ps(top, bottom), up)));
+		}
+#endif
+		for (; sample < count; sample++)
+		{
+			heights[sample] = sampleHeight(map, textureCoords[2 * sample], textureCoords[(2 * sample) + 1]);
+		}
+	}
+
+	bool isGrayscale(const unsigned char* pixels, size_t texelCount)
+	{
+		for (size_t texel = 0; texel < texelCount; texel++)
+		{
+			if ((pixels[4 * texel] != pixels[(4 * texel) + 1]) || (pixels[4 * texel] != pixels[(4 * texel) + 2]))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void deriveNormalMap(const unsigned char* pixels, int width, int height, float strength, unsigned char* normals, int threadCount)
+	{
+		// NOTE: Each task lifts its rows plus one above and below into floats, so no task waits on another
+		size_t blockCount = ((size_t)height + DERIVE_ROW_BLOCK - 1) / DERIVE_ROW_BLOCK;
+		parallelFor(blockCount, threadCount, [&](size_t block)
+		{
+			int firstRow = (int)(block * DERIVE_ROW_BLOCK);
+			int lastRow = min(height, firstRow + (int)DERIVE_ROW_BLOCK);
+			size_t stride = (size_t)width + 2;
+			vector<float> lifted(stride * (lastRow - firstRow + 2));
+			for (int row = firstRow - 1; row <= lastRow; row++)
+			{
+				int sourceRow = min(max(row, 0), height - 1);
+				liftGrayRow(pixels + ((size_t)sourceRow * width * 4), width, &lifted[stride * (row - firstRow + 1)]);
+			}
+			for (int row = firstRow; row < lastRow; row++)
+			{
+				const float* centre = &lifted[stride * (row - firstRow + 1)];
+				deriveNormalRow(centre - stride, centre, centre + stride, width, strength, normals + ((size_t)row * width * 4));
+			}
+		});
+	}
+}
@@ -0,0 +1,48 @@
+//// Declaration Guards
+#ifndef HEIGHTMAP_H
+#define HEIGHTMAP_H
+
+//// Imports
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+namespace SWPTAS001
+{
+	//// Structures
+	struct HeightMap
+	{
+		int width = 0;
+		int height = 0;
+		std::vector<float> heights; // width * height, row by row from v = 0, in [0, 1]
+		bool fromNormals = false; // integrated from a normal map rather than read as heights
+	};
+
+	//// Height Map Routines
+	bool loadHeightMap(std::string filename, HeightMap& map, int threadCount);
+	void buildHeightMap(const unsigned char* pixels, int width, int height, HeightMap& map, int threadCount);
+	bool isGrayscale(const unsigned char* pixels, size_t texelCount);
+	void deriveNormalMap(const unsigned char* pixels, int width, int height, float strength, unsigned char* normals, int threadCount);
+	float sampleHeight(const HeightMap& map, float u, float v);
+	void sampleHeights(const HeightMap& map, const float* textureCoords, size_t count, float* heights);
+}
+
+#endif
+
+// NOTE: loadHeightMap() reads a grayscale image as heights straight away. Any other image is taken to be
+//       a tangent-space normal map (rgb * 2 - 1, as phong.frag reads modelBumpMap), whose slopes are
+//       integrated back into heights (Frankot & Chellappa, "A Method for Enforcing Integrability in Shape
+//       from Shading Algorithms"): the gradient field is projected onto the nearest integrable one with a
+//       2D FFT, wrapping in u and mirrored in v. Either way heights are rescaled to [0, 1], and the first
+//       and last rows are flattened to their mean so each pole gets one height whatever its longitude
+// NOTE: buildHeightMap() does the same from RGBA pixels that were already decoded, such as a texture
+// NOTE: deriveNormalMap() goes the other way, turning the heights of a grayscale RGBA image (as told by
+//       isGrayscale()) into a tangent-space normal map that phong.frag can read as modelBumpMap. Slopes
+//       come from a 3 x 3 Scharr filter, wrapping in u like an equirectangular map's longitude and
+//       clamped in v at the poles, and strength is how many texels the full height range stands for.
+//       Rows are derived in parallel, 4 texels at a time with SSE2 where available, with the same
+//       bytes either way
+// NOTE: Samples are bilinear between texel centres like GL_LINEAR, wrapping in u and clamped in v, so a
+//       mesh displaced on the CPU lines up with the textures drawn over it. sampleHeights() takes
+//       interleaved uv pairs and samples 4 of them at a time with SSE2 where available, with the same
+//       result as sampleHeight()
@@ -3,13 +3,11 @@
 #include <Windows.h>
 #endif
 
-//// Configurations
-#define STB_IMAGE_IMPLEMENTATION
-
 //// Imports
 #include <SDL/SDL.h>
 #include <GL/glew.h>
 #include "glwindow.h"
+#include <stdlib.h>
 
 //// Environmental Guards
 #ifdef __linux__
@@ -24,6 +22,84 @@ int SDL_main(int argc, char** argv)
 
     // initialize
     std::cout << "\n[Advanced OpenGL]\n";
+	// parse arguments
+    SWPTAS001::LoaderSettings loaderSettings;
+    SWPTAS001::VertexLayoutMode vertexLayout = SWPTAS001::SEPARATE_LAYOUT;
+    bool clusterCulling = true;
+    bool terrain = true;
+    SWPTAS001::TextureSettings textureSettings;
+    SWPTAS001::SphereShape lightShape = SWPTAS001::ICOSPHERE;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        if ((argument == "--threads") && ((i + 1) < argc))
+        {
+            loaderSettings.threadCount = atoi(argv[++i]);
+        }
+        else if ((argument == "--memory-budget") && ((i + 1) < argc))
+        {
+            loaderSettings.memoryBudget = (size_t)atoi(argv[++i]) << 20;
+        }
+        else if ((argument == "--lod-levels") && ((i + 1) < argc))
+        {
+            loaderSettings.lodLevels = atoi(argv[++i]);
+        }
+        else if ((argument == "--displace") && ((i + 1) < argc))
+        {
+            loaderSettings.displacementScale = (float)atof(argv[++i]);
+        }
+        else if ((argument == "--crease-angle") && ((i + 1) < argc))
+        {
+            loaderSettings.creaseAngle = (float)atof(argv[++i]);
+        }
+        else if ((argument == "--layout") && ((i + 1) < argc))
+        {
+            std::string layout = argv[++i];
+            vertexLayout = (layout == "aos") ? SWPTAS001::INTERLEAVED_LAYOUT
+                : ((layout == "quantized") ? SWPTAS001::QUANTIZED_LAYOUT : SWPTAS001::SEPARATE_LAYOUT);
+        }
+        else if ((argument == "--light-sphere") && ((i + 1) < argc))
+        {
+            std::string shape = argv[++i];
+            lightShape = (shape == "cube") ? SWPTAS001::CUBE_SPHERE : SWPTAS001::ICOSPHERE;
+        }
+        else if (argument == "--no-cache")
+        {
+            loaderSettings.useMeshCache = false;
+        }
+        else if (argument == "--no-culling")
+        {
+            clusterCulling = false;
+        }
+        else if ((argument == "--bump-strength") && ((i + 1) < argc))
+        {
+            textureSettings.bumpStrength = (float)atof(argv[++i]);
+        }
+        else if (argument == "--no-texture-compression")
+        {
+            textureSettings.compress = false;
+        }
+        else if (argument == "--no-terrain")
+        {
+            terrain = false;
+        }
+        else if (argument == "--no-optimize")
+        {
+            loaderSettings.optimizeMesh = false;
+        }
+        else if (argument == "--qtangents")
+        {
+            loaderSettings.qtangents = true;
+        }
+        else
+        {
+            std::cout << "Unknown argument: " << argument << "\n";
+        }
+    }
+    // start decoding the textures, so they overlap SDL, GLEW and mesh setup
+    SWPTAS001::TextureDecoder textureDecoder(textureSettings);
+    textureDecoder.start(SWPTAS001::MODEL_TEXTURE_PATH, SWPTAS001::COLOR_MIPS);
+    textureDecoder.start(SWPTAS001::MODEL_BUMPMAP_PATH, SWPTAS001::NORMAL_MIPS);
 	// check for SDL
     if(SDL_Init(SDL_INIT_VIDEO) != 0)
     {
@@ -32,6 +108,12 @@ int SDL_main(int argc, char** argv)
     }
 	// Create Window
     SWPTAS001::OpenGLWindow window;
+    window.setLoaderSettings(loaderSettings);
+    window.setVertexLayout(vertexLayout);
+    window.setClusterCulling(clusterCulling);
+    window.setLightShape(lightShape);
+    window.setTerrainEnabled(terrain);
+    window.setTextureDecoder(&textureDecoder);
     window.initGL();
 
     //////////////
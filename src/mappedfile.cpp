@@ -0,0 +1,195 @@
+//// Header
+#include "mappedfile.h"
+
+//// OS Specific Imports
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+//// Namespaces
+using namespace std;
+
+namespace SWPTAS001
+{
+	//////////////////
+	// Constructors //
+	//////////////////
+
+	MappedFile::MappedFile()
+	{
+		fData = NULL;
+		fSize = 0;
+		fOpen = false;
+#ifndef __linux__
+		fFileHandle = INVALID_HANDLE_VALUE;
+		fMappingHandle = NULL;
+#endif
+	}
+
+	MappedFile::~MappedFile()
+	{
+		close();
+	}
+
+	///////////////////
+	// Core Routines //
+	///////////////////
+
+#ifdef __linux__
+	bool MappedFile::open(string filename)
+	{
+		// release any previous mapping
+		close();
+		// open file
+		int fileDescriptor = ::open(filename.c_str(), O_RDONLY);
+		if (fileDescriptor < 0)
+		{
+			return false;
+		}
+		// determine file length
+		struct stat fileInfo;
+		if (fstat(fileDescriptor, &fileInfo) != 0)
+		{
+			::close(fileDescriptor);
+			return false;
+		}
+		fSize = (size_t)fileInfo.st_size;
+		// map file (empty files cannot be mapped, but are still valid)
+		if (fSize > 0)
+		{
+			void* mapping = mmap(NULL, fSize, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+			if (mapping == MAP_FAILED)
+			{
+				::close(fileDescriptor);
+				fSize = 0;
+				return false;
+			}
+			// NOTE: All of our consumers scan front to back, so let the kernel read ahead aggressively
+			madvise(mapping, fSize, MADV_SEQUENTIAL);
+			fData = (const char*)mapping;
+		}
+		// the mapping keeps the file alive, so the descriptor is no longer needed
+		::close(fileDescriptor);
+		fOpen = true;
+		return true;
+	}
+
+	void MappedFile::close()
+	{
+		if (fData)
+		{
+			munmap((void*)fData, fSize);
+		}
+		fData = NULL;
+		fSize = 0;
+		fOpen = false;
+	}
+
+	void MappedFile::discard(const char* begin, const char* end)
+	{
+		// only whole pages inside [begin, end) can be dropped
+		size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+		size_t firstPage = (((begin - fData) + pageSize - 1) / pageSize) * pageSize;
+		size_t lastPage = ((end - fData) / pageSize) * pageSize;
+		if (fData && (firstPage < lastPage))
+		{
+			madvise((void*)(fData + firstPage), lastPage - firstPage, MADV_DONTNEED);
+		}
+	}
+#else
+	bool MappedFile::open(string filename)
+	{
+		// release any previous mapping
+		close();
+		// open file
+		fFileHandle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+		if (fFileHandle == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+		// determine file length
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(fFileHandle, &fileSize))
+		{
+			close();
+			return false;
+		}
+		fSize = (size_t)fileSize.QuadPart;
+		// map file (empty files cannot be mapped, but are still valid)
+		if (fSize > 0)
+		{
+			fMappingHandle = CreateFileMappingA(fFileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+			if (fMappingHandle == NULL)
+			{
+				close();
+				return false;
+			}
+			fData = (const char*)MapViewOfFile(fMappingHandle, FILE_MAP_READ, 0, 0, 0);
+			if (fData == NULL)
+			{
+				close();
+				return false;
+			}
+		}
+		fOpen = true;
+		return true;
+	}
+
+	void MappedFile::close()
+	{
+		if (fData)
+		{
+			UnmapViewOfFile(fData);
+		}
+		if (fMappingHandle != NULL)
+		{
+			CloseHandle(fMappingHandle);
+		}
+		if (fFileHandle != INVALID_HANDLE_VALUE)
+		{
+			CloseHandle(fFileHandle);
+		}
+		fData = NULL;
+		fSize = 0;
+		fOpen = false;
+		fFileHandle = INVALID_HANDLE_VALUE;
+		fMappingHandle = NULL;
+	}
+
+	void MappedFile::discard(const char* begin, const char* end)
+	{
+		// NOTE: Unlocking pages that aren't locked is how Windows is told to trim them from the working set
+		if (fData && (begin < end))
+		{
+			VirtualUnlock((LPVOID)begin, end - begin);
+		}
+	}
+#endif
+
+	///////////////
+	// Accessors //
+	///////////////
+
+	bool MappedFile::isOpen()
+	{
+		return fOpen;
+	}
+
+	const char* MappedFile::data()
+	{
+		return fData;
+	}
+
+	const char* MappedFile::end()
+	{
+		return fData + fSize;
+	}
+
+	size_t MappedFile::size()
+	{
+		return fSize;
+	}
+}
@@ -0,0 +1,61 @@
+//// Declaration Guards
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+//// OS Specific Imports
+#ifndef __linux__
+#include <Windows.h>
+#endif
+
+//// Imports
+#include <string>
+#include <stddef.h>
+
+namespace SWPTAS001
+{
+	//// Classes
+	class MappedFile
+	{
+		//// Constructors
+		public:
+			MappedFile();
+			~MappedFile();
+
+		//// Core Routines
+		public:
+			bool open(std::string filename);
+			void close();
+			void discard(const char* begin, const char* end);
+
+		//// Accessors
+		public:
+			bool isOpen();
+			const char* data();
+			const char* end();
+			size_t size();
+
+		//// Mapping State
+		private:
+			const char* fData;
+			size_t fSize;
+			bool fOpen;
+#ifndef __linux__
+			HANDLE fFileHandle;
+			HANDLE fMappingHandle;
+#endif
+
+		//// Copy Guards
+		private:
+			MappedFile(const MappedFile&);
+			MappedFile& operator=(const MappedFile&);
+	};
+}
+
+#endif
+
+// NOTE: The mapping is read-only. Empty files open successfully but report a NULL data pointer and
+//       a size of 0, so callers should always scan with [data(), end()) rather than assume a buffer
+// NOTE: The mapped bytes are NOT null-terminated, any scanner working on them must bound its reads
+//       with end() rather than relying on a terminating '\0'
+// NOTE: discard() tells the OS a range has been consumed, so its pages can leave the resident set.
+//       The mapping stays valid, and reading the range again simply faults it back in from the file
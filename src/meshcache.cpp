@@ -0,0 +1,379 @@
+//// Header
+#include "meshcache.h"
+
+//// Imports
+#include <iostream>
+#include <vector>
+#include <stdio.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+//// Namespaces
+using namespace std;
+
+namespace SWPTAS001
+{
+	//// Constants
+	static const char MESH_CACHE_MAGIC[8] = {'S', 'W', 'P', 'M', 'E', 'S', 'H', '\0'};
+	static const unsigned int MESH_CACHE_VERSION = 13;
+	static const size_t MESH_CACHE_ALIGNMENT = 64;
+
+	/////////////
+	// Helpers //
+	/////////////
+
+	static inline size_t alignOffset(size_t offset)
+	{
+		return (offset + (MESH_CACHE_ALIGNMENT - 1)) & ~(MESH_CACHE_ALIGNMENT - 1);
+	}
+
+	static inline unsigned long long rotateLeft(unsigned long long value, int bits)
+	{
+		return (value << bits) | (value >> (64 - bits));
+	}
+
+	////////////////////
+	// Cache Routines //
+	////////////////////
+
+	string meshCachePath(string sourceFilename)
+	{
+		return sourceFilename + ".meshcache";
+	}
+
+	bool readSourceStamp(string sourceFilename, SourceStamp& stamp)
+	{
+		struct stat fileInfo;
+		if (stat(sourceFilename.c_str(), &fileInfo) != 0)
+		{
+			return false;
+		}
+		stamp.size = (unsigned long long)fileInfo.st_size;
+		stamp.modifiedTime = (long long)fileInfo.st_mtime;
+		stamp.hash = 0;
+		return true;
+	}
+
+	unsigned long long hashBytes(const void* data, size_t size)
+	{
+		// NOTE: A simple 8-bytes-at-a-time multiply/rotate hash, it only needs to notice edits, it
+		//       doesn't need to resist anyone trying to forge a collision
+		const unsigned char* bytes = (const unsigned char*)data;
+		unsigned long long hash = 0xCBF29CE484222325ULL ^ ((unsigned long long)size * 0x9E3779B97F4A7C15ULL);
+		size_t blockCount = size / 8;
+		for (size_t blockIndex = 0; blockIndex < blockCount; blockIndex++)
+		{
+			unsigned long long block;
+			memcpy(&block, bytes + (blockIndex * 8), 8);
+			hash = rotateLeft(hash ^ (block * 0x9E3779B97F4A7C15ULL), 29) * 0xC2B2AE3D27D4EB4FULL;
+		}
+		for (size_t byteIndex = blockCount * 8; byteIndex < size; byteIndex++)
+		{
+			hash = (hash ^ bytes[byteIndex]) * 0x100000001B3ULL;
+		}
+		hash ^= hash >> 33;
+		hash *= 0xFF51AFD7ED558CCDULL;
+		hash ^= hash >> 33;
+		return hash;
+	}
+
+	bool sourceStampMatches(string sourceFilename, const SourceStamp& stamp)
+	{
+		// NOTE: If the source is missing altogether the cache is trusted, which lets a deployment ship
+		//       pre-baked caches without their sources
+		SourceStamp currentStamp;
+		if (!readSourceStamp(sourceFilename, currentStamp))
+		{
+			return true;
+		}
+		if (currentStamp.size != stamp.size)
+		{
+			return false;
+		}
+		if (currentStamp.modifiedTime != stamp.modifiedTime)
+		{
+			MappedFile sourceFile;
+			return sourceFile.open(sourceFilename) && (hashBytes(sourceFile.data(), sourceFile.size()) == stamp.hash);
+		}
+		return true;
+	}
+
+	bool openMeshCache(string sourceFilename, MappedFile& cacheFile, MeshCacheHeader& header, MeshStreams& streams)
+	{
+		// map cache
+		if (!cacheFile.open(meshCachePath(sourceFilename)))
+		{
+			return false;
+		}
+		if (cacheFile.size() < sizeof(MeshCacheHeader))
+		{
+			cacheFile.close();
+			return false;
+		}
+		memcpy(&header, cacheFile.data(), sizeof(MeshCacheHeader));
+		if ((memcmp(header.magic, MESH_CACHE_MAGIC, sizeof(MESH_CACHE_MAGIC)) != 0) || (header.version != MESH_CACHE_VERSION))
+		{
+			cacheFile.close();
+			return false;
+		}
+
+		// check the cache against its source
+		if (!sourceStampMatches(sourceFilename, header.source))
+		{
+			cacheFile.close();
+			return false;
+		}
+
+		// resolve streams
+		size_t tableEnd = sizeof(MeshCacheHeader) + (header.streamCount * sizeof(MeshCacheStream));
+		if (cacheFile.size() < tableEnd)
+		{
+			cacheFile.close();
+			return false;
+		}
+		memset(&streams, 0, sizeof(MeshStreams));
+		for (unsigned int streamIndex = 0; streamIndex < header.streamCount; streamIndex++)
+		{
+			MeshCacheStream stream;
+			memcpy(&stream, cacheFile.data() + sizeof(MeshCacheHeader) + (streamIndex * sizeof(MeshCacheStream)), sizeof(MeshCacheStream));
+			if ((stream.offset > cacheFile.size()) || (stream.size > (cacheFile.size() - stream.offset)))
+			{
+				cacheFile.close();
+				return false;
+			}
+			// NOTE: Unknown stream types are skipped, so older readers can still use newer caches
+			if ((stream.type < MESH_STREAM_COUNT) && (stream.size > 0))
+			{
+				streams.data[stream.type] = cacheFile.data() + stream.offset;
+				streams.size[stream.type] = (size_t)stream.size;
+			}
+		}
+		return true;
+	}
+
+	static void buildStreamTable(const size_t sizes[MESH_STREAM_COUNT], vector<MeshCacheStream>& streamTable)
+	{
+		streamTable.resize(MESH_STREAM_COUNT);
+		size_t offset = alignOffset(sizeof(MeshCacheHeader) + (MESH_STREAM_COUNT * sizeof(MeshCacheStream)));
+		for (int streamIndex = 0; streamIndex < MESH_STREAM_COUNT; streamIndex++)
+		{
+			streamTable[streamIndex].type = streamIndex;
+			streamTable[streamIndex].reserved = 0;
+			streamTable[streamIndex].offset = offset;
+			streamTable[streamIndex].size = sizes[streamIndex];
+			offset = alignOffset(offset + sizes[streamIndex]);
+		}
+	}
+
+	static FILE* beginCacheFile(string cachePath, MeshCacheHeader header, const SourceStamp& stamp, const vector<MeshCacheStream>& streamTable)
+	{
+		// NOTE: Caches are written to a temporary file first, so a half written cache is never picked up
+		FILE* cacheFile = fopen((cachePath + ".tmp").c_str(), "wb");
+		if (!cacheFile)
+		{
+			return NULL;
+		}
+		memcpy(header.magic, MESH_CACHE_MAGIC, sizeof(MESH_CACHE_MAGIC));
+		header.version = MESH_CACHE_VERSION;
+		header.streamCount = MESH_STREAM_COUNT;
+		header.source = stamp;
+		bool written = (fwrite(&header, sizeof(header), 1, cacheFile) == 1);
+		written = written && (fwrite(&streamTable[0], sizeof(MeshCacheStream), MESH_STREAM_COUNT, cacheFile) == MESH_STREAM_COUNT);
+		if (!written)
+		{
+			fclose(cacheFile);
+			remove((cachePath + ".tmp").c_str());
+			return NULL;
+		}
+		return cacheFile;
+	}
+
+	static bool padCacheFile(FILE* cacheFile, const MeshCacheStream& stream)
+	{
+		static const char padding[MESH_CACHE_ALIGNMENT] = {};
+		long position = ftell(cacheFile);
+		if ((position < 0) || ((unsigned long long)position > stream.offset))
+		{
+			return false;
+		}
+		size_t paddingSize = (size_t)(stream.offset - position);
+		return fwrite(padding, 1, paddingSize, cacheFile) == paddingSize;
+	}
+
+	static bool commitCacheFile(string cachePath, FILE* cacheFile, bool written)
+	{
+		written = (fclose(cacheFile) == 0) && written;
+		string temporaryPath = cachePath + ".tmp";
+		remove(cachePath.c_str());
+		if (!written || (rename(temporaryPath.c_str(), cachePath.c_str()) != 0))
+		{
+			remove(temporaryPath.c_str());
+			cout << "    - Unable to write mesh cache: " << cachePath << endl;
+			return false;
+		}
+		return true;
+	}
+
+	bool writeMeshCache(string sourceFilename, const SourceStamp& stamp, const MeshCacheHeader& header, const MeshStreams& streams)
+	{
+		// build stream table
+		vector<MeshCacheStream> streamTable;
+		buildStreamTable(streams.size, streamTable);
+
+		// write
+		string cachePath = meshCachePath(sourceFilename);
+		FILE* cacheFile = beginCacheFile(cachePath, header, stamp, streamTable);
+		if (!cacheFile)
+		{
+			cout << "    - Unable to write mesh cache: " << cachePath << endl;
+			return false;
+		}
+		bool written = true;
+		for (int streamIndex = 0; written && (streamIndex < MESH_STREAM_COUNT); streamIndex++)
+		{
+			written = padCacheFile(cacheFile, streamTable[streamIndex]);
+			if (streams.size[streamIndex] > 0)
+			{
+				written = written && (fwrite(streams.data[streamIndex], 1, streams.size[streamIndex], cacheFile) == streams.size[streamIndex]);
+			}
+		}
+		return commitCacheFile(cachePath, cacheFile, written);
+	}
+
+	/////////////////////
+	// Writer Routines //
+	/////////////////////
+
+	MeshCacheWriter::MeshCacheWriter()
+	{
+		for (int streamIndex = 0; streamIndex < MESH_STREAM_COUNT; streamIndex++)
+		{
+			fSpools[streamIndex] = NULL;
+			fSizes[streamIndex] = 0;
+		}
+		fFailed = false;
+	}
+
+	MeshCacheWriter::~MeshCacheWriter()
+	{
+		abort();
+	}
+
+	bool MeshCacheWriter::begin(string sourceFilename)
+	{
+		abort();
+		fSourceFilename = sourceFilename;
+		fFailed = false;
+		for (int streamIndex = 0; streamIndex < MESH_STREAM_COUNT; streamIndex++)
+		{
+			// NOTE: tmpfile() spools are anonymous and removed automatically, even if we crash
+			fSpools[streamIndex] = tmpfile();
+			if (!fSpools[streamIndex])
+			{
+				cout << "    - Unable to create a mesh cache spool file" << endl;
+				abort();
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool MeshCacheWriter::append(MeshStream stream, const void* data, size_t size)
+	{
+		if (fFailed || !fSpools[stream])
+		{
+			return false;
+		}
+		if ((size > 0) && (fwrite(data, 1, size, fSpools[stream]) != size))
+		{
+			fFailed = true;
+			return false;
+		}
+		fSizes[stream] += size;
+		return true;
+	}
+
+	bool MeshCacheWriter::finish(const SourceStamp& stamp, const MeshCacheHeader& header)
+	{
+		if (fFailed || !fSpools[POSITION_STREAM])
+		{
+			abort();
+			return false;
+		}
+
+		// build stream table
+		size_t sizes[MESH_STREAM_COUNT];
+		memcpy(sizes, fSizes, sizeof(sizes));
+		bool narrowIndices = (header.indexSize == sizeof(unsigned short));
+		if (narrowIndices)
+		{
+			sizes[INDEX_STREAM] = (fSizes[INDEX_STREAM] / sizeof(unsigned int)) * sizeof(unsigned short);
+		}
+		vector<MeshCacheStream> streamTable;
+		buildStreamTable(sizes, streamTable);
+
+		// copy the spools across
+		string cachePath = meshCachePath(fSourceFilename);
+		FILE* cacheFile = beginCacheFile(cachePath, header, stamp, streamTable);
+		if (!cacheFile)
+		{
+			cout << "    - Unable to write mesh cache: " << cachePath << endl;
+			abort();
+			return false;
+		}
+		const size_t copyBlockSize = 1 << 20;
+		vector<char> copyBlock(copyBlockSize);
+		bool written = true;
+		for (int streamIndex = 0; written && (streamIndex < MESH_STREAM_COUNT); streamIndex++)
+		{
+			written = padCacheFile(cacheFile, streamTable[streamIndex]) && (fseek(fSpools[streamIndex], 0, SEEK_SET) == 0);
+			size_t remaining = fSizes[streamIndex];
+			while (written && (remaining > 0))
+			{
+				size_t blockSize = (remaining < copyBlockSize) ? remaining : copyBlockSize;
+				written = (fread(&copyBlock[0], 1, blockSize, fSpools[streamIndex]) == blockSize);
+				size_t outputSize = blockSize;
+				if (narrowIndices && (streamIndex == INDEX_STREAM))
+				{
+					// NOTE: Narrowing in place is safe, each 16-bit write lands at or before the 32-bit read
+					unsigned int wideIndex;
+					unsigned short narrowIndex;
+					for (size_t i = 0; i < (blockSize / sizeof(unsigned int)); i++)
+					{
+						memcpy(&wideIndex, &copyBlock[i * sizeof(unsigned int)], sizeof(unsigned int));
+						narrowIndex = (unsigned short)wideIndex;
+						memcpy(&copyBlock[i * sizeof(unsigned short)], &narrowIndex, sizeof(unsigned short));
+					}
+					outputSize = (blockSize / sizeof(unsigned int)) * sizeof(unsigned short);
+				}
+				written = written && (fwrite(&copyBlock[0], 1, outputSize, cacheFile) == outputSize);
+				remaining -= blockSize;
+			}
+		}
+		abort();
+		return commitCacheFile(cachePath, cacheFile, written);
+	}
+
+	void MeshCacheWriter::abort()
+	{
+		for (int streamIndex = 0; streamIndex < MESH_STREAM_COUNT; streamIndex++)
+		{
+			if (fSpools[streamIndex])
+			{
+				fclose(fSpools[streamIndex]);
+				fSpools[streamIndex] = NULL;
+			}
+			fSizes[streamIndex] = 0;
+		}
+	}
+
+	//////////////////////
+	// Writer Accessors //
+	//////////////////////
+
+	size_t MeshCacheWriter::streamSize(MeshStream stream)
+	{
+		return fSizes[stream];
+	}
+}
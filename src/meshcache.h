@@ -0,0 +1,123 @@
+//// Declaration Guards
+#ifndef MESH_CACHE_H
+#define MESH_CACHE_H
+
+//// Imports
+#include <string>
+#include <stddef.h>
+#include <stdio.h>
+#include "mappedfile.h"
+#include "bounds.h"
+
+namespace SWPTAS001
+{
+	//// Enumerations
+	enum MeshStream { POSITION_STREAM, NORMAL_STREAM, TEXCOORD_STREAM, TANGENT_STREAM, BITANGENT_STREAM, INDEX_STREAM, LOD_STREAM, MESHLET_STREAM, QTANGENT_STREAM, MESH_STREAM_COUNT };
+
+	//// Structures
+	struct SourceStamp
+	{
+		unsigned long long size;
+		long long modifiedTime;
+		unsigned long long hash;
+	};
+
+	struct MeshCacheHeader
+	{
+		char magic[8];
+		unsigned int version;
+		unsigned int streamCount;
+		SourceStamp source;
+		unsigned int vertexCount;
+		unsigned int indexCount;
+		unsigned int indexSize;
+		unsigned int reserved;
+		unsigned long long displacement; // key of the displacement map and scale applied, 0 for none
+		unsigned long long settings; // key of the loader settings that shaped the mesh
+		MeshBounds bounds;
+	};
+
+	struct MeshCacheStream
+	{
+		unsigned int type;
+		unsigned int reserved;
+		unsigned long long offset;
+		unsigned long long size;
+	};
+
+	struct MeshLOD
+	{
+		unsigned int indexOffset;
+		unsigned int indexCount;
+		float error;
+		unsigned int reserved;
+	};
+
+	struct MeshStreams
+	{
+		const void* data[MESH_STREAM_COUNT];
+		size_t size[MESH_STREAM_COUNT];
+	};
+
+	//// Classes
+	class MeshCacheWriter
+	{
+		//// Constructors
+		public:
+			MeshCacheWriter();
+			~MeshCacheWriter();
+
+		//// Core Routines
+		public:
+			bool begin(std::string sourceFilename);
+			bool append(MeshStream stream, const void* data, size_t size);
+			bool finish(const SourceStamp& stamp, const MeshCacheHeader& header);
+			void abort();
+
+		//// Accessors
+		public:
+			size_t streamSize(MeshStream stream);
+
+		//// Writer State
+		private:
+			std::string fSourceFilename;
+			FILE* fSpools[MESH_STREAM_COUNT];
+			size_t fSizes[MESH_STREAM_COUNT];
+			bool fFailed;
+
+		//// Copy Guards
+		private:
+			MeshCacheWriter(const MeshCacheWriter&);
+			MeshCacheWriter& operator=(const MeshCacheWriter&);
+	};
+
+	//// Cache Routines
+	std::string meshCachePath(std::string sourceFilename);
+	bool readSourceStamp(std::string sourceFilename, SourceStamp& stamp);
+	unsigned long long hashBytes(const void* data, size_t size);
+	bool sourceStampMatches(std::string sourceFilename, const SourceStamp& stamp);
+	bool openMeshCache(std::string sourceFilename, MappedFile& cacheFile, MeshCacheHeader& header, MeshStreams& streams);
+	bool writeMeshCache(std::string sourceFilename, const SourceStamp& stamp, const MeshCacheHeader& header, const MeshStreams& streams);
+}
+
+#endif
+
+// NOTE: A mesh cache lives next to its source (planet.obj -> planet.obj.meshcache) and holds a header,
+//       a table of MeshCacheStream entries and then every stream payload, each 64-byte aligned and
+//       laid out exactly as it gets uploaded, so the mapped pointers can go straight to glBufferData
+// NOTE: A cache is only used while it matches its source. The size must match, and if the modification
+//       time differs as well the source is hashed, so touching a file doesn't force a rebuild but
+//       editing it does. The loader also rejects a cache whose displacement or settings key differs.
+//       The format is written in native byte order, it is a cache, not an interchange format, and the
+//       version number is bumped whenever the layout or the mesh processing changes
+// NOTE: MeshCacheWriter builds a cache incrementally for meshes that don't fit in memory at once. Each
+//       stream is appended to its own anonymous spool file, and finish() copies the spools into the
+//       cache through a small fixed buffer. The index stream is always appended as 32-bit indices, and
+//       is narrowed while copying if header.indexSize asks for 16-bit ones
+// NOTE: The LOD stream is a table of MeshLOD ranges into the index stream, which holds every level of
+//       detail back to back. A cache without one holds a single level, the whole index stream. The
+//       meshlet stream is a table of Meshlet ranges (see meshlets.h) covering the first level
+// NOTE: Meshes loaded with LoaderSettings::qtangents store their tangent frames in the QTangent stream
+//       (4 shorts per vertex, see packQTangent()) instead of the normal, tangent and bitangent streams
+// NOTE: A displaced mesh (see LoaderSettings::displacementMap) keeps a key of the map's bytes and the
+//       scale in its header, and its cache is only used while the loader asks for that same displacement
@@ -0,0 +1,399 @@
+//// Header
+#include "meshlets.h"
+
+//// Imports
+#include <algorithm>
+#include <limits>
+#include <math.h>
+
+//// Namespaces
+using namespace std;
+
+namespace SWPTAS001
+{
+	//// Constants
+	static const unsigned int NOT_IN_MESHLET = 0xFFFFFFFF;
+	static const unsigned int NO_TRIANGLE = 0xFFFFFFFF;
+	static const unsigned int KD_LEAF = 3;
+	static const size_t KD_LEAF_SIZE = 8;
+
+	//// Structures
+	struct KDItem
+	{
+		float centroid[3];
+		unsigned int triangle;
+	};
+
+	struct KDNode
+	{
+		float split;
+		unsigned int axis; // KD_LEAF for leaves
+		unsigned int first; // leaves: first item, inner nodes: the right child (the left one follows the node)
+		unsigned int count; // leaves: items not yet emitted
+	};
+
+	/////////////
+	// Helpers //
+	/////////////
+
+	// Fits a sphere around the points with Ritter's algorithm, which is within a few percent of optimal
+	static void boundingSphere(const float* positions, const vector<unsigned int>& points, float* center, float& radius)
+	{
+		// start from the pair of points farthest apart along x, y or z
+		int bestAxis = 0;
+		unsigned int extremes[3][2];
+		for (int axis = 0; axis < 3; axis++)
+		{
+			extremes[axis][0] = extremes[axis][1] = points[0];
+			for (size_t p = 1; p < points.size(); p++)
+			{
+				const float* position = positions + (3 * points[p]);
+				extremes[axis][0] = (position[axis] < positions[(3 * extremes[axis][0]) + axis]) ? points[p] : extremes[axis][0];
+				extremes[axis][1] = (position[axis] > positions[(3 * extremes[axis][1]) + axis]) ? points[p] : extremes[axis][1];
+			}
+		}
+		float bestSpan = -1.0f;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			const float* low = positions + (3 * extremes[axis][0]);
+			const float* high = positions + (3 * extremes[axis][1]);
+			float span = ((high[0] - low[0]) * (high[0] - low[0])) + ((high[1] - low[1]) * (high[1] - low[1])) +
+				((high[2] - low[2]) * (high[2] - low[2]));
+			if (span > bestSpan)
+			{
+				bestSpan = span;
+				bestAxis = axis;
+			}
+		}
+		const float* low = positions + (3 * extremes[bestAxis][0]);
+		const float* high = positions + (3 * extremes[bestAxis][1]);
+		for (int axis = 0; axis < 3; axis++)
+		{
+			center[axis] = (low[axis] + high[axis]) * 0.5f;
+		}
+		radius = sqrtf(bestSpan) * 0.5f;
+
+		// grow it to take in every point outside of it
+		for (size_t p = 0; p < points.size(); p++)
+		{
+			const float* position = positions + (3 * points[p]);
+			float offset[3] = {position[0] - center[0], position[1] - center[1], position[2] - center[2]};
+			float distance = sqrtf((offset[0] * offset[0]) + (offset[1] * offset[1]) + (offset[2] * offset[2]));
+			if (distance > radius)
+			{
+				float newRadius = (radius + distance) * 0.5f;
+				float shift = (newRadius - radius) / distance;
+				for (int axis = 0; axis < 3; axis++)
+				{
+					center[axis] += offset[axis] * shift;
+				}
+				radius = newRadius;
+			}
+		}
+	}
+
+	// Splits the items at their mean centroid along the longest axis of their bounds, down to small leaves
+	static void buildKDTree(KDItem* items, unsigned int first, unsigned int count, vector<KDNode>& nodes)
+	{
+		KDNode node = {0.0f, KD_LEAF, first, count};
+		if (count > KD_LEAF_SIZE)
+		{
+			float low[3] = {items[first].centroid[0], items[first].centroid[1], items[first].centroid[2]};
+			float high[3] = {low[0], low[1], low[2]};
+			double sum[3] = {0.0, 0.0, 0.0};
+			for (unsigned int i = first; i < (first + count); i++)
+			{
+				for (int axis = 0; axis < 3; axis++)
+				{
+					low[axis] = min(low[axis], items[i].centroid[axis]);
+					high[axis] = max(high[axis], items[i].centroid[axis]);
+					sum[axis] += items[i].centroid[axis];
+				}
+			}
+			float extent[3] = {high[0] - low[0], high[1] - low[1], high[2] - low[2]};
+			int axis = (extent[0] >= extent[1]) ? ((extent[0] >= extent[2]) ? 0 : 2) : ((extent[1] >= extent[2]) ? 1 : 2);
+			float split = (float)(sum[axis] / count);
+			KDItem* middle = partition(items + first, items + first + count, [&](const KDItem& item) { return item.centroid[axis] < split; });
+			unsigned int leftCount = (unsigned int)(middle - (items + first));
+			// NOTE: Coincident centroids can't be split, they stay together in one (larger) leaf
+			if ((leftCount > 0) && (leftCount < count))
+			{
+				size_t nodeIndex = nodes.size();
+				node.split = split;
+				node.axis = (unsigned int)axis;
+				nodes.push_back(node);
+				buildKDTree(items, first, leftCount, nodes);
+				nodes[nodeIndex].first = (unsigned int)nodes.size();
+				buildKDTree(items, first + leftCount, count - leftCount, nodes);
+				return;
+			}
+		}
+		nodes.push_back(node);
+	}
+
+	// Finds the triangle whose centroid is nearest to the point, dropping emitted triangles from the leaves it visits
+	static void findNearestTriangle(vector<KDNode>& nodes, size_t nodeIndex, KDItem* items, const vector<bool>& emitted,
+		const float* point, unsigned int& nearest, float& nearestDistance)
+	{
+		KDNode& node = nodes[nodeIndex];
+		if (node.axis == KD_LEAF)
+		{
+			for (unsigned int i = node.first; i < (node.first + node.count); i++)
+			{
+				if (emitted[items[i].triangle])
+				{
+					items[i--] = items[node.first + (--node.count)];
+					continue;
+				}
+				const float* centroid = items[i].centroid;
+				float distance = ((centroid[0] - point[0]) * (centroid[0] - point[0])) + ((centroid[1] - point[1]) * (centroid[1] - point[1])) +
+					((centroid[2] - point[2]) * (centroid[2] - point[2]));
+				if (distance < nearestDistance)
+				{
+					nearestDistance = distance;
+					nearest = items[i].triangle;
+				}
+			}
+			return;
+		}
+		float offset = point[node.axis] - node.split;
+		size_t nearChild = (offset < 0.0f) ? (nodeIndex + 1) : node.first;
+		size_t farChild = (offset < 0.0f) ? node.first : (nodeIndex + 1);
+		findNearestTriangle(nodes, nearChild, items, emitted, point, nearest, nearestDistance);
+		if ((offset * offset) < nearestDistance)
+		{
+			findNearestTriangle(nodes, farChild, items, emitted, point, nearest, nearestDistance);
+		}
+		// NOTE: Once both children are found empty the node becomes an empty leaf, so later searches
+		//       don't keep walking the parts of the mesh that are already in meshlets
+		if ((nodes[nearChild].axis == KD_LEAF) && (nodes[nearChild].count == 0) && (nodes[farChild].axis == KD_LEAF) &&
+			(nodes[farChild].count == 0))
+		{
+			nodes[nodeIndex].axis = KD_LEAF;
+			nodes[nodeIndex].count = 0;
+		}
+	}
+
+	// Fills in the bounding sphere and normal cone of a finished meshlet
+	static void computeMeshletBounds(const unsigned int* indices, const float* positions, const vector<unsigned int>& points,
+		Meshlet& meshlet)
+	{
+		boundingSphere(positions, points, meshlet.center, meshlet.radius);
+
+		// average the unit triangle normals into the cone axis
+		vector<float> normals(3 * meshlet.triangleCount, 0.0f);
+		float axis[3] = {0.0f, 0.0f, 0.0f};
+		for (unsigned int triangle = 0; triangle < meshlet.triangleCount; triangle++)
+		{
+			const unsigned int* corners = indices + meshlet.indexOffset + (3 * triangle);
+			const float* position0 = positions + (3 * corners[0]);
+			const float* position1 = positions + (3 * corners[1]);
+			const float* position2 = positions + (3 * corners[2]);
+			float edge1[3] = {position1[0] - position0[0], position1[1] - position0[1], position1[2] - position0[2]};
+			float edge2[3] = {position2[0] - position0[0], position2[1] - position0[1], position2[2] - position0[2]};
+			float* normal = &normals[3 * triangle];
+			normal[0] = (edge1[1] * edge2[2]) - (edge1[2] * edge2[1]);
+			normal[1] = (edge1[2] * edge2[0]) - (edge1[0] * edge2[2]);
+			normal[2] = (edge1[0] * edge2[1]) - (edge1[1] * edge2[0]);
+			float length = sqrtf((normal[0] * normal[0]) + (normal[1] * normal[1]) + (normal[2] * normal[2]));
+			for (int component = 0; component < 3; component++)
+			{
+				normal[component] = (length > 0.0f) ? (normal[component] / length) : 0.0f;
+				axis[component] += normal[component];
+			}
+		}
+		float axisLength = sqrtf((axis[0] * axis[0]) + (axis[1] * axis[1]) + (axis[2] * axis[2]));
+		for (int component = 0; component < 3; component++)
+		{
+			meshlet.coneAxis[component] = (axisLength > 0.0f) ? (axis[component] / axisLength) : 0.0f;
+		}
+
+		// NOTE: The cone has to hold every normal, so it is as wide as the normal furthest from the axis.
+		//       Cones of 90 degrees or more (or with degenerate triangles) can never reject the meshlet
+		float minimumDot = 1.0f;
+		for (unsigned int triangle = 0; triangle < meshlet.triangleCount; triangle++)
+		{
+			const float* normal = &normals[3 * triangle];
+			float dot = (normal[0] * meshlet.coneAxis[0]) + (normal[1] * meshlet.coneAxis[1]) + (normal[2] * meshlet.coneAxis[2]);
+			minimumDot = min(minimumDot, dot);
+		}
+		meshlet.coneCutoff = (minimumDot > 0.0f) ? sqrtf(1.0f - (minimumDot * minimumDot)) : 1.0f;
+	}
+
+	//////////////////////
+	// Meshlet Routines //
+	//////////////////////
+
+	void buildMeshlets(unsigned int* indices, size_t indexCount, const float* positions, size_t vertexCount,
+		vector<Meshlet>& meshlets)
+	{
+		// build the vertex -> triangle adjacency
+		size_t triangleCount = indexCount / 3;
+		vector<unsigned int> adjacencyOffsets(vertexCount + 1, 0);
+		for (size_t i = 0; i < indexCount; i++)
+		{
+			adjacencyOffsets[indices[i] + 1]++;
+		}
+		for (size_t vertex = 0; vertex < vertexCount; vertex++)
+		{
+			adjacencyOffsets[vertex + 1] += adjacencyOffsets[vertex];
+		}
+		vector<unsigned int> adjacentTriangles(indexCount);
+		vector<unsigned int> cursors(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+		for (size_t i = 0; i < indexCount; i++)
+		{
+			adjacentTriangles[cursors[indices[i]]++] = (unsigned int)(i / 3);
+		}
+
+		// grow meshlets
+		meshlets.clear();
+		vector<unsigned int> output;
+		output.reserve(indexCount);
+		vector<bool> emitted(triangleCount, false);
+		vector<unsigned int> vertexMeshlet(vertexCount, NOT_IN_MESHLET);
+		vector<unsigned int> points;
+		vector<unsigned int> candidates;
+		vector<KDItem> treeItems;
+		vector<KDNode> tree;
+		size_t seedCursor = 0;
+		while (true)
+		{
+			// seed a new meshlet with the first triangle not used yet
+			while ((seedCursor < triangleCount) && emitted[seedCursor])
+			{
+				seedCursor++;
+			}
+			if (seedCursor == triangleCount)
+			{
+				break;
+			}
+			Meshlet meshlet = {};
+			meshlet.indexOffset = (unsigned int)output.size();
+			unsigned int meshletIndex = (unsigned int)meshlets.size();
+			points.clear();
+			candidates.clear();
+			float centroidSum[3] = {0.0f, 0.0f, 0.0f};
+			long long nextTriangle = (long long)seedCursor;
+
+			while (nextTriangle >= 0)
+			{
+				// add the triangle, queueing up its neighbours
+				const unsigned int* corners = indices + (3 * nextTriangle);
+				for (int corner = 0; corner < 3; corner++)
+				{
+					unsigned int vertex = corners[corner];
+					output.push_back(vertex);
+					for (int axis = 0; axis < 3; axis++)
+					{
+						centroidSum[axis] += positions[(3 * vertex) + axis] / 3.0f;
+					}
+					if (vertexMeshlet[vertex] != meshletIndex)
+					{
+						vertexMeshlet[vertex] = meshletIndex;
+						points.push_back(vertex);
+						for (unsigned int a = adjacencyOffsets[vertex]; a < adjacencyOffsets[vertex + 1]; a++)
+						{
+							if (!emitted[adjacentTriangles[a]])
+							{
+								candidates.push_back(adjacentTriangles[a]);
+							}
+						}
+					}
+				}
+				emitted[nextTriangle] = true;
+				meshlet.triangleCount++;
+				if (meshlet.triangleCount == MESHLET_MAX_TRIANGLES)
+				{
+					break;
+				}
+
+				// NOTE: The next triangle is the queued one adding the fewest new vertices that still fits,
+				//       earliest queued first, so the meshlet grows outward like a fan
+				nextTriangle = -1;
+				int bestNewVertices = 4;
+				size_t keptCandidates = 0;
+				for (size_t c = 0; c < candidates.size(); c++)
+				{
+					unsigned int triangle = candidates[c];
+					if (emitted[triangle])
+					{
+						continue;
+					}
+					candidates[keptCandidates++] = triangle;
+					const unsigned int* candidateCorners = indices + (3 * triangle);
+					int newVertices = (vertexMeshlet[candidateCorners[0]] != meshletIndex) + (vertexMeshlet[candidateCorners[1]] != meshletIndex) +
+						(vertexMeshlet[candidateCorners[2]] != meshletIndex);
+					if ((newVertices < bestNewVertices) && ((points.size() + newVertices) <= MESHLET_MAX_VERTICES))
+					{
+						bestNewVertices = newVertices;
+						nextTriangle = triangle;
+					}
+				}
+				candidates.resize(keptCandidates);
+
+				// NOTE: With no neighbour left to grow into (a small disconnected part is used up, or the
+				//       mesh is faceted and shares no vertices), the meshlet is filled up with the triangle
+				//       nearest its centroid, as in meshoptimizer, so it only ends when a limit is reached.
+				//       The kd-tree over the triangle centroids is only built once that is first needed
+				if (candidates.empty() && ((points.size() + 3) <= MESHLET_MAX_VERTICES))
+				{
+					if (tree.empty())
+					{
+						for (size_t triangle = 0; triangle < triangleCount; triangle++)
+						{
+							if (emitted[triangle])
+							{
+								continue;
+							}
+							const unsigned int* triangleCorners = indices + (3 * triangle);
+							KDItem item;
+							for (int axis = 0; axis < 3; axis++)
+							{
+								item.centroid[axis] = (positions[(3 * triangleCorners[0]) + axis] + positions[(3 * triangleCorners[1]) + axis] +
+									positions[(3 * triangleCorners[2]) + axis]) / 3.0f;
+							}
+							item.triangle = (unsigned int)triangle;
+							treeItems.push_back(item);
+						}
+						buildKDTree(treeItems.data(), 0, (unsigned int)treeItems.size(), tree);
+					}
+					float meshletCentroid[3];
+					for (int axis = 0; axis < 3; axis++)
+					{
+						meshletCentroid[axis] = centroidSum[axis] / meshlet.triangleCount;
+					}
+					unsigned int nearest = NO_TRIANGLE;
+					float nearestDistance = numeric_limits<float>::max();
+					findNearestTriangle(tree, 0, treeItems.data(), emitted, meshletCentroid, nearest, nearestDistance);
+					nextTriangle = (nearest != NO_TRIANGLE) ? (long long)nearest : -1;
+				}
+			}
+
+			meshlet.vertexCount = (unsigned int)points.size();
+			meshlets.push_back(meshlet);
+		}
+
+		// store the regrouped triangles, then bound every meshlet
+		copy(output.begin(), output.end(), indices);
+		for (size_t m = 0; m < meshlets.size(); m++)
+		{
+			const unsigned int* corners = indices + meshlets[m].indexOffset;
+			points.clear();
+			for (unsigned int i = 0; i < (3 * meshlets[m].triangleCount); i++)
+			{
+				points.push_back(corners[i]);
+			}
+			sort(points.begin(), points.end());
+			points.erase(unique(points.begin(), points.end()), points.end());
+			computeMeshletBounds(indices, positions, points, meshlets[m]);
+		}
+	}
+
+	bool meshletFacesAway(const Meshlet& meshlet, const float* cameraPosition)
+	{
+		float offset[3] = {meshlet.center[0] - cameraPosition[0], meshlet.center[1] - cameraPosition[1], meshlet.center[2] - cameraPosition[2]};
+		float distance = sqrtf((offset[0] * offset[0]) + (offset[1] * offset[1]) + (offset[2] * offset[2]));
+		float facing = (offset[0] * meshlet.coneAxis[0]) + (offset[1] * meshlet.coneAxis[1]) + (offset[2] * meshlet.coneAxis[2]);
+		return facing >= ((meshlet.coneCutoff * distance) + meshlet.radius);
+	}
+}
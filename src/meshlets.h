@@ -0,0 +1,43 @@
+//// Declaration Guards
+#ifndef MESHLETS_H
+#define MESHLETS_H
+
+//// Imports
+#include <stddef.h>
+#include <vector>
+
+namespace SWPTAS001
+{
+	//// Constants
+	static const size_t MESHLET_MAX_VERTICES = 64;
+	static const size_t MESHLET_MAX_TRIANGLES = 124;
+
+	//// Structures
+	struct Meshlet
+	{
+		unsigned int indexOffset; // first index of the meshlet in the index buffer
+		unsigned int triangleCount;
+		unsigned int vertexCount; // distinct vertices referenced
+		unsigned int reserved;
+		float center[3]; // bounding sphere
+		float radius;
+		float coneAxis[3]; // average facing of the triangles
+		float coneCutoff; // sine of the cone's half angle, 1 when the cone can't reject anything
+	};
+
+	//// Meshlet Routines
+	void buildMeshlets(unsigned int* indices, size_t indexCount, const float* positions, size_t vertexCount,
+		std::vector<Meshlet>& meshlets);
+	bool meshletFacesAway(const Meshlet& meshlet, const float* cameraPosition);
+}
+
+#endif
+
+// NOTE: buildMeshlets() regroups the triangles of an index buffer (in place) into meshlets of at most
+//       MESHLET_MAX_VERTICES vertices and MESHLET_MAX_TRIANGLES triangles, each a contiguous range of the
+//       buffer. Meshlets are grown greedily from the input order, always taking the neighbouring triangle
+//       that adds the fewest new vertices, so cache optimized input stays cache friendly. A meshlet with no
+//       neighbours left takes the triangle nearest its centroid instead, so it only ends at a limit
+// NOTE: The cone test (as in Wihlidal, "Optimizing the Graphics Pipeline with Compute") is conservative:
+//       meshletFacesAway() only returns true when every triangle of the meshlet is back facing from
+//       cameraPosition (given in the mesh's own space), assuming counter-clockwise front faces
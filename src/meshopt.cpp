@@ -0,0 +1,317 @@
+//// Header
+#include "meshopt.h"
+
+//// Imports
+#include <algorithm>
+#include <math.h>
+
+//// Namespaces
+using namespace std;
+
+namespace SWPTAS001
+{
+	//// Constants
+	static const unsigned int UNUSED_VERTEX = 0xFFFFFFFF;
+
+	/////////////
+	// Helpers //
+	/////////////
+
+	// Counts, for every triangle, how many of its vertices miss a FIFO cache of cacheSize entries
+	static void simulateVertexCache(const unsigned int* indices, size_t indexCount, size_t vertexCount, int cacheSize,
+		vector<unsigned char>& triangleMisses)
+	{
+		// NOTE: A vertex is cached while fewer than cacheSize misses happened since it was last loaded
+		vector<size_t> loadedAt(vertexCount, 0);
+		size_t missCount = 0;
+		triangleMisses.assign(indexCount / 3, 0);
+		for (size_t i = 0; i < indexCount; i++)
+		{
+			unsigned int vertex = indices[i];
+			if ((loadedAt[vertex] == 0) || ((missCount - loadedAt[vertex]) >= (size_t)cacheSize))
+			{
+				missCount++;
+				loadedAt[vertex] = missCount;
+				triangleMisses[i / 3]++;
+			}
+		}
+	}
+
+	// Builds the vertex -> triangle adjacency as a compressed list (offsets into triangleList)
+	static void buildTriangleAdjacency(const unsigned int* indices, size_t indexCount, size_t vertexCount,
+		vector<unsigned int>& offsets, vector<unsigned int>& triangleList)
+	{
+		offsets.assign(vertexCount + 1, 0);
+		for (size_t i = 0; i < indexCount; i++)
+		{
+			offsets[indices[i] + 1]++;
+		}
+		for (size_t vertex = 0; vertex < vertexCount; vertex++)
+		{
+			offsets[vertex + 1] += offsets[vertex];
+		}
+		vector<unsigned int> cursors(offsets.begin(), offsets.end() - 1);
+		triangleList.resize(indexCount);
+		for (size_t i = 0; i < indexCount; i++)
+		{
+			triangleList[cursors[indices[i]]++] = (unsigned int)(i / 3);
+		}
+	}
+
+	////////////////////////////////
+	// Mesh Optimization Routines //
+	////////////////////////////////
+
+	VertexCacheStats analyzeVertexCache(const unsigned int* indices, size_t indexCount, size_t vertexCount, int cacheSize)
+	{
+		vector<unsigned char> triangleMisses;
+		simulateVertexCache(indices, indexCount, vertexCount, cacheSize, triangleMisses);
+		size_t misses = 0;
+		for (size_t triangle = 0; triangle < triangleMisses.size(); triangle++)
+		{
+			misses += triangleMisses[triangle];
+		}
+		VertexCacheStats stats;
+		stats.acmr = triangleMisses.empty() ? 0.0f : ((float)misses / triangleMisses.size());
+		stats.atvr = (vertexCount == 0) ? 0.0f : ((float)misses / vertexCount);
+		return stats;
+	}
+
+	void optimizeVertexCache(unsigned int* indices, size_t indexCount, size_t vertexCount, int cacheSize)
+	{
+		// initialize
+		size_t triangleCount = indexCount / 3;
+		vector<unsigned int> adjacencyOffsets;
+		vector<unsigned int> adjacentTriangles;
+		buildTriangleAdjacency(indices, indexCount, vertexCount, adjacencyOffsets, adjacentTriangles);
+		vector<unsigned int> liveTriangles(vertexCount);
+		for (size_t vertex = 0; vertex < vertexCount; vertex++)
+		{
+			liveTriangles[vertex] = adjacencyOffsets[vertex + 1] - adjacencyOffsets[vertex];
+		}
+		vector<size_t> cacheTime(vertexCount, 0);
+		vector<bool> emitted(triangleCount, false);
+		vector<unsigned int> deadEnds;
+		vector<unsigned int> candidates;
+		vector<unsigned int> output;
+		output.reserve(indexCount);
+		size_t timeStamp = cacheSize + 1;
+		size_t scanCursor = 0;
+
+		// fan around one vertex at a time
+		long long fanVertex = (vertexCount > 0) ? 0 : -1;
+		while (fanVertex >= 0)
+		{
+			// emit every triangle still around the fanning vertex
+			candidates.clear();
+			for (unsigned int a = adjacencyOffsets[fanVertex]; a < adjacencyOffsets[fanVertex + 1]; a++)
+			{
+				unsigned int triangle = adjacentTriangles[a];
+				if (emitted[triangle])
+				{
+					continue;
+				}
+				for (int corner = 0; corner < 3; corner++)
+				{
+					unsigned int vertex = indices[(3 * triangle) + corner];
+					output.push_back(vertex);
+					deadEnds.push_back(vertex);
+					candidates.push_back(vertex);
+					liveTriangles[vertex]--;
+					if ((timeStamp - cacheTime[vertex]) > (size_t)cacheSize)
+					{
+						cacheTime[vertex] = timeStamp++;
+					}
+				}
+				emitted[triangle] = true;
+			}
+
+			// NOTE: The next fanning vertex is the candidate that will stay cached the longest while all
+			//       of its remaining triangles are emitted, otherwise we backtrack to a recent vertex that
+			//       still has triangles left, and only then scan forward for any such vertex
+			long long nextVertex = -1;
+			long long bestPriority = -1;
+			for (size_t c = 0; c < candidates.size(); c++)
+			{
+				unsigned int vertex = candidates[c];
+				if (liveTriangles[vertex] == 0)
+				{
+					continue;
+				}
+				long long priority = 0;
+				long long age = (long long)(timeStamp - cacheTime[vertex]);
+				if ((age + (2 * (long long)liveTriangles[vertex])) <= cacheSize)
+				{
+					priority = age;
+				}
+				if (priority > bestPriority)
+				{
+					bestPriority = priority;
+					nextVertex = vertex;
+				}
+			}
+			while ((nextVertex < 0) && !deadEnds.empty())
+			{
+				unsigned int vertex = deadEnds.back();
+				deadEnds.pop_back();
+				if (liveTriangles[vertex] > 0)
+				{
+					nextVertex = vertex;
+				}
+			}
+			while ((nextVertex < 0) && (scanCursor < vertexCount))
+			{
+				if (liveTriangles[scanCursor] > 0)
+				{
+					nextVertex = scanCursor;
+				}
+				scanCursor++;
+			}
+			fanVertex = nextVertex;
+		}
+
+		// done
+		copy(output.begin(), output.end(), indices);
+	}
+
+	void optimizeOverdraw(unsigned int* indices, size_t indexCount, const float* positions, size_t vertexCount, int cacheSize,
+		float threshold)
+	{
+		// find the hard cluster boundaries, where every vertex of a triangle missed the cache
+		size_t triangleCount = indexCount / 3;
+		if (triangleCount == 0)
+		{
+			return;
+		}
+		vector<unsigned char> triangleMisses;
+		simulateVertexCache(indices, indexCount, vertexCount, cacheSize, triangleMisses);
+
+		// NOTE: Each hard cluster is split further wherever the ACMR of the triangles since the last split,
+		//       counted from a cold cache, gets within threshold of the hard cluster's own ACMR, so a split
+		//       never costs much more than the cache flush it starts with
+		vector<size_t> clusterStarts;
+		vector<size_t> loadedAt(vertexCount, 0);
+		size_t missCount = 0;
+		size_t hardStart = 0;
+		while (hardStart < triangleCount)
+		{
+			size_t hardEnd = hardStart + 1;
+			size_t hardMisses = triangleMisses[hardStart];
+			while ((hardEnd < triangleCount) && (triangleMisses[hardEnd] != 3))
+			{
+				hardMisses += triangleMisses[hardEnd++];
+			}
+			float clusterThreshold = threshold * ((float)hardMisses / (hardEnd - hardStart));
+			clusterStarts.push_back(hardStart);
+			missCount += cacheSize + 1;
+			size_t runningMisses = 0;
+			size_t runningTriangles = 0;
+			for (size_t triangle = hardStart; triangle < hardEnd; triangle++)
+			{
+				for (int corner = 0; corner < 3; corner++)
+				{
+					unsigned int vertex = indices[(3 * triangle) + corner];
+					if ((loadedAt[vertex] == 0) || ((missCount - loadedAt[vertex]) >= (size_t)cacheSize))
+					{
+						loadedAt[vertex] = ++missCount;
+						runningMisses++;
+					}
+				}
+				runningTriangles++;
+				if (((triangle + 1) < hardEnd) && (((float)runningMisses / runningTriangles) <= clusterThreshold))
+				{
+					clusterStarts.push_back(triangle + 1);
+					missCount += cacheSize + 1;
+					runningMisses = 0;
+					runningTriangles = 0;
+				}
+			}
+			hardStart = hardEnd;
+		}
+		clusterStarts.push_back(triangleCount);
+		size_t clusterCount = clusterStarts.size() - 1;
+
+		// find the mesh centroid
+		double meshCentroid[3] = {0.0, 0.0, 0.0};
+		for (size_t vertex = 0; vertex < vertexCount; vertex++)
+		{
+			for (int axis = 0; axis < 3; axis++)
+			{
+				meshCentroid[axis] += positions[(3 * vertex) + axis];
+			}
+		}
+		for (int axis = 0; axis < 3; axis++)
+		{
+			meshCentroid[axis] /= (vertexCount > 0) ? vertexCount : 1;
+		}
+
+		// NOTE: A cluster's sort key is how far its area weighted centroid lies out along its area weighted
+		//       normal, measured from the mesh centroid
+		vector<float> clusterKeys(clusterCount);
+		for (size_t cluster = 0; cluster < clusterCount; cluster++)
+		{
+			double centroid[3] = {0.0, 0.0, 0.0};
+			double normal[3] = {0.0, 0.0, 0.0};
+			double area = 0.0;
+			for (size_t triangle = clusterStarts[cluster]; triangle < clusterStarts[cluster + 1]; triangle++)
+			{
+				const float* position0 = positions + (3 * indices[(3 * triangle) + 0]);
+				const float* position1 = positions + (3 * indices[(3 * triangle) + 1]);
+				const float* position2 = positions + (3 * indices[(3 * triangle) + 2]);
+				double edge1[3] = {position1[0] - position0[0], position1[1] - position0[1], position1[2] - position0[2]};
+				double edge2[3] = {position2[0] - position0[0], position2[1] - position0[1], position2[2] - position0[2]};
+				double cross[3] = {(edge1[1] * edge2[2]) - (edge1[2] * edge2[1]), (edge1[2] * edge2[0]) - (edge1[0] * edge2[2]),
+					(edge1[0] * edge2[1]) - (edge1[1] * edge2[0])};
+				double weight = sqrt((cross[0] * cross[0]) + (cross[1] * cross[1]) + (cross[2] * cross[2]));
+				for (int axis = 0; axis < 3; axis++)
+				{
+					centroid[axis] += weight * (position0[axis] + position1[axis] + position2[axis]) / 3.0;
+					normal[axis] += cross[axis];
+				}
+				area += weight;
+			}
+			double key = 0.0;
+			for (int axis = 0; axis < 3; axis++)
+			{
+				double clusterCentroid = (area > 0.0) ? (centroid[axis] / area) : 0.0;
+				key += (clusterCentroid - meshCentroid[axis]) * normal[axis];
+			}
+			double normalLength = sqrt((normal[0] * normal[0]) + (normal[1] * normal[1]) + (normal[2] * normal[2]));
+			clusterKeys[cluster] = (normalLength > 0.0) ? (float)(key / normalLength) : 0.0f;
+		}
+
+		// draw the outermost clusters first, keeping the cache order within each cluster
+		vector<unsigned int> clusterOrder(clusterCount);
+		for (size_t cluster = 0; cluster < clusterCount; cluster++)
+		{
+			clusterOrder[cluster] = (unsigned int)cluster;
+		}
+		stable_sort(clusterOrder.begin(), clusterOrder.end(), [&](unsigned int a, unsigned int b)
+		{
+			return clusterKeys[a] > clusterKeys[b];
+		});
+		vector<unsigned int> output;
+		output.reserve(indexCount);
+		for (size_t order = 0; order < clusterCount; order++)
+		{
+			size_t cluster = clusterOrder[order];
+			output.insert(output.end(), indices + (3 * clusterStarts[cluster]), indices + (3 * clusterStarts[cluster + 1]));
+		}
+		copy(output.begin(), output.end(), indices);
+	}
+
+	size_t optimizeVertexFetch(unsigned int* indices, size_t indexCount, size_t vertexCount, vector<unsigned int>& remap)
+	{
+		remap.assign(vertexCount, UNUSED_VERTEX);
+		unsigned int nextVertex = 0;
+		for (size_t i = 0; i < indexCount; i++)
+		{
+			if (remap[indices[i]] == UNUSED_VERTEX)
+			{
+				remap[indices[i]] = nextVertex++;
+			}
+			indices[i] = remap[indices[i]];
+		}
+		return nextVertex;
+	}
+}
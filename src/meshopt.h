@@ -0,0 +1,41 @@
+//// Declaration Guards
+#ifndef MESH_OPT_H
+#define MESH_OPT_H
+
+//// Imports
+#include <stddef.h>
+#include <vector>
+
+namespace SWPTAS001
+{
+	//// Structures
+	struct VertexCacheStats
+	{
+		float acmr; // vertex shader runs per triangle
+		float atvr; // vertex shader runs per unique vertex
+	};
+
+	//// Mesh Optimization Routines
+	VertexCacheStats analyzeVertexCache(const unsigned int* indices, size_t indexCount, size_t vertexCount, int cacheSize);
+	void optimizeVertexCache(unsigned int* indices, size_t indexCount, size_t vertexCount, int cacheSize);
+	void optimizeOverdraw(unsigned int* indices, size_t indexCount, const float* positions, size_t vertexCount, int cacheSize,
+		float threshold);
+	size_t optimizeVertexFetch(unsigned int* indices, size_t indexCount, size_t vertexCount, std::vector<unsigned int>& remap);
+}
+
+#endif
+
+// NOTE: analyzeVertexCache() simulates a FIFO post-transform cache of cacheSize entries. An ACMR of
+//       0.5 is the best a large regular mesh can get, 3 means nothing is ever reused, and an ATVR of 1
+//       means every vertex is shaded exactly once
+// NOTE: optimizeVertexCache() reorders triangles with Tipsify (Sander, Nehab & Barczak, "Fast Triangle
+//       Reordering for Vertex Locality and Reduced Overdraw"): it fans around one vertex at a time and
+//       picks the next fanning vertex among the ones still in the cache, so it runs in linear time
+// NOTE: optimizeOverdraw() expects cache optimized input. It cuts the triangles into clusters wherever
+//       the cache was flushed, and again wherever a cluster has paid off its own cache flush (its ACMR
+//       is within threshold, e.g. 1.05, of the surrounding run's), then sorts the clusters so the ones
+//       facing outward from the mesh centre are drawn first. Those are the most likely occluders, so
+//       fewer fragments get shaded only to be overwritten
+// NOTE: optimizeVertexFetch() renumbers vertices in the order the indices first use them, so vertex
+//       fetches walk memory forward. remap[oldIndex] gives the new index (or 0xFFFFFFFF for unused
+//       vertices), and the number of used vertices is returned. The caller permutes its own attributes
@@ -0,0 +1,293 @@
+//// Header
+#include "mipmaps.h"
+
+//// Imports
+#include "parallel.h"
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+//// Configurations
+#if defined(__AVX2__)
+#define MIPMAPS_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#define MIPMAPS_SSE2
+#include <emmintrin.h>
+#endif
+
+//// Namespaces
+using namespace std;
+
+namespace SWPTAS001
+{
+	//// Constants
+	static const size_t MIP_ROW_BLOCK = 16;
+	static const unsigned int SRGB_BUCKET_FLOOR = 0x39000000; // 2^-13 as float bits
+	static const unsigned int SRGB_BUCKET_COUNT = (0x3F800000 - SRGB_BUCKET_FLOOR) >> 16; // up to 1.0
+
+	/////////////
+	// Helpers //
+	/////////////
+
+	static double srgbToLinear(double value)
+	{
+		return (value <= 0.04045) ? (value / 12.92) : pow((value + 0.055) / 1.055, 2.4);
+	}
+
+	static const float* srgbDecodeTable()
+	{
+		static float table[256];
+		static bool built = [&]()
+		{
+			for (int code = 0; code < 256; code++)
+			{
+				table[code] = (float)srgbToLinear(code / 255.0);
+			}
+			return true;
+		}();
+		(void)built;
+		return table;
+	}
+
+	static const float* srgbEncodeThresholds()
+	{
+		// NOTE: Threshold i is the linear value halfway (in sRGB) between codes i and i + 1, so the code
+		//       of a linear value is the number of thresholds at or below it, rounded like encoding exactly
+		static float thresholds[255];
+		static bool built = [&]()
+		{
+			for (int code = 0; code < 255; code++)
+			{
+				thresholds[code] = (float)srgbToLinear((code + 0.5) / 255.0);
+			}
+			return true;
+		}();
+		(void)built;
+		return thresholds;
+	}
+
+	static const unsigned char* srgbEncodeBuckets()
+	{
+		// NOTE: Every float in [2^-13, 1) falls in a bucket by its exponent and top 7 mantissa bits, each
+		//       holding the code its lowest value encodes to. Buckets are narrow enough to cross at most
+		//       one threshold, and everything below 2^-13 is under the first one
+		static unsigned char buckets[SRGB_BUCKET_COUNT];
+		static bool built = [&]()
+		{
+			const float* thresholds = srgbEncodeThresholds();
+			for (unsigned int bucket = 0; bucket < SRGB_BUCKET_COUNT; bucket++)
+			{
+				unsigned int bits = (bucket + (SRGB_BUCKET_FLOOR >> 16)) << 16;
+				float value;
+				memcpy(&value, &bits, sizeof(value));
+				buckets[bucket] = (unsigned char)(upper_bound(thresholds, thresholds + 255, value) - thresholds);
+			}
+			return true;
+		}();
+		(void)built;
+		return buckets;
+	}
+
+	static inline unsigned char encodeSRGB(float value, const unsigned char* buckets, const float* thresholds)
+	{
+		unsigned int bits;
+		memcpy(&bits, &value, sizeof(bits));
+		if (!(value >= 0.0f) || (bits < SRGB_BUCKET_FLOOR))
+		{
+			return 0;
+		}
+		if (value >= 1.0f)
+		{
+			return 255;
+		}
+		unsigned int code = buckets[(bits >> 16) - (SRGB_BUCKET_FLOOR >> 16)];
+		while ((code < 255) && (value >= thresholds[code]))
+		{
+			code++;
+		}
+		return (unsigned char)code;
+	}
+
+	static inline unsigned char encodeUnit(float value)
+	{
+		return (unsigned char)(min(max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+	}
+
+	static void downsampleRow(const float* row0, const float* row1, int sourceWidth, float* target, int targetWidth)
+	{
+		// NOTE: Sums as (top left + bottom left) + (top right + bottom right) on every path
+		int column = 0;
+		int pairedWidth = min(targetWidth, sourceWidth / 2);
+#if defined(MIPMAPS_AVX2)
+		__m256 quarter = _mm256_set1_ps(0.25f);
+		for (; (column + 2) <= pairedWidth; column += 2)
+		{
+			__m256 sum0 = _mm256_add_ps(_mm256_loadu_ps(row0 + (8 * column)), _mm256_loadu_ps(row1 + (8 * column)));
+			__m256 sum1 = _mm256_add_ps(_mm256_loadu_ps(row0 + (8 * column) + 8), _mm256_loadu_ps(row1 + (8 * column) + 8));
+			__m256 left = _mm256_permute2f128_ps(sum0, sum1, 0x20);
+			__m256 right = _mm256_permute2f128_ps(sum0, sum1, 0x31);
+			_mm256_storeu_ps(target + (4 * column), _mm256_mul_ps(_mm256_add_ps(left, right), quarter));
+		}
+#elif defined(MIPMAPS_SSE2)
+		__m128 quarter = _mm_set1_ps(0.25f);
+		for (; column < pairedWidth; column++)
+		{
+			__m128 left = _mm_add_ps(_mm_loadu_ps(row0 + (8 * column)), _mm_loadu_ps(row1 + (8 * column)));
+			__m128 right = _mm_add_ps(_mm_loadu_ps(row0 + (8 * column) + 4), _mm_loadu_ps(row1 + (8 * column) + 4));
+			_mm_storeu_ps(target + (4 * column), _mm_mul_ps(_mm_add_ps(left, right), quarter));
+		}
+#endif
+		for (; column < targetWidth; column++)
+		{
+			int left = 2 * column;
+			int right = min(left + 1, sourceWidth - 1);
+			for (int channel = 0; channel < 4; channel++)
+			{
+				float leftSum = row0[(4 * left) + channel] + row1[(4 * left) + channel];
+				float rightSum = row0[(4 * right) + channel] + row1[(4 * right) + channel];
+				target[(4 * column) + channel] = (leftSum + rightSum) * 0.25f;
+			}
+		}
+	}
+
+	static void normalizeTexel(float* texel)
+	{
+		float length = sqrtf((texel[0] * texel[0]) + (texel[1] * texel[1]) + (texel[2] * texel[2]));
+		if (length > 0.0f)
+		{
+#if defined(MIPMAPS_AVX2) || defined(MIPMAPS_SSE2)
+			_mm_storeu_ps(texel, _mm_div_ps(_mm_loadu_ps(texel), _mm_set_ps(1.0f, length, length, length)));
+#else
+			texel[0] /= length;
+			texel[1] /= length;
+			texel[2] /= length;
+#endif
+		}
+		else
+		{
+			texel[0] = 0.0f;
+			texel[1] = 0.0f;
+			texel[2] = 1.0f;
+		}
+	}
+
+	static void liftRow(const unsigned char* source, int width, MipMode mode, float* target)
+	{
+		const float* decodeTable = srgbDecodeTable();
+		for (int texel = 0; texel < width; texel++, source += 4, target += 4)
+		{
+			for (int channel = 0; channel < 3; channel++)
+			{
+				target[channel] = (mode == NORMAL_MIPS) ? ((source[channel] / 255.0f) * 2.0f - 1.0f) : decodeTable[source[channel]];
+			}
+			target[3] = source[3] / 255.0f;
+			if (mode == NORMAL_MIPS)
+			{
+				normalizeTexel(target);
+			}
+		}
+	}
+
+	static void encodeTexel(const float* texel, MipMode mode, unsigned char* target)
+	{
+		if (mode == NORMAL_MIPS)
+		{
+			for (int channel = 0; channel < 3; channel++)
+			{
+				target[channel] = encodeUnit((texel[channel] * 0.5f) + 0.5f);
+			}
+		}
+		else
+		{
+			const unsigned char* buckets = srgbEncodeBuckets();
+			const float* thresholds = srgbEncodeThresholds();
+			for (int channel = 0; channel < 3; channel++)
+			{
+				target[channel] = encodeSRGB(texel[channel], buckets, thresholds);
+			}
+		}
+		target[3] = encodeUnit(texel[3]);
+	}
+
+	/////////////////////
+	// Mipmap Routines //
+	/////////////////////
+
+	void generateMipChain(const unsigned char* pixels, int width, int height, MipMode mode, MipChain& chain, int threadCount)
+	{
+		// lay out the levels
+		chain.format = RGBA8_TEXTURE;
+		chain.psnr = 0.0f;
+		chain.bumpStrength = 0.0f;
+		chain.mappedTexels = NULL;
+		chain.levels.clear();
+		size_t totalBytes = 0;
+		for (int levelWidth = width, levelHeight = height; ; levelWidth = max(1, levelWidth / 2), levelHeight = max(1, levelHeight / 2))
+		{
+			MipLevel level = {levelWidth, levelHeight, totalBytes};
+			chain.levels.push_back(level);
+			totalBytes += (size_t)levelWidth * levelHeight * 4;
+			if ((levelWidth == 1) && (levelHeight == 1))
+			{
+				break;
+			}
+		}
+		chain.texels.resize(totalBytes);
+		copy(pixels, pixels + ((size_t)width * height * 4), chain.texels.begin());
+
+		// filter each level from the one before
+		// NOTE: Level 0 is lifted into floats two rows at a time as level 1 needs them, the levels after
+		//       that are filtered from the floats the level before left behind
+		vector<float> current;
+		vector<float> next;
+		for (size_t levelIndex = 1; levelIndex < chain.levels.size(); levelIndex++)
+		{
+			const MipLevel& source = chain.levels[levelIndex - 1];
+			const MipLevel& level = chain.levels[levelIndex];
+			next.resize((size_t)level.width * level.height * 4);
+			unsigned char* levelTexels = &chain.texels[level.offset];
+			size_t rowBlocks = ((size_t)level.height + MIP_ROW_BLOCK - 1) / MIP_ROW_BLOCK;
+			parallelFor(rowBlocks, threadCount, [&](size_t block)
+			{
+				vector<float> liftedRows((levelIndex == 1) ? ((size_t)width * 8) : 0);
+				for (int row = (int)(block * MIP_ROW_BLOCK); row < min(level.height, (int)((block + 1) * MIP_ROW_BLOCK)); row++)
+				{
+					int sourceRow0 = 2 * row;
+					int sourceRow1 = min(sourceRow0 + 1, source.height - 1);
+					const float* row0;
+					const float* row1;
+					if (levelIndex == 1)
+					{
+						liftRow(pixels + ((size_t)sourceRow0 * width * 4), width, mode, &liftedRows[0]);
+						liftRow(pixels + ((size_t)sourceRow1 * width * 4), width, mode, &liftedRows[(size_t)width * 4]);
+						row0 = &liftedRows[0];
+						row1 = &liftedRows[(size_t)width * 4];
+					}
+					else
+					{
+						row0 = &current[(size_t)sourceRow0 * source.width * 4];
+						row1 = &current[(size_t)sourceRow1 * source.width * 4];
+					}
+					float* target = &next[(size_t)row * level.width * 4];
+					downsampleRow(row0, row1, source.width, target, level.width);
+					for (int column = 0; column < level.width; column++)
+					{
+						float* texel = target + (4 * column);
+						if (mode == NORMAL_MIPS)
+						{
+							normalizeTexel(texel);
+						}
+						encodeTexel(texel, mode, levelTexels + (4 * ((size_t)row * level.width + column)));
+					}
+				}
+			});
+			current.swap(next);
+		}
+	}
+
+	const unsigned char* mipLevelTexels(const MipChain& chain, size_t levelIndex)
+	{
+		return (chain.mappedTexels ? chain.mappedTexels : &chain.texels[0]) + chain.levels[levelIndex].offset;
+	}
+}
@@ -0,0 +1,48 @@
+//// Declaration Guards
+#ifndef MIPMAPS_H
+#define MIPMAPS_H
+
+//// Imports
+#include <stddef.h>
+#include <vector>
+
+namespace SWPTAS001
+{
+	//// Enumerations
+	enum MipMode { COLOR_MIPS, NORMAL_MIPS };
+	enum TextureFormat { RGBA8_TEXTURE, BC1_TEXTURE, BC3_TEXTURE, BC5_TEXTURE };
+
+	//// Structures
+	struct MipLevel
+	{
+		int width;
+		int height;
+		size_t offset; // bytes into MipChain::texels
+	};
+
+	struct MipChain
+	{
+		TextureFormat format = RGBA8_TEXTURE;
+		std::vector<MipLevel> levels; // level 0 first, down to 1 x 1
+		std::vector<unsigned char> texels; // every level's RGBA texels (or 4 x 4 blocks, see blockcompress.h), back to back
+		float psnr = 0.0f; // dB of level 0 against the RGBA texels it was compressed from, block formats only
+		float bumpStrength = 0.0f; // strength its normals were derived from heights with (see heightmap.h), 0 if they weren't
+		const unsigned char* mappedTexels = NULL; // where the level offsets point instead of texels, when mapped from a texture cache
+	};
+
+	//// Mipmap Routines
+	void generateMipChain(const unsigned char* pixels, int width, int height, MipMode mode, MipChain& chain, int threadCount);
+	const unsigned char* mipLevelTexels(const MipChain& chain, size_t levelIndex);
+}
+
+#endif
+
+// NOTE: generateMipChain() keeps the RGBA pixels as level 0 and box filters each level from the one
+//       before, halving both sides (odd sides drop their last texel) until it reaches 1 x 1. Filtering
+//       happens in floats kept from level to level, so rounding doesn't build up down the chain
+// NOTE: COLOR_MIPS treats rgb as sRGB, so texels are averaged in linear light and encoded back, which
+//       keeps minified textures from darkening. NORMAL_MIPS treats rgb as a tangent-space normal map
+//       (rgb * 2 - 1): vectors are averaged and renormalized at every level. Alpha is always linear
+// NOTE: mipLevelTexels() finds a level's texels whether the chain owns them or they are mapped
+// NOTE: Rows of each level are filtered in parallel, with AVX2 (2 texels at a time) or SSE2 kernels where
+//       available. Every path adds the 4 texels in the same order, so all of them give the same bytes
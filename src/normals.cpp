@@ -0,0 +1,223 @@
+//// Header
+#include "normals.h"
+
+//// Imports
+#include "parallel.h"
+#include <algorithm>
+#include <math.h>
+
+//// Namespaces
+using namespace std;
+
+namespace SWPTAS001
+{
+	//// Constants
+	static const size_t NORMAL_BLOCK_SIZE = 16384;
+
+	/////////////////////
+	// Normal Routines //
+	/////////////////////
+
+	void weldVertices(const float* positions, const float* normals, size_t vertexCount, vector<unsigned int>& remap)
+	{
+		// NOTE: Sorting by the attributes puts duplicates next to each other, ties keep their original order
+		//       so each group maps to its lowest index
+		int components = normals ? 6 : 3;
+		auto attribute = [&](unsigned int vertex, int component)
+		{
+			return (component < 3) ? positions[(3 * vertex) + component] : normals[(3 * vertex) + component - 3];
+		};
+		vector<unsigned int> order(vertexCount);
+		for (size_t vertex = 0; vertex < vertexCount; vertex++)
+		{
+			order[vertex] = (unsigned int)vertex;
+		}
+		stable_sort(order.begin(), order.end(), [&](unsigned int a, unsigned int b)
+		{
+			for (int component = 0; component < components; component++)
+			{
+				float valueA = attribute(a, component);
+				float valueB = attribute(b, component);
+				if (valueA != valueB)
+				{
+					return valueA < valueB;
+				}
+			}
+			return false;
+		});
+		remap.resize(vertexCount);
+		for (size_t sorted = 0; sorted < vertexCount; sorted++)
+		{
+			bool same = (sorted > 0);
+			for (int component = 0; same && (component < components); component++)
+			{
+				same = (attribute(order[sorted], component) == attribute(order[sorted - 1], component));
+			}
+			remap[order[sorted]] = same ? remap[order[sorted - 1]] : order[sorted];
+		}
+	}
+
+	static bool normalizeInto(const float* direction, float* normal)
+	{
+		float length = sqrtf((direction[0] * direction[0]) + (direction[1] * direction[1]) + (direction[2] * direction[2]));
+		if (length > 0.0f)
+		{
+			normal[0] = direction[0] / length;
+			normal[1] = direction[1] / length;
+			normal[2] = direction[2] / length;
+		}
+		return (length > 0.0f);
+	}
+
+	static void weighCorners(const float* positions, const unsigned int* indices, size_t faceCount, vector<float>& weighted,
+		vector<float>* faceDirections, int threadCount)
+	{
+		// NOTE: The cross product is twice the face area long, and each corner scales it by its own
+		//       angle, so a vertex isn't swayed by how finely the faces around it happen to be split
+		weighted.resize(faceCount * 9);
+		if (faceDirections)
+		{
+			faceDirections->assign(faceCount * 3, 0.0f);
+		}
+		size_t blockCount = (faceCount + NORMAL_BLOCK_SIZE - 1) / NORMAL_BLOCK_SIZE;
+		parallelFor(blockCount, threadCount, [&](size_t block)
+		{
+			for (size_t face = block * NORMAL_BLOCK_SIZE; face < min(faceCount, (block + 1) * NORMAL_BLOCK_SIZE); face++)
+			{
+				const unsigned int* corners = indices + (3 * face);
+				const float* position[3] = {positions + (3 * corners[0]), positions + (3 * corners[1]), positions + (3 * corners[2])};
+				float edge1[3] = {position[1][0] - position[0][0], position[1][1] - position[0][1], position[1][2] - position[0][2]};
+				float edge2[3] = {position[2][0] - position[0][0], position[2][1] - position[0][1], position[2][2] - position[0][2]};
+				float faceNormal[3] = {(edge1[1] * edge2[2]) - (edge1[2] * edge2[1]), (edge1[2] * edge2[0]) - (edge1[0] * edge2[2]),
+					(edge1[0] * edge2[1]) - (edge1[1] * edge2[0])};
+				for (int corner = 0; corner < 3; corner++)
+				{
+					const float* origin = position[corner];
+					const float* next = position[(corner + 1) % 3];
+					const float* previous = position[(corner + 2) % 3];
+					float toNext[3] = {next[0] - origin[0], next[1] - origin[1], next[2] - origin[2]};
+					float toPrevious[3] = {previous[0] - origin[0], previous[1] - origin[1], previous[2] - origin[2]};
+					float lengths = sqrtf(((toNext[0] * toNext[0]) + (toNext[1] * toNext[1]) + (toNext[2] * toNext[2]))
+						* ((toPrevious[0] * toPrevious[0]) + (toPrevious[1] * toPrevious[1]) + (toPrevious[2] * toPrevious[2])));
+					float angle = 0.0f;
+					if (lengths > 0.0f)
+					{
+						float cosine = ((toNext[0] * toPrevious[0]) + (toNext[1] * toPrevious[1]) + (toNext[2] * toPrevious[2])) / lengths;
+						angle = acosf(max(-1.0f, min(cosine, 1.0f)));
+					}
+					float* target = &weighted[(9 * face) + (3 * corner)];
+					target[0] = faceNormal[0] * angle;
+					target[1] = faceNormal[1] * angle;
+					target[2] = faceNormal[2] * angle;
+				}
+				if (faceDirections)
+				{
+					normalizeInto(faceNormal, &(*faceDirections)[3 * face]);
+				}
+			}
+		});
+	}
+
+	static void listGroupCorners(const unsigned int* indices, size_t cornerCount, const unsigned int* remap, size_t vertexCount,
+		vector<unsigned int>& groupStarts, vector<unsigned int>& groupCorners)
+	{
+		// NOTE: A counting sort by welded vertex, which keeps the corners of each group in corner order
+		groupStarts.assign(vertexCount + 1, 0);
+		for (size_t corner = 0; corner < cornerCount; corner++)
+		{
+			groupStarts[(remap ? remap[indices[corner]] : indices[corner]) + 1]++;
+		}
+		for (size_t vertex = 0; vertex < vertexCount; vertex++)
+		{
+			groupStarts[vertex + 1] += groupStarts[vertex];
+		}
+		groupCorners.resize(cornerCount);
+		vector<unsigned int> fill(groupStarts.begin(), groupStarts.end() - 1);
+		for (size_t corner = 0; corner < cornerCount; corner++)
+		{
+			groupCorners[fill[remap ? remap[indices[corner]] : indices[corner]]++] = (unsigned int)corner;
+		}
+	}
+
+	void generateVertexNormals(const float* positions, size_t vertexCount, const unsigned int* indices, size_t indexCount,
+		const unsigned int* remap, float* normals, int threadCount)
+	{
+		// weigh every corner, then sum the corners of each welded vertex
+		size_t faceCount = indexCount / 3;
+		vector<float> weighted;
+		weighCorners(positions, indices, faceCount, weighted, NULL, threadCount);
+		vector<unsigned int> groupStarts;
+		vector<unsigned int> groupCorners;
+		listGroupCorners(indices, faceCount * 3, remap, vertexCount, groupStarts, groupCorners);
+		vector<float> groupNormals(vertexCount * 3, 0.0f);
+		size_t blockCount = (vertexCount + NORMAL_BLOCK_SIZE - 1) / NORMAL_BLOCK_SIZE;
+		parallelFor(blockCount, threadCount, [&](size_t block)
+		{
+			for (size_t group = block * NORMAL_BLOCK_SIZE; group < min(vertexCount, (block + 1) * NORMAL_BLOCK_SIZE); group++)
+			{
+				float* sum = &groupNormals[3 * group];
+				for (unsigned int member = groupStarts[group]; member < groupStarts[group + 1]; member++)
+				{
+					const float* corner = &weighted[3 * groupCorners[member]];
+					sum[0] += corner[0];
+					sum[1] += corner[1];
+					sum[2] += corner[2];
+				}
+			}
+		});
+
+		// hand every vertex its group's normal
+		parallelFor(blockCount, threadCount, [&](size_t block)
+		{
+			for (size_t vertex = block * NORMAL_BLOCK_SIZE; vertex < min(vertexCount, (block + 1) * NORMAL_BLOCK_SIZE); vertex++)
+			{
+				normalizeInto(&groupNormals[3 * (remap ? remap[vertex] : vertex)], normals + (3 * vertex));
+			}
+		});
+	}
+
+	void generateCornerNormals(const float* positions, size_t vertexCount, const unsigned int* indices, size_t indexCount,
+		const unsigned int* remap, float creaseCosine, float* cornerNormals, int threadCount)
+	{
+		// weigh every corner, keeping each face's direction to compare against the crease
+		size_t faceCount = indexCount / 3;
+		vector<float> weighted;
+		vector<float> faceDirections;
+		weighCorners(positions, indices, faceCount, weighted, &faceDirections, threadCount);
+		vector<unsigned int> groupStarts;
+		vector<unsigned int> groupCorners;
+		listGroupCorners(indices, faceCount * 3, remap, vertexCount, groupStarts, groupCorners);
+
+		// every corner sums the corners around it whose faces are within the crease angle of its own
+		size_t blockCount = (vertexCount + NORMAL_BLOCK_SIZE - 1) / NORMAL_BLOCK_SIZE;
+		parallelFor(blockCount, threadCount, [&](size_t block)
+		{
+			for (size_t group = block * NORMAL_BLOCK_SIZE; group < min(vertexCount, (block + 1) * NORMAL_BLOCK_SIZE); group++)
+			{
+				for (unsigned int member = groupStarts[group]; member < groupStarts[group + 1]; member++)
+				{
+					unsigned int corner = groupCorners[member];
+					const float* direction = &faceDirections[3 * (corner / 3)];
+					float sum[3] = {0.0f, 0.0f, 0.0f};
+					for (unsigned int other = groupStarts[group]; other < groupStarts[group + 1]; other++)
+					{
+						unsigned int otherCorner = groupCorners[other];
+						const float* otherDirection = &faceDirections[3 * (otherCorner / 3)];
+						float cosine = (direction[0] * otherDirection[0]) + (direction[1] * otherDirection[1]) + (direction[2] * otherDirection[2]);
+						if ((otherCorner == corner) || (cosine >= creaseCosine))
+						{
+							sum[0] += weighted[3 * otherCorner];
+							sum[1] += weighted[(3 * otherCorner) + 1];
+							sum[2] += weighted[(3 * otherCorner) + 2];
+						}
+					}
+					float* normal = cornerNormals + (3 * corner);
+					if (!normalizeInto(sum, normal))
+					{
+						normal[0] = normal[1] = normal[2] = 0.0f;
+					}
+				}
+			}
+		});
+	}
+}
@@ -0,0 +1,32 @@
+//// Declaration Guards
+#ifndef NORMALS_H
+#define NORMALS_H
+
+//// Imports
+#include <stddef.h>
+#include <vector>
+
+namespace SWPTAS001
+{
+	//// Normal Routines
+	void weldVertices(const float* positions, const float* normals, size_t vertexCount, std::vector<unsigned int>& remap);
+	void generateVertexNormals(const float* positions, size_t vertexCount, const unsigned int* indices, size_t indexCount,
+		const unsigned int* remap, float* normals, int threadCount);
+	void generateCornerNormals(const float* positions, size_t vertexCount, const unsigned int* indices, size_t indexCount,
+		const unsigned int* remap, float creaseCosine, float* cornerNormals, int threadCount);
+}
+
+#endif
+
+// NOTE: weldVertices() maps every vertex to the first vertex with exactly the same position (and the same
+//       normal, unless normals is NULL), so attributes can be pooled across seams and other duplicates
+// NOTE: generateVertexNormals() sums the normals of the faces around each welded vertex (remap from
+//       weldVertices(), or NULL to pool nothing), weighted by face area and corner angle, and writes the
+//       result normalized to every vertex of the group. Corners are weighted in parallel over the faces,
+//       listed per group by a counting sort and summed in corner order, so there are no atomics or per
+//       thread copies of the normals and the result doesn't depend on the thread count. A vertex without
+//       any face area keeps its normal
+// NOTE: generateCornerNormals() writes a normal for every face corner (3 floats per index) instead, summed
+//       only over the faces around its welded vertex that are within the crease angle of its own face
+//       (creaseCosine is the cosine of that angle), so vertices can be split along sharp edges. A corner
+//       without any face area gets a zero normal
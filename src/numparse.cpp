@@ -0,0 +1,436 @@
+//// Header
+#include "numparse.h"
+
+//// Imports
+#include <string>
+#include <string.h>
+#include <stdlib.h>
+#include <limits.h>
+
+//// Configurations
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define NUMPARSE_SSE2
+#include <emmintrin.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+//// Namespaces
+using namespace std;
+
+namespace SWPTAS001
+{
+	/////////////
+	// Helpers //
+	/////////////
+
+	static inline bool isDigit(char c)
+	{
+		return (c >= '0') && (c <= '9');
+	}
+
+#ifdef NUMPARSE_SSE2
+	static inline unsigned trailingZeros(unsigned mask)
+	{
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanForward(&index, mask);
+		return (unsigned)index;
+#else
+		return (unsigned)__builtin_ctz(mask);
+#endif
+	}
+
+	static inline unsigned trailingZeros64(unsigned long long mask)
+	{
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanForward64(&index, mask);
+		return (unsigned)index;
+#else
+		return (unsigned)__builtin_ctzll(mask);
+#endif
+	}
+
+	// Returns a 16 bit mask with one bit set for every byte of the block that is a decimal digit
+	static inline unsigned digitMask(__m128i block)
+	{
+		__m128i aboveZero = _mm_cmpgt_epi8(block, _mm_set1_epi8('0' - 1));
+		__m128i belowNine = _mm_cmplt_epi8(block, _mm_set1_epi8('9' + 1));
+		return (unsigned)_mm_movemask_epi8(_mm_and_si128(aboveZero, belowNine));
+	}
+#endif
+
+	static inline unsigned long long parseEightDigits(const char* digits)
+	{
+		// NOTE: SWAR conversion, each step combines neighbouring lanes (1, 2, then 4 digits wide)
+		unsigned long long value;
+		memcpy(&value, digits, 8);
+		value -= 0x3030303030303030ULL;
+		value = (value * 10) + (value >> 8);
+		value = (((value & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+			(((value >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+		return value;
+	}
+
+	static inline unsigned long long parseShortDigits(const char* digits, size_t digitCount)
+	{
+		// NOTE: Converts a run of 1 to 8 digits with a single 8 byte load (so 8 bytes must be readable).
+		//       Subtracting '0' first means any borrow out of the non-digit bytes only travels towards
+		//       the bytes past the run, which the shift then discards along with the bytes themselves
+		unsigned long long value;
+		memcpy(&value, digits, 8);
+		value -= 0x3030303030303030ULL;
+		value <<= 8 * (8 - digitCount);
+		value = (value * 10) + (value >> 8);
+		value = (((value & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+			(((value >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+		return value;
+	}
+
+	static inline unsigned long long accumulateDigits(const char* digits, size_t digitCount, unsigned long long value)
+	{
+		while (digitCount >= 8)
+		{
+			value = (value * 100000000ULL) + parseEightDigits(digits);
+			digits += 8;
+			digitCount -= 8;
+		}
+		while (digitCount > 0)
+		{
+			value = (value * 10) + (*digits - '0');
+			digits++;
+			digitCount--;
+		}
+		return value;
+	}
+
+	static inline size_t countLeadingZeros(const char* digits, size_t digitCount)
+	{
+		size_t zeros = 0;
+		while ((zeros < digitCount) && (digits[zeros] == '0'))
+		{
+			zeros++;
+		}
+		return zeros;
+	}
+
+	static bool parseFloatFallback(const char*& cursor, const char* end, const char* tokenEnd, float& value)
+	{
+		// NOTE: tokenEnd is where the fast parser stopped, or NULL if it couldn't make sense of the
+		//       token at all (inf, nan, ...) in which case the token runs to the next delimiter
+		const char* tokenStart = cursor;
+		if (tokenEnd == NULL)
+		{
+			tokenEnd = cursor;
+			while ((tokenEnd < end) && (*tokenEnd != ' ') && (*tokenEnd != '\t') && (*tokenEnd != '\r') &&
+				(*tokenEnd != '\n') && (*tokenEnd != '/'))
+			{
+				tokenEnd++;
+			}
+		}
+		if (tokenEnd == tokenStart)
+		{
+			return false;
+		}
+		// NOTE: The source buffer isn't null-terminated, so we convert from a bounded copy
+		string token(tokenStart, tokenEnd);
+		char* convertedEnd = NULL;
+		float result = strtof(token.c_str(), &convertedEnd);
+		if (convertedEnd == token.c_str())
+		{
+			return false;
+		}
+		value = result;
+		cursor = tokenStart + (convertedEnd - token.c_str());
+		return true;
+	}
+
+	/////////////////////////////
+	// Number Parsing Routines //
+	/////////////////////////////
+
+	size_t countDigits(const char* cursor, const char* end)
+	{
+		const char* start = cursor;
+#ifdef NUMPARSE_SSE2
+		while ((end - cursor) >= 16)
+		{
+			unsigned nonDigits = ~digitMask(_mm_loadu_si128((const __m128i*)cursor)) & 0xFFFF;
+			if (nonDigits != 0)
+			{
+				return (cursor - start) + trailingZeros(nonDigits);
+			}
+			cursor += 16;
+		}
+#endif
+		while ((cursor < end) && isDigit(*cursor))
+		{
+			cursor++;
+		}
+		return cursor - start;
+	}
+
+	bool parseFloat(const char*& cursor, const char* end, float& value)
+	{
+		static const double powersOfTen[] = {
+			1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+			1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+		const char* scan = cursor;
+
+		// sign
+		bool negative = false;
+		if ((scan < end) && ((*scan == '-') || (*scan == '+')))
+		{
+			negative = (*scan == '-');
+			scan++;
+		}
+
+		// integer and fraction digit runs
+		const char* integerDigits = scan;
+		size_t integerDigitCount = 0;
+		const char* fractionDigits = scan;
+		size_t fractionDigitCount = 0;
+		bool runsFound = false;
+#ifdef NUMPARSE_SSE2
+		// NOTE: The common case ("-0.123456") fits in one 16 byte block, so both runs and the decimal
+		//       point come out of a single digit mask
+		if ((end - scan) >= 16)
+		{
+			unsigned digits = digitMask(_mm_loadu_si128((const __m128i*)scan));
+			unsigned integerRun = trailingZeros(~digits);
+			if (integerRun < 16)
+			{
+				if (scan[integerRun] != '.')
+				{
+					integerDigitCount = integerRun;
+					fractionDigits = scan + integerRun;
+					scan += integerRun;
+					runsFound = true;
+				}
+				else
+				{
+					unsigned fractionRun = trailingZeros(~(digits >> (integerRun + 1)));
+					if ((integerRun + 1 + fractionRun) < 16)
+					{
+						integerDigitCount = integerRun;
+						fractionDigits = scan + integerRun + 1;
+						fractionDigitCount = fractionRun;
+						scan += integerRun + 1 + fractionRun;
+						runsFound = true;
+					}
+				}
+			}
+		}
+#endif
+		if (!runsFound)
+		{
+			integerDigitCount = countDigits(scan, end);
+			scan += integerDigitCount;
+			fractionDigits = scan;
+			if ((scan < end) && (*scan == '.'))
+			{
+				scan++;
+				fractionDigits = scan;
+				fractionDigitCount = countDigits(scan, end);
+				scan += fractionDigitCount;
+			}
+		}
+		if ((integerDigitCount + fractionDigitCount) == 0)
+		{
+			return parseFloatFallback(cursor, end, NULL, value);
+		}
+
+		// exponent (only consumed if it is followed by at least one digit)
+		int exponent = 0;
+		if (((scan + 1) < end) && ((*scan == 'e') || (*scan == 'E')))
+		{
+			const char* exponentScan = scan + 1;
+			bool negativeExponent = false;
+			if ((*exponentScan == '-') || (*exponentScan == '+'))
+			{
+				negativeExponent = (*exponentScan == '-');
+				exponentScan++;
+			}
+			size_t exponentDigitCount = countDigits(exponentScan, end);
+			if (exponentDigitCount > 0)
+			{
+				if (exponentDigitCount > 6)
+				{
+					return parseFloatFallback(cursor, end, exponentScan + exponentDigitCount, value);
+				}
+				int explicitExponent = (int)accumulateDigits(exponentScan, exponentDigitCount, 0);
+				exponent = negativeExponent ? -explicitExponent : explicitExponent;
+				scan = exponentScan + exponentDigitCount;
+			}
+		}
+
+		// mantissa
+		static const unsigned long long integerPowersOfTen[] = {
+			1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL};
+		unsigned long long mantissa;
+		size_t digitCount = integerDigitCount + fractionDigitCount;
+		if ((integerDigitCount <= 8) && (fractionDigitCount <= 8) && ((fractionDigits + 8) <= end))
+		{
+			// NOTE: The common case, each run is converted with one SWAR step and the two are joined
+			mantissa = (integerDigitCount > 0) ? parseShortDigits(integerDigits, integerDigitCount) : 0;
+			if (fractionDigitCount > 0)
+			{
+				mantissa = (mantissa * integerPowersOfTen[fractionDigitCount]) + parseShortDigits(fractionDigits, fractionDigitCount);
+			}
+		}
+		else
+		{
+			// count significant digits, anything above 19 won't fit the mantissa
+			size_t leadingZeros = countLeadingZeros(integerDigits, integerDigitCount);
+			if (leadingZeros == integerDigitCount)
+			{
+				leadingZeros += countLeadingZeros(fractionDigits, fractionDigitCount);
+			}
+			if ((digitCount - leadingZeros) > 19)
+			{
+				return parseFloatFallback(cursor, end, scan, value);
+			}
+			mantissa = accumulateDigits(integerDigits, integerDigitCount, 0);
+			mantissa = accumulateDigits(fractionDigits, fractionDigitCount, mantissa);
+		}
+		exponent -= (int)fractionDigitCount;
+		if (mantissa == 0)
+		{
+			value = negative ? -0.0f : 0.0f;
+			cursor = scan;
+			return true;
+		}
+
+		// NOTE: With a mantissa of at most 2^53 and an exponent of at most 22, both operands are exact
+		//       doubles, so the product/quotient is correctly rounded to double precision
+		if ((mantissa > (1ULL << 53)) || (exponent < -22) || (exponent > 22))
+		{
+			return parseFloatFallback(cursor, end, scan, value);
+		}
+		double result = (double)mantissa;
+		result = (exponent < 0) ? (result / powersOfTen[-exponent]) : (result * powersOfTen[exponent]);
+
+		// NOTE: Rounding that double to float only goes wrong when it lands exactly on a float rounding
+		//       midpoint (low 29 mantissa bits equal to 1 followed by zeros), so only those need strtof
+		unsigned long long resultBits;
+		memcpy(&resultBits, &result, sizeof(result));
+		if ((resultBits & 0x1FFFFFFFULL) == 0x10000000ULL)
+		{
+			return parseFloatFallback(cursor, end, scan, value);
+		}
+		value = (float)(negative ? -result : result);
+		cursor = scan;
+		return true;
+	}
+
+	bool parseInteger(const char*& cursor, const char* end, int& value)
+	{
+		const char* scan = cursor;
+		// sign
+		bool negative = false;
+		if ((scan < end) && ((*scan == '-') || (*scan == '+')))
+		{
+			negative = (*scan == '-');
+			scan++;
+		}
+		// digits (indices are short, so a plain loop beats any setup cost here)
+		const char* digitStart = scan;
+		long long magnitude = 0;
+		while ((scan < end) && isDigit(*scan))
+		{
+			magnitude = (magnitude * 10) + (*scan - '0');
+			if (magnitude > INT_MAX)
+			{
+				magnitude = INT_MAX;
+			}
+			scan++;
+		}
+		if (scan == digitStart)
+		{
+			return false;
+		}
+		value = negative ? -(int)magnitude : (int)magnitude;
+		cursor = scan;
+		return true;
+	}
+
+	int parseIndexGroup(const char*& cursor, const char* end, int indices[3])
+	{
+		indices[0] = indices[1] = indices[2] = 0;
+
+#ifdef NUMPARSE_SSE2
+		// NOTE: Classify the whole group at once, then every field boundary comes straight out of the
+		//       digit and separator masks. Groups with signs or very long fields take the scalar path
+		// NOTE: Two blocks are classified, since groups like "10000/10000/10000" don't fit in one
+		if ((end - cursor) >= 40)
+		{
+			__m128i lowBlock = _mm_loadu_si128((const __m128i*)cursor);
+			__m128i highBlock = _mm_loadu_si128((const __m128i*)(cursor + 16));
+			__m128i slash = _mm_set1_epi8('/');
+			unsigned long long digits = digitMask(lowBlock) | ((unsigned long long)digitMask(highBlock) << 16);
+			unsigned long long slashes = (unsigned long long)_mm_movemask_epi8(_mm_cmpeq_epi8(lowBlock, slash)) |
+				((unsigned long long)_mm_movemask_epi8(_mm_cmpeq_epi8(highBlock, slash)) << 16);
+			unsigned groupLength = trailingZeros64(~(digits | slashes));
+			if (groupLength < 32)
+			{
+				unsigned position = 0;
+				int fieldCount = 0;
+				bool simpleGroup = true;
+				while (fieldCount < 3)
+				{
+					unsigned fieldLength = trailingZeros64(~(digits >> position));
+					if (fieldLength > 8)
+					{
+						simpleGroup = false;
+						break;
+					}
+					if ((fieldCount == 0) && (fieldLength == 0))
+					{
+						break;
+					}
+					indices[fieldCount] = (fieldLength > 0) ? (int)parseShortDigits(cursor + position, fieldLength) : 0;
+					position += fieldLength;
+					fieldCount++;
+					if ((position >= groupLength) || (cursor[position] != '/') || (fieldCount == 3))
+					{
+						break;
+					}
+					position++;
+				}
+				if (simpleGroup && ((cursor[groupLength] != '-') && (cursor[groupLength] != '+')))
+				{
+					cursor += groupLength;
+					return fieldCount;
+				}
+				indices[0] = indices[1] = indices[2] = 0;
+			}
+		}
+#endif
+
+		// find the extent of the group (digits, signs and '/' separators)
+		const char* groupEnd = cursor;
+		while ((groupEnd < end) && (isDigit(*groupEnd) || (*groupEnd == '/') || (*groupEnd == '-') || (*groupEnd == '+')))
+		{
+			groupEnd++;
+		}
+
+		// split fields at the separators
+		if (!parseInteger(cursor, groupEnd, indices[0]))
+		{
+			cursor = groupEnd;
+			return 0;
+		}
+		int fieldCount = 1;
+		while ((fieldCount < 3) && (cursor < groupEnd) && (*cursor == '/'))
+		{
+			cursor++;
+			parseInteger(cursor, groupEnd, indices[fieldCount]);
+			fieldCount++;
+		}
+		cursor = groupEnd;
+		return fieldCount;
+	}
+}
@@ -0,0 +1,31 @@
+//// Declaration Guards
+#ifndef NUM_PARSE_H
+#define NUM_PARSE_H
+
+//// Imports
+#include <stddef.h>
+
+namespace SWPTAS001
+{
+	//// Number Parsing Routines
+	size_t countDigits(const char* cursor, const char* end);
+	bool parseFloat(const char*& cursor, const char* end, float& value);
+	bool parseInteger(const char*& cursor, const char* end, int& value);
+	int parseIndexGroup(const char*& cursor, const char* end, int indices[3]);
+}
+
+#endif
+
+// NOTE: All routines parse from cursor (without skipping leading whitespace), advance it past whatever
+//       they consumed and never read at or beyond end. Nothing here is locale-aware: the decimal point
+//       is always '.', regardless of the C or C++ locale
+// NOTE: parseFloat() is correctly rounded. Numbers with up to 19 significant digits and a decimal
+//       exponent within +-22 (i.e. practically everything an exporter writes) are converted exactly in
+//       double precision and then rounded once to float. The rare remaining cases, and the rare double
+//       results sitting exactly on a float rounding midpoint, fall back to strtof() on a bounded copy
+// NOTE: parseIndexGroup() reads an OBJ face corner ("v", "v/vt", "v//vn" or "v/vt/vn"), stores 0 for
+//       any missing field and returns the number of '/' separated fields seen (0 if there was no
+//       vertex index at all)
+// NOTE: When compiled with SSE2, digit runs and group delimiters are classified 16 bytes at a time,
+//       and runs of 8 or more digits are converted 8 digits at a time. The 8 digit conversion assumes
+//       a little-endian target, which covers every platform we build for
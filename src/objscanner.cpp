@@ -0,0 +1,374 @@
+//// Header
+#include "objscanner.h"
+
+//// Imports
+#include <iostream>
+#include <string.h>
+#include "numparse.h"
+#include "parallel.h"
+
+//// Namespaces
+using namespace std;
+
+namespace SWPTAS001
+{
+	/////////////////////
+	// Scanner Helpers //
+	/////////////////////
+
+	static inline bool isBlank(char c)
+	{
+		return (c == ' ') || (c == '\t') || (c == '\r');
+	}
+
+	static inline void skipBlanks(const char*& cursor, const char* end)
+	{
+		while ((cursor < end) && isBlank(*cursor))
+		{
+			cursor++;
+		}
+	}
+
+	static inline void skipLine(const char*& cursor, const char* end)
+	{
+		const char* newline = (const char*)memchr(cursor, '\n', end - cursor);
+		cursor = newline ? (newline + 1) : end;
+	}
+
+	static inline bool parseFloatField(const char*& cursor, const char* end, float& value)
+	{
+		skipBlanks(cursor, end);
+		return parseFloat(cursor, end, value);
+	}
+
+	static inline int resolveIndex(int objIndex, size_t definedCount)
+	{
+		// NOTE: OBJ indices are 1-based, and negative indices are relative to the end of the data
+		//       defined so far, anything else (0 or missing) is reported as -1
+		if (objIndex > 0)
+		{
+			return objIndex - 1;
+		}
+		else if (objIndex < 0)
+		{
+			return (int)definedCount + objIndex;
+		}
+		return -1;
+	}
+
+	static inline OBJDataType classifyRecord(const char* cursor, const char* end)
+	{
+		char typeChar1 = *cursor;
+		char typeChar2 = ((cursor + 1) < end) ? cursor[1] : '\n';
+		if (typeChar1 == '#')
+		{
+			return COMMENT;
+		}
+		else if (typeChar1 == 'f')
+		{
+			return FACE;
+		}
+		else if (typeChar1 == 'v')
+		{
+			if ((typeChar2 == ' ') || (typeChar2 == '\t'))
+			{
+				return VERTEX;
+			}
+			else if (typeChar2 == 't')
+			{
+				return TEXTURECOORD;
+			}
+			else if (typeChar2 == 'n')
+			{
+				return NORMAL;
+			}
+		}
+		return NONE;
+	}
+
+	static void reportUnsupportedRecord(const char* cursor, const char* end)
+	{
+		if (*cursor != 'v')
+		{
+			cout << "OBJ parse error: Expected 'v', 'f' or '#' at the start of the line" << endl;
+			cout << "Found: " << string(cursor, ((cursor + 2) < end) ? 2 : (end - cursor)) << endl;
+		}
+		else if (((cursor + 1) < end) && (cursor[1] == 'p'))
+		{
+			cout << "OBJ parse error: Free-form geometry is not supported, ignoring" << endl;
+		}
+		else
+		{
+			cout << "Unsupported data entry v" << (((cursor + 1) < end) ? cursor[1] : ' ') << ", ignoring" << endl;
+		}
+	}
+
+	///////////////////////
+	// Scanning Routines //
+	///////////////////////
+
+	void countOBJRecords(const char* begin, const char* end, OBJRecordCounts& counts)
+	{
+		counts = OBJRecordCounts();
+		findOBJBatchEnd(begin, end, (size_t)-1, counts);
+	}
+
+	const char* findOBJBatchEnd(const char* begin, const char* end, size_t maximumFaces, OBJRecordCounts& counts)
+	{
+		size_t faceCount = 0;
+		const char* cursor = begin;
+		while ((cursor < end) && (faceCount < maximumFaces))
+		{
+			skipBlanks(cursor, end);
+			if (cursor >= end)
+			{
+				break;
+			}
+			switch (classifyRecord(cursor, end))
+			{
+				case VERTEX: counts.vertices++; break;
+				case TEXTURECOORD: counts.textureCoords++; break;
+				case NORMAL: counts.normals++; break;
+				case FACE: counts.faces++; faceCount++; break;
+				default: break;
+			}
+			skipLine(cursor, end);
+		}
+		return cursor;
+	}
+
+	struct OBJChunkResult
+	{
+		size_t faces;
+		size_t droppedFaces;
+		size_t texturedFaces;
+		size_t normalFaces;
+	};
+
+	static void scanOBJChunk(const char* begin, const char* end, OBJRawData& output, const OBJRecordCounts& base,
+		const OBJRecordCounts& origin, int recordMask, OBJChunkResult& result)
+	{
+		// NOTE: Each chunk writes into its own pre-counted slice of the output arrays, starting at
+		//       the prefix-summed record counts of every chunk before it
+		bool storePools = (recordMask & POOL_RECORDS) != 0;
+		bool storeFaces = (recordMask & FACE_RECORDS) != 0;
+		size_t vertexCursor = base.vertices;
+		size_t textureCoordCursor = base.textureCoords;
+		size_t normalCursor = base.normals;
+		size_t faceCursor = base.faces;
+		result = OBJChunkResult();
+
+		const char* cursor = begin;
+		while (cursor < end)
+		{
+			skipBlanks(cursor, end);
+			if (cursor >= end)
+			{
+				break;
+			}
+			if (*cursor == '\n')
+			{
+				cursor++;
+				continue;
+			}
+
+			switch (classifyRecord(cursor, end))
+			{
+			case VERTEX:
+			{
+				if (!storePools)
+				{
+					vertexCursor++;
+					break;
+				}
+				// NOTE: Missing fields are left at 0 so that vertex numbering always matches line order
+				float* vertex = &output.vertices[3 * vertexCursor++];
+				vertex[0] = vertex[1] = vertex[2] = 0.0f;
+				cursor += 1;
+				parseFloatField(cursor, end, vertex[0]);
+				parseFloatField(cursor, end, vertex[1]);
+				parseFloatField(cursor, end, vertex[2]);
+			} break;
+
+			case TEXTURECOORD:
+			{
+				if (!storePools)
+				{
+					textureCoordCursor++;
+					break;
+				}
+				float* textureCoord = &output.textureCoords[2 * textureCoordCursor++];
+				textureCoord[0] = textureCoord[1] = 0.0f;
+				cursor += 2;
+				parseFloatField(cursor, end, textureCoord[0]);
+				parseFloatField(cursor, end, textureCoord[1]);
+			} break;
+
+			case NORMAL:
+			{
+				if (!storePools)
+				{
+					normalCursor++;
+					break;
+				}
+				float* normal = &output.normals[3 * normalCursor++];
+				normal[0] = normal[1] = normal[2] = 0.0f;
+				cursor += 2;
+				parseFloatField(cursor, end, normal[0]);
+				parseFloatField(cursor, end, normal[1]);
+				parseFloatField(cursor, end, normal[2]);
+			} break;
+
+			case FACE:
+			{
+				// NOTE: Here is where we assume that exactly 3 vertices are used to specify a face
+				FaceData face = {};
+				bool validFace = true;
+				cursor += 1;
+				for (int index = 0; index < 3; index++)
+				{
+					int groupIndices[3];
+					skipBlanks(cursor, end);
+					if (parseIndexGroup(cursor, end, groupIndices) == 0)
+					{
+						validFace = false;
+						break;
+					}
+
+					face.vertexIndex[index] = resolveIndex(groupIndices[0], origin.vertices + vertexCursor);
+					face.texCoordIndex[index] = resolveIndex(groupIndices[1], origin.textureCoords + textureCoordCursor);
+					face.normalIndex[index] = resolveIndex(groupIndices[2], origin.normals + normalCursor);
+				}
+
+				if (validFace)
+				{
+					if (storeFaces)
+					{
+						output.faces[faceCursor] = face;
+					}
+					faceCursor++;
+					result.texturedFaces += (face.texCoordIndex[0] >= 0);
+					result.normalFaces += (face.normalIndex[0] >= 0);
+				}
+				else
+				{
+					result.droppedFaces++;
+				}
+			} break;
+
+			case COMMENT:
+			{} break;
+
+			default:
+			{
+				// NOTE: Only the pass storing the pools reports these, so streamed files report them once
+				if (storePools)
+				{
+					reportUnsupportedRecord(cursor, end);
+				}
+			}
+			}
+
+			skipLine(cursor, end);
+		}
+
+		result.faces = faceCursor - base.faces;
+	}
+
+	static void splitOBJChunks(const char* begin, const char* end, size_t chunkCount, vector<const char*>& boundaries)
+	{
+		// NOTE: Chunks are cut at newline boundaries, so no record is ever split between two chunks
+		boundaries.resize(chunkCount + 1);
+		boundaries[0] = begin;
+		size_t totalSize = end - begin;
+		for (size_t chunkIndex = 1; chunkIndex < chunkCount; chunkIndex++)
+		{
+			const char* cursor = begin + ((totalSize * chunkIndex) / chunkCount);
+			if (cursor < boundaries[chunkIndex - 1])
+			{
+				cursor = boundaries[chunkIndex - 1];
+			}
+			skipLine(cursor, end);
+			boundaries[chunkIndex] = cursor;
+		}
+		boundaries[chunkCount] = end;
+	}
+
+	size_t parseOBJRecords(const char* begin, const char* end, OBJRawData& output, OBJRecordCounts& counts, int threadCount,
+		int recordMask, const OBJRecordCounts& origin)
+	{
+		// NOTE: Small files aren't worth waking up extra threads for
+		const size_t minimumChunkSize = 1 << 20;
+
+		// split
+		size_t chunkCount = (size_t)resolveThreadCount(threadCount);
+		size_t maximumChunks = ((end - begin) / minimumChunkSize) + 1;
+		if (chunkCount > maximumChunks)
+		{
+			chunkCount = maximumChunks;
+		}
+		vector<const char*> boundaries;
+		splitOBJChunks(begin, end, chunkCount, boundaries);
+
+		// count records per chunk
+		vector<OBJRecordCounts> chunkCounts(chunkCount);
+		parallelFor(chunkCount, threadCount, [&](size_t chunkIndex)
+		{
+			countOBJRecords(boundaries[chunkIndex], boundaries[chunkIndex + 1], chunkCounts[chunkIndex]);
+		});
+
+		// prefix sum the counts into per-chunk write offsets
+		vector<OBJRecordCounts> chunkOffsets(chunkCount);
+		OBJRecordCounts totals = {};
+		for (size_t chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++)
+		{
+			chunkOffsets[chunkIndex] = totals;
+			totals.vertices += chunkCounts[chunkIndex].vertices;
+			totals.textureCoords += chunkCounts[chunkIndex].textureCoords;
+			totals.normals += chunkCounts[chunkIndex].normals;
+			totals.faces += chunkCounts[chunkIndex].faces;
+		}
+		counts = totals;
+
+		// size every selected array exactly once
+		bool storePools = (recordMask & POOL_RECORDS) != 0;
+		bool storeFaces = (recordMask & FACE_RECORDS) != 0;
+		output.vertices.resize(storePools ? totals.vertices * 3 : 0);
+		output.textureCoords.resize(storePools ? totals.textureCoords * 2 : 0);
+		output.normals.resize(storePools ? totals.normals * 3 : 0);
+		output.faces.resize(storeFaces ? totals.faces : 0);
+
+		// scan chunks
+		vector<OBJChunkResult> chunkResults(chunkCount);
+		parallelFor(chunkCount, threadCount, [&](size_t chunkIndex)
+		{
+			scanOBJChunk(boundaries[chunkIndex], boundaries[chunkIndex + 1], output, chunkOffsets[chunkIndex], origin,
+				recordMask, chunkResults[chunkIndex]);
+		});
+
+		// close any gaps left by dropped faces, keeping the serial face order
+		size_t faceCursor = 0;
+		size_t droppedFaces = 0;
+		for (size_t chunkIndex = 0; chunkIndex < chunkCount; chunkIndex++)
+		{
+			size_t chunkFaces = chunkResults[chunkIndex].faces;
+			if (storeFaces && (faceCursor != chunkOffsets[chunkIndex].faces) && (chunkFaces > 0))
+			{
+				memmove(&output.faces[faceCursor], &output.faces[chunkOffsets[chunkIndex].faces], chunkFaces * sizeof(FaceData));
+			}
+			faceCursor += chunkFaces;
+			droppedFaces += chunkResults[chunkIndex].droppedFaces;
+			counts.texturedFaces += chunkResults[chunkIndex].texturedFaces;
+			counts.normalFaces += chunkResults[chunkIndex].normalFaces;
+		}
+		if ((droppedFaces > 0) && storePools)
+		{
+			cout << "OBJ parse error: Ignored " << droppedFaces << " faces with fewer than 3 vertices" << endl;
+		}
+
+		// NOTE: Shrinking never reallocates, so the arrays are still only ever sized once
+		output.faces.resize(storeFaces ? faceCursor : 0);
+		counts.faces = faceCursor;
+		return chunkCount;
+	}
+}
@@ -0,0 +1,61 @@
+//// Declaration Guards
+#ifndef OBJ_SCANNER_H
+#define OBJ_SCANNER_H
+
+//// Imports
+#include <vector>
+#include <stddef.h>
+#include "geometry.h"
+#include "arena.h"
+
+namespace SWPTAS001
+{
+	//// Enumerations
+	enum OBJRecordMask { POOL_RECORDS = 1, FACE_RECORDS = 2, ALL_RECORDS = POOL_RECORDS | FACE_RECORDS };
+
+	//// Structures
+	struct OBJRecordCounts
+	{
+		size_t vertices;
+		size_t textureCoords;
+		size_t normals;
+		size_t faces;
+		size_t texturedFaces;
+		size_t normalFaces;
+	};
+
+	struct OBJRawData
+	{
+		OBJRawData(MemoryArena* arena = NULL) : vertices(arena), textureCoords(arena), normals(arena), faces(arena) {}
+		ArenaVector<float> vertices;
+		ArenaVector<float> textureCoords;
+		ArenaVector<float> normals;
+		ArenaVector<FaceData> faces;
+	};
+
+	//// Scanning Routines
+	void countOBJRecords(const char* begin, const char* end, OBJRecordCounts& counts);
+	size_t parseOBJRecords(const char* begin, const char* end, OBJRawData& output, OBJRecordCounts& counts, int threadCount,
+		int recordMask = ALL_RECORDS, const OBJRecordCounts& origin = OBJRecordCounts());
+	const char* findOBJBatchEnd(const char* begin, const char* end, size_t maximumFaces, OBJRecordCounts& counts);
+}
+
+#endif
+
+// NOTE: The scanner works directly on a [begin, end) byte range (usually a MappedFile) with
+//       forward-moving pointers, and never reads past end. countOBJRecords() is a cheap pre-pass that
+//       only inspects the first two bytes of each line, so that the raw arrays can be sized exactly
+//       once before they are filled in
+// NOTE: parseOBJRecords() splits the range into per-thread chunks at newline boundaries, counts each
+//       chunk, prefix-sums the counts into write offsets and then scans every chunk straight into its
+//       own slice of the output. The result is identical to a serial scan for any thread count, and the
+//       number of chunks actually used is returned. On return, counts.faces holds the number of
+//       faces actually kept (faces with fewer than 3 vertices are dropped), and texturedFaces and
+//       normalFaces how many of those reference texture coordinates and normals
+// NOTE: recordMask selects which records are stored, the others are still counted (and faces still
+//       validated) but their arrays are left empty. This lets a streaming loader gather just the
+//       v/vt/vn pools in one pass and then parse the faces in bounded batches. origin holds the number
+//       of v/vt/vn records before begin, so that faces in a batch still resolve to global indices
+// NOTE: findOBJBatchEnd() returns the end of the line holding the maximumFaces'th face after begin (or
+//       end), and adds every record it walked over to counts, which makes counts the origin of the
+//       next batch
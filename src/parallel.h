@@ -0,0 +1,74 @@
+//// Declaration Guards
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+//// Imports
+#include <thread>
+#include <vector>
+#include <stddef.h>
+
+namespace SWPTAS001
+{
+	//// Utilities
+
+	// Resolves a requested thread count, where anything below 1 means "use every core"
+	inline int resolveThreadCount(int requestedThreads)
+	{
+		if (requestedThreads > 0)
+		{
+			return requestedThreads;
+		}
+		int hardwareThreads = (int)std::thread::hardware_concurrency();
+		return (hardwareThreads > 0) ? hardwareThreads : 1;
+	}
+
+	// Runs task(taskIndex) for every task in [0, taskCount) across up to threadCount threads,
+	// with the calling thread taking part. Tasks are handed out in contiguous blocks, so
+	// the assignment is deterministic for a given task and thread count
+	template <typename Task>
+	void parallelFor(size_t taskCount, int threadCount, Task task)
+	{
+		// initialize
+		size_t workerCount = (size_t)resolveThreadCount(threadCount);
+		if (workerCount > taskCount)
+		{
+			workerCount = taskCount;
+		}
+		if (workerCount <= 1)
+		{
+			for (size_t taskIndex = 0; taskIndex < taskCount; taskIndex++)
+			{
+				task(taskIndex);
+			}
+			return;
+		}
+		// launch workers
+		std::vector<std::thread> workers;
+		workers.reserve(workerCount - 1);
+		for (size_t workerIndex = 1; workerIndex < workerCount; workerIndex++)
+		{
+			size_t blockStart = (taskCount * workerIndex) / workerCount;
+			size_t blockEnd = (taskCount * (workerIndex + 1)) / workerCount;
+			workers.push_back(std::thread([=, &task]()
+			{
+				for (size_t taskIndex = blockStart; taskIndex < blockEnd; taskIndex++)
+				{
+					task(taskIndex);
+				}
+			}));
+		}
+		// the calling thread takes the first block
+		size_t firstBlockEnd = taskCount / workerCount;
+		for (size_t taskIndex = 0; taskIndex < firstBlockEnd; taskIndex++)
+		{
+			task(taskIndex);
+		}
+		// done
+		for (size_t workerIndex = 0; workerIndex < workers.size(); workerIndex++)
+		{
+			workers[workerIndex].join();
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,252 @@
+//// Header
+#include "quantize.h"
+
+//// Imports
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+//// Namespaces
+using namespace std;
+
+namespace SWPTAS001
+{
+	///////////////////////////
+	// Quantization Routines //
+	///////////////////////////
+
+	unsigned short quantizeUnorm16(float value, float minimum, float extent)
+	{
+		if (extent <= 0.0f)
+		{
+			return 0;
+		}
+		float normalized = (value - minimum) / extent;
+		normalized = (normalized < 0.0f) ? 0.0f : ((normalized > 1.0f) ? 1.0f : normalized);
+		return (unsigned short)floorf((normalized * 65535.0f) + 0.5f);
+	}
+
+	float dequantizeUnorm16(unsigned short value, float minimum, float extent)
+	{
+		return minimum + ((value / 65535.0f) * extent);
+	}
+
+	unsigned short floatToHalf(float value)
+	{
+		unsigned int bits;
+		memcpy(&bits, &value, sizeof(float));
+		unsigned int sign = (bits >> 16) & 0x8000;
+		unsigned int magnitude = bits & 0x7FFFFFFF;
+
+		// NaN and infinity
+		if (magnitude >= 0x7F800000)
+		{
+			return (unsigned short)(sign | 0x7C00 | ((magnitude > 0x7F800000) ? 0x0200 : 0));
+		}
+		// too large, round to infinity
+		if (magnitude >= 0x477FF000)
+		{
+			return (unsigned short)(sign | 0x7C00);
+		}
+		// too small even for a half denormal, round to zero
+		if (magnitude < 0x33000000)
+		{
+			return (unsigned short)sign;
+		}
+		// half denormals: shift the mantissa (with its implicit 1) into place, rounding to nearest even
+		int exponent = (int)(magnitude >> 23);
+		if (exponent < 113)
+		{
+			unsigned int mantissa = (magnitude & 0x007FFFFF) | 0x00800000;
+			int shift = 126 - exponent;
+			unsigned int result = mantissa >> shift;
+			unsigned int remainder = mantissa & ((1u << shift) - 1);
+			unsigned int halfway = 1u << (shift - 1);
+			if ((remainder > halfway) || ((remainder == halfway) && (result & 1)))
+			{
+				result++;
+			}
+			return (unsigned short)(sign | result);
+		}
+		// normal halves: rebias the exponent and round the mantissa, letting a carry bump the exponent
+		unsigned int result = (magnitude - 0x38000000) >> 13;
+		unsigned int remainder = magnitude & 0x1FFF;
+		if ((remainder > 0x1000) || ((remainder == 0x1000) && (result & 1)))
+		{
+			result++;
+		}
+		return (unsigned short)(sign | result);
+	}
+
+	float halfToFloat(unsigned short value)
+	{
+		unsigned int sign = (unsigned int)(value & 0x8000) << 16;
+		unsigned int exponent = (value >> 10) & 0x1F;
+		unsigned int mantissa = value & 0x03FF;
+		float result;
+		if (exponent == 0)
+		{
+			result = ldexpf((float)mantissa, -24);
+		}
+		else if (exponent == 31)
+		{
+			result = mantissa ? NAN : INFINITY;
+		}
+		else
+		{
+			unsigned int bits = ((exponent + 112) << 23) | (mantissa << 13);
+			memcpy(&result, &bits, sizeof(float));
+		}
+		return sign ? -result : result;
+	}
+
+	unsigned int packSnorm1010102(const float vector[3])
+	{
+		unsigned int packed = 0;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			float component = (vector[axis] < -1.0f) ? -1.0f : ((vector[axis] > 1.0f) ? 1.0f : vector[axis]);
+			int quantized = (int)floorf((component * 511.0f) + 0.5f);
+			packed |= ((unsigned int)quantized & 0x3FF) << (10 * axis);
+		}
+		return packed;
+	}
+
+	void unpackSnorm1010102(unsigned int packed, float vector[3])
+	{
+		for (int axis = 0; axis < 3; axis++)
+		{
+			// sign extend the 10-bit field
+			int quantized = (int)((packed >> (10 * axis)) & 0x3FF);
+			quantized = (quantized & 0x200) ? (quantized - 1024) : quantized;
+			float component = quantized / 511.0f;
+			vector[axis] = (component < -1.0f) ? -1.0f : component;
+		}
+	}
+
+	short quantizeSnorm16(float value)
+	{
+		float component = (value < -1.0f) ? -1.0f : ((value > 1.0f) ? 1.0f : value);
+		return (short)floorf((component * 32767.0f) + 0.5f);
+	}
+
+	void packQTangent(const float normal[3], const float tangent[3], const float bitangent[3], short quaternion[4])
+	{
+		// orthonormalize the frame, keeping the bitangent only for its handedness
+		float n[3] = {normal[0], normal[1], normal[2]};
+		float nLength = sqrtf((n[0] * n[0]) + (n[1] * n[1]) + (n[2] * n[2]));
+		if (nLength <= 0.0f)
+		{
+			n[0] = 0.0f;
+			n[1] = 0.0f;
+			n[2] = 1.0f;
+			nLength = 1.0f;
+		}
+		for (int axis = 0; axis < 3; axis++)
+		{
+			n[axis] /= nLength;
+		}
+		float tangentDot = (tangent[0] * n[0]) + (tangent[1] * n[1]) + (tangent[2] * n[2]);
+		float t[3] = {tangent[0] - (n[0] * tangentDot), tangent[1] - (n[1] * tangentDot), tangent[2] - (n[2] * tangentDot)};
+		float tLength = sqrtf((t[0] * t[0]) + (t[1] * t[1]) + (t[2] * t[2]));
+		if (tLength <= 1e-12f)
+		{
+			// any direction perpendicular to the normal
+			bool useX = fabsf(n[0]) < 0.9f;
+			t[0] = useX ? (1.0f - (n[0] * n[0])) : (-n[1] * n[0]);
+			t[1] = useX ? (-n[0] * n[1]) : (1.0f - (n[1] * n[1]));
+			t[2] = useX ? (-n[0] * n[2]) : (-n[1] * n[2]);
+			tLength = sqrtf((t[0] * t[0]) + (t[1] * t[1]) + (t[2] * t[2]));
+		}
+		for (int axis = 0; axis < 3; axis++)
+		{
+			t[axis] /= tLength;
+		}
+		float b[3] = {(n[1] * t[2]) - (n[2] * t[1]), (n[2] * t[0]) - (n[0] * t[2]), (n[0] * t[1]) - (n[1] * t[0])};
+		bool mirrored = ((bitangent[0] * b[0]) + (bitangent[1] * b[1]) + (bitangent[2] * b[2])) < 0.0f;
+
+		// rotation matrix with columns t, b, n to quaternion (largest component first, for accuracy)
+		float q[4]; // x, y, z, w
+		float trace = t[0] + b[1] + n[2];
+		if (trace > 0.0f)
+		{
+			float scale = sqrtf(trace + 1.0f) * 2.0f;
+			q[3] = 0.25f * scale;
+			q[0] = (b[2] - n[1]) / scale;
+			q[1] = (n[0] - t[2]) / scale;
+			q[2] = (t[1] - b[0]) / scale;
+		}
+		else if ((t[0] > b[1]) && (t[0] > n[2]))
+		{
+			float scale = sqrtf(1.0f + t[0] - b[1] - n[2]) * 2.0f;
+			q[3] = (b[2] - n[1]) / scale;
+			q[0] = 0.25f * scale;
+			q[1] = (b[0] + t[1]) / scale;
+			q[2] = (n[0] + t[2]) / scale;
+		}
+		else if (b[1] > n[2])
+		{
+			float scale = sqrtf(1.0f + b[1] - t[0] - n[2]) * 2.0f;
+			q[3] = (n[0] - t[2]) / scale;
+			q[0] = (b[0] + t[1]) / scale;
+			q[1] = 0.25f * scale;
+			q[2] = (n[1] + b[2]) / scale;
+		}
+		else
+		{
+			float scale = sqrtf(1.0f + n[2] - t[0] - b[1]) * 2.0f;
+			q[3] = (t[1] - b[0]) / scale;
+			q[0] = (n[0] + t[2]) / scale;
+			q[1] = (n[1] + b[2]) / scale;
+			q[2] = 0.25f * scale;
+		}
+		float qLength = sqrtf((q[0] * q[0]) + (q[1] * q[1]) + (q[2] * q[2]) + (q[3] * q[3]));
+		float qSign = (q[3] < 0.0f) ? -1.0f : 1.0f;
+		for (int component = 0; component < 4; component++)
+		{
+			q[component] *= qSign / qLength;
+		}
+
+		// NOTE: q and -q are the same rotation, so the sign of w is free to hold the handedness. w is kept
+		//       at least one step away from 0, or -0 would quantize to +0 and lose it
+		const float minimumW = 1.0f / 32767.0f;
+		if (q[3] < minimumW)
+		{
+			float rescale = sqrtf(1.0f - (minimumW * minimumW)) / sqrtf(max(1e-24f, (q[0] * q[0]) + (q[1] * q[1]) + (q[2] * q[2])));
+			for (int component = 0; component < 3; component++)
+			{
+				q[component] *= rescale;
+			}
+			q[3] = minimumW;
+		}
+		for (int component = 0; component < 4; component++)
+		{
+			quaternion[component] = quantizeSnorm16(mirrored ? -q[component] : q[component]);
+		}
+	}
+
+	void unpackQTangent(const short quaternion[4], float normal[3], float tangent[3], float bitangent[3])
+	{
+		// same decode as phong.vert
+		float q[4];
+		for (int component = 0; component < 4; component++)
+		{
+			q[component] = max(quaternion[component] / 32767.0f, -1.0f);
+		}
+		float qLength = sqrtf((q[0] * q[0]) + (q[1] * q[1]) + (q[2] * q[2]) + (q[3] * q[3]));
+		for (int component = 0; component < 4; component++)
+		{
+			q[component] /= qLength;
+		}
+		float handedness = (q[3] < 0.0f) ? -1.0f : 1.0f;
+		tangent[0] = 1.0f - (2.0f * ((q[1] * q[1]) + (q[2] * q[2])));
+		tangent[1] = 2.0f * ((q[0] * q[1]) + (q[3] * q[2]));
+		tangent[2] = 2.0f * ((q[0] * q[2]) - (q[3] * q[1]));
+		bitangent[0] = handedness * 2.0f * ((q[0] * q[1]) - (q[3] * q[2]));
+		bitangent[1] = handedness * (1.0f - (2.0f * ((q[0] * q[0]) + (q[2] * q[2]))));
+		bitangent[2] = handedness * 2.0f * ((q[1] * q[2]) + (q[3] * q[0]));
+		normal[0] = 2.0f * ((q[0] * q[2]) + (q[3] * q[1]));
+		normal[1] = 2.0f * ((q[1] * q[2]) - (q[3] * q[0]));
+		normal[2] = 1.0f - (2.0f * ((q[0] * q[0]) + (q[1] * q[1])));
+	}
+}
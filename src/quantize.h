@@ -0,0 +1,35 @@
+//// Declaration Guards
+#ifndef QUANTIZE_H
+#define QUANTIZE_H
+
+//// Imports
+#include <stddef.h>
+
+namespace SWPTAS001
+{
+	//// Quantization Routines
+	unsigned short quantizeUnorm16(float value, float minimum, float extent);
+	float dequantizeUnorm16(unsigned short value, float minimum, float extent);
+	unsigned short floatToHalf(float value);
+	float halfToFloat(unsigned short value);
+	unsigned int packSnorm1010102(const float vector[3]);
+	void unpackSnorm1010102(unsigned int packed, float vector[3]);
+	short quantizeSnorm16(float value);
+	void packQTangent(const float normal[3], const float tangent[3], const float bitangent[3], short quaternion[4]);
+	void unpackQTangent(const short quaternion[4], float normal[3], float tangent[3], float bitangent[3]);
+}
+
+#endif
+
+// NOTE: quantizeUnorm16() maps [minimum, minimum + extent] onto [0, 65535] with rounding, so the
+//       worst case position error is extent / 131070. A zero extent (flat axis) always encodes as 0
+// NOTE: floatToHalf() rounds to nearest even and handles denormals, infinities and NaN, which is what
+//       GL_HALF_FLOAT expects
+// NOTE: packSnorm1010102() writes x, y and z into the low 30 bits of a GL_INT_2_10_10_10_REV value as
+//       signed 10-bit integers scaled by 511, leaving w at 0. unpackSnorm1010102() decodes with the
+//       GL 4.2 rule (c / 511, clamped to -1), which is what current drivers use for every GL version
+// NOTE: packQTangent() encodes a whole tangent frame as one unit quaternion of 4 signed 16-bit values
+//       (a QTangent), the rotation taking x, y and z to the tangent, cross(normal, tangent) and the
+//       normal. The bitangent only contributes its handedness, which is stored in the sign of w. The
+//       frame is orthonormalized first, so the decoded bitangent is exactly cross(normal, tangent) times
+//       the handedness, which is how generateTangentFrames() builds it anyway
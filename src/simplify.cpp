@@ -0,0 +1,490 @@
+//// Header
+#include "simplify.h"
+
+//// Imports
+#include <vector>
+#include <algorithm>
+#include <string.h>
+#include <math.h>
+
+//// Namespaces
+using namespace std;
+
+namespace SWPTAS001
+{
+	//// Constants
+	static const unsigned int NO_VERTEX = 0xFFFFFFFF;
+	static const double BORDER_WEIGHT = 10.0;
+
+	//// Enumerations
+	enum VertexKind { MANIFOLD_VERTEX, BORDER_VERTEX, SEAM_VERTEX, LOCKED_VERTEX };
+
+	//// Structures
+	// Sum of squared distances to a set of planes, as the symmetric matrix A, the vector b and the scalar c
+	struct Quadric
+	{
+		double a00, a01, a02, a11, a12, a22;
+		double b0, b1, b2;
+		double c;
+		double weight;
+	};
+
+	struct Collapse
+	{
+		unsigned int source;
+		unsigned int target;
+		double cost;
+	};
+
+	/////////////
+	// Helpers //
+	/////////////
+
+	static void addPlaneQuadric(Quadric& quadric, double a, double b, double c, double d, double weight)
+	{
+		quadric.a00 += weight * a * a;
+		quadric.a01 += weight * a * b;
+		quadric.a02 += weight * a * c;
+		quadric.a11 += weight * b * b;
+		quadric.a12 += weight * b * c;
+		quadric.a22 += weight * c * c;
+		quadric.b0 += weight * a * d;
+		quadric.b1 += weight * b * d;
+		quadric.b2 += weight * c * d;
+		quadric.c += weight * d * d;
+		quadric.weight += weight;
+	}
+
+	static void addQuadric(Quadric& target, const Quadric& source)
+	{
+		target.a00 += source.a00;
+		target.a01 += source.a01;
+		target.a02 += source.a02;
+		target.a11 += source.a11;
+		target.a12 += source.a12;
+		target.a22 += source.a22;
+		target.b0 += source.b0;
+		target.b1 += source.b1;
+		target.b2 += source.b2;
+		target.c += source.c;
+		target.weight += source.weight;
+	}
+
+	// Weighted mean squared distance from the point to the quadric's planes
+	static double quadricError(const Quadric& quadric, const float* point)
+	{
+		double x = point[0];
+		double y = point[1];
+		double z = point[2];
+		double error = (quadric.a00 * x * x) + (quadric.a11 * y * y) + (quadric.a22 * z * z) +
+			(2.0 * ((quadric.a01 * x * y) + (quadric.a02 * x * z) + (quadric.a12 * y * z))) +
+			(2.0 * ((quadric.b0 * x) + (quadric.b1 * y) + (quadric.b2 * z))) + quadric.c;
+		return (quadric.weight > 0.0) ? (fabs(error) / quadric.weight) : 0.0;
+	}
+
+	static void triangleNormal(const float* position0, const float* position1, const float* position2, double* normal)
+	{
+		double edge1[3] = {position1[0] - position0[0], position1[1] - position0[1], position1[2] - position0[2]};
+		double edge2[3] = {position2[0] - position0[0], position2[1] - position0[1], position2[2] - position0[2]};
+		normal[0] = (edge1[1] * edge2[2]) - (edge1[2] * edge2[1]);
+		normal[1] = (edge1[2] * edge2[0]) - (edge1[0] * edge2[2]);
+		normal[2] = (edge1[0] * edge2[1]) - (edge1[1] * edge2[0]);
+	}
+
+	// Links every vertex to the next one with the same position, in a ring
+	static void buildPositionRings(const float* positions, size_t vertexCount, vector<unsigned int>& positionGroup,
+		vector<unsigned int>& nextTwin)
+	{
+		size_t capacity = 64;
+		while (capacity < (vertexCount * 2))
+		{
+			capacity *= 2;
+		}
+		vector<unsigned int> slots(capacity, NO_VERTEX);
+		positionGroup.resize(vertexCount);
+		nextTwin.resize(vertexCount);
+		for (size_t vertex = 0; vertex < vertexCount; vertex++)
+		{
+			const float* position = positions + (3 * vertex);
+			unsigned int bits[3];
+			memcpy(bits, position, sizeof(bits));
+			size_t slot = (((bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u)) * 2654435761u) & (capacity - 1);
+			while ((slots[slot] != NO_VERTEX) && (memcmp(positions + (3 * slots[slot]), position, 3 * sizeof(float)) != 0))
+			{
+				slot = (slot + 1) & (capacity - 1);
+			}
+			if (slots[slot] == NO_VERTEX)
+			{
+				slots[slot] = (unsigned int)vertex;
+				positionGroup[vertex] = (unsigned int)vertex;
+				nextTwin[vertex] = (unsigned int)vertex;
+			}
+			else
+			{
+				unsigned int first = slots[slot];
+				positionGroup[vertex] = first;
+				nextTwin[vertex] = nextTwin[first];
+				nextTwin[first] = (unsigned int)vertex;
+			}
+		}
+	}
+
+	// Builds the vertex -> triangle adjacency as a compressed list (offsets into triangleList)
+	static void buildAdjacency(const vector<unsigned int>& indices, size_t vertexCount, vector<unsigned int>& offsets,
+		vector<unsigned int>& triangleList)
+	{
+		offsets.assign(vertexCount + 1, 0);
+		for (size_t i = 0; i < indices.size(); i++)
+		{
+			offsets[indices[i] + 1]++;
+		}
+		for (size_t vertex = 0; vertex < vertexCount; vertex++)
+		{
+			offsets[vertex + 1] += offsets[vertex];
+		}
+		vector<unsigned int> cursors(offsets.begin(), offsets.end() - 1);
+		triangleList.resize(indices.size());
+		for (size_t i = 0; i < indices.size(); i++)
+		{
+			triangleList[cursors[indices[i]]++] = (unsigned int)(i / 3);
+		}
+	}
+
+	// Whether some triangle around from has the directed edge from -> to
+	static bool hasDirectedEdge(const vector<unsigned int>& indices, const vector<unsigned int>& offsets,
+		const vector<unsigned int>& triangleList, unsigned int from, unsigned int to)
+	{
+		for (unsigned int a = offsets[from]; a < offsets[from + 1]; a++)
+		{
+			const unsigned int* triangle = &indices[3 * triangleList[a]];
+			for (int corner = 0; corner < 3; corner++)
+			{
+				if ((triangle[corner] == from) && (triangle[(corner + 1) % 3] == to))
+				{
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	// Whether any twin of from has a directed edge to any twin of to
+	static bool hasPositionEdge(const vector<unsigned int>& indices, const vector<unsigned int>& offsets,
+		const vector<unsigned int>& triangleList, const vector<unsigned int>& nextTwin, unsigned int from, unsigned int to)
+	{
+		unsigned int fromTwin = from;
+		do
+		{
+			unsigned int toTwin = to;
+			do
+			{
+				if (hasDirectedEdge(indices, offsets, triangleList, fromTwin, toTwin))
+				{
+					return true;
+				}
+				toTwin = nextTwin[toTwin];
+			} while (toTwin != to);
+			fromTwin = nextTwin[fromTwin];
+		} while (fromTwin != from);
+		return false;
+	}
+
+	// Finds the twin of target that shares an edge with source, if there is one
+	static unsigned int findEdgeTwin(const vector<unsigned int>& indices, const vector<unsigned int>& offsets,
+		const vector<unsigned int>& triangleList, const vector<unsigned int>& nextTwin, unsigned int source, unsigned int target)
+	{
+		unsigned int twin = target;
+		do
+		{
+			if (hasDirectedEdge(indices, offsets, triangleList, source, twin) || hasDirectedEdge(indices, offsets, triangleList, twin, source))
+			{
+				return twin;
+			}
+			twin = nextTwin[twin];
+		} while (twin != target);
+		return NO_VERTEX;
+	}
+
+	// Whether moving source onto target keeps every surviving triangle around source facing the same way
+	static bool collapseKeepsOrientation(const vector<unsigned int>& indices, const vector<unsigned int>& offsets,
+		const vector<unsigned int>& triangleList, const float* positions, unsigned int source, unsigned int target)
+	{
+		for (unsigned int a = offsets[source]; a < offsets[source + 1]; a++)
+		{
+			const unsigned int* triangle = &indices[3 * triangleList[a]];
+			if ((triangle[0] == target) || (triangle[1] == target) || (triangle[2] == target))
+			{
+				continue;
+			}
+			const float* corners[3];
+			const float* movedCorners[3];
+			for (int corner = 0; corner < 3; corner++)
+			{
+				corners[corner] = positions + (3 * triangle[corner]);
+				movedCorners[corner] = positions + (3 * ((triangle[corner] == source) ? target : triangle[corner]));
+			}
+			double before[3];
+			double after[3];
+			triangleNormal(corners[0], corners[1], corners[2], before);
+			triangleNormal(movedCorners[0], movedCorners[1], movedCorners[2], after);
+			// NOTE: Also rejects collapses that squash a triangle into a sliver at right angles to itself
+			double beforeLength = sqrt((before[0] * before[0]) + (before[1] * before[1]) + (before[2] * before[2]));
+			double afterLength = sqrt((after[0] * after[0]) + (after[1] * after[1]) + (after[2] * after[2]));
+			double alignment = (before[0] * after[0]) + (before[1] * after[1]) + (before[2] * after[2]);
+			if (alignment <= (0.1 * beforeLength * afterLength))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/////////////////////////////
+	// Simplification Routines //
+	/////////////////////////////
+
+	size_t simplifyMesh(const unsigned int* indices, size_t indexCount, const float* positions, size_t vertexCount,
+		size_t targetIndexCount, unsigned int* destination, float& resultError)
+	{
+		// initialize
+		vector<unsigned int> current(indices, indices + indexCount);
+		vector<unsigned int> positionGroup;
+		vector<unsigned int> nextTwin;
+		buildPositionRings(positions, vertexCount, positionGroup, nextTwin);
+		vector<unsigned int> adjacencyOffsets;
+		vector<unsigned int> adjacentTriangles;
+		buildAdjacency(current, vertexCount, adjacencyOffsets, adjacentTriangles);
+		double maximumCost = 0.0;
+
+		// classify vertices by their open (single triangle) edges
+		// NOTE: An edge that is open between vertices, but closed between their positions, is a seam
+		vector<unsigned char> kinds(vertexCount, MANIFOLD_VERTEX);
+		vector<unsigned char> openEdges(vertexCount, 0);
+		vector<unsigned char> borderEdges(vertexCount, 0);
+		for (size_t i = 0; i < current.size(); i++)
+		{
+			unsigned int from = current[i];
+			unsigned int to = current[(i % 3 == 2) ? (i - 2) : (i + 1)];
+			if (!hasDirectedEdge(current, adjacencyOffsets, adjacentTriangles, to, from))
+			{
+				bool border = !hasPositionEdge(current, adjacencyOffsets, adjacentTriangles, nextTwin, to, from);
+				openEdges[from] = min(openEdges[from] + 1, 255);
+				openEdges[to] = min(openEdges[to] + 1, 255);
+				borderEdges[from] = min(borderEdges[from] + (border ? 1 : 0), 255);
+				borderEdges[to] = min(borderEdges[to] + (border ? 1 : 0), 255);
+			}
+		}
+		for (size_t vertex = 0; vertex < vertexCount; vertex++)
+		{
+			int twinCount = 1;
+			for (unsigned int twin = nextTwin[vertex]; (twin != vertex) && (twinCount < 3); twin = nextTwin[twin])
+			{
+				twinCount++;
+			}
+			if ((twinCount == 1) && (openEdges[vertex] == 0))
+			{
+				kinds[vertex] = MANIFOLD_VERTEX;
+			}
+			else if ((twinCount == 1) && (openEdges[vertex] == 2) && (borderEdges[vertex] == 2))
+			{
+				kinds[vertex] = BORDER_VERTEX;
+			}
+			else if ((twinCount == 2) && (openEdges[vertex] == 2) && (borderEdges[vertex] == 0))
+			{
+				kinds[vertex] = SEAM_VERTEX;
+			}
+			else
+			{
+				kinds[vertex] = LOCKED_VERTEX;
+			}
+		}
+
+		// accumulate the quadrics per position
+		vector<Quadric> quadrics(vertexCount);
+		memset(quadrics.data(), 0, vertexCount * sizeof(Quadric));
+		for (size_t i = 0; i < current.size(); i += 3)
+		{
+			const float* corners[3] = {positions + (3 * current[i]), positions + (3 * current[i + 1]), positions + (3 * current[i + 2])};
+			double normal[3];
+			triangleNormal(corners[0], corners[1], corners[2], normal);
+			double length = sqrt((normal[0] * normal[0]) + (normal[1] * normal[1]) + (normal[2] * normal[2]));
+			if (length <= 0.0)
+			{
+				continue;
+			}
+			double a = normal[0] / length;
+			double b = normal[1] / length;
+			double c = normal[2] / length;
+			double d = -((a * corners[0][0]) + (b * corners[0][1]) + (c * corners[0][2]));
+			for (int corner = 0; corner < 3; corner++)
+			{
+				addPlaneQuadric(quadrics[positionGroup[current[i + corner]]], a, b, c, d, length * 0.5);
+
+				// NOTE: Open borders also get a plane through the edge, at right angles to the triangle, so
+				//       collapses are penalized for pulling the border inwards
+				unsigned int from = current[i + corner];
+				unsigned int to = current[i + ((corner + 1) % 3)];
+				if (!hasPositionEdge(current, adjacencyOffsets, adjacentTriangles, nextTwin, to, from))
+				{
+					const float* fromPosition = positions + (3 * from);
+					const float* toPosition = positions + (3 * to);
+					double edge[3] = {toPosition[0] - fromPosition[0], toPosition[1] - fromPosition[1], toPosition[2] - fromPosition[2]};
+					double edgeLength = sqrt((edge[0] * edge[0]) + (edge[1] * edge[1]) + (edge[2] * edge[2]));
+					double border[3] = {(edge[1] * c) - (edge[2] * b), (edge[2] * a) - (edge[0] * c), (edge[0] * b) - (edge[1] * a)};
+					double borderLength = sqrt((border[0] * border[0]) + (border[1] * border[1]) + (border[2] * border[2]));
+					if (borderLength > 0.0)
+					{
+						double borderA = border[0] / borderLength;
+						double borderB = border[1] / borderLength;
+						double borderC = border[2] / borderLength;
+						double borderD = -((borderA * fromPosition[0]) + (borderB * fromPosition[1]) + (borderC * fromPosition[2]));
+						double weight = BORDER_WEIGHT * edgeLength * edgeLength;
+						addPlaneQuadric(quadrics[positionGroup[from]], borderA, borderB, borderC, borderD, weight);
+						addPlaneQuadric(quadrics[positionGroup[to]], borderA, borderB, borderC, borderD, weight);
+					}
+				}
+			}
+		}
+
+		// collapse in passes until the target is reached
+		vector<unsigned int> remap(vertexCount);
+		vector<bool> touched(vertexCount);
+		vector<Collapse> collapses;
+		vector<Collapse> bestCollapse(vertexCount);
+		while (current.size() > targetIndexCount)
+		{
+			// find the cheapest allowed collapse out of every vertex
+			for (size_t vertex = 0; vertex < vertexCount; vertex++)
+			{
+				bestCollapse[vertex].source = NO_VERTEX;
+			}
+			for (size_t i = 0; i < current.size(); i++)
+			{
+				unsigned int source = current[i];
+				if (kinds[source] == LOCKED_VERTEX)
+				{
+					continue;
+				}
+				for (int step = 1; step <= 2; step++)
+				{
+					unsigned int target = current[(3 * (i / 3)) + (((i % 3) + step) % 3)];
+					if (positionGroup[source] == positionGroup[target])
+					{
+						continue;
+					}
+					// NOTE: Border and seam vertices may only slide along their open edge
+					if (kinds[source] != MANIFOLD_VERTEX)
+					{
+						bool open = (hasDirectedEdge(current, adjacencyOffsets, adjacentTriangles, source, target) !=
+							hasDirectedEdge(current, adjacencyOffsets, adjacentTriangles, target, source));
+						if (!open)
+						{
+							continue;
+						}
+					}
+					double cost = quadricError(quadrics[positionGroup[source]], positions + (3 * target));
+					if ((bestCollapse[source].source == NO_VERTEX) || (cost < bestCollapse[source].cost))
+					{
+						bestCollapse[source].source = source;
+						bestCollapse[source].target = target;
+						bestCollapse[source].cost = cost;
+					}
+				}
+			}
+			collapses.clear();
+			for (size_t vertex = 0; vertex < vertexCount; vertex++)
+			{
+				if (bestCollapse[vertex].source != NO_VERTEX)
+				{
+					collapses.push_back(bestCollapse[vertex]);
+				}
+			}
+			if (collapses.empty())
+			{
+				break;
+			}
+			sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b)
+			{
+				return a.cost < b.cost;
+			});
+
+			// NOTE: Each collapse removes about 2 triangles, so a pass only takes about as many collapses as are
+			//       needed, cheapest first. Collapses touching a vertex that already changed this pass wait for
+			//       the next one, which keeps every flip test valid
+			size_t collapseGoal = ((current.size() - targetIndexCount) / 6) + 1;
+			size_t collapseCount = 0;
+			for (size_t vertex = 0; vertex < vertexCount; vertex++)
+			{
+				remap[vertex] = (unsigned int)vertex;
+				touched[vertex] = false;
+			}
+			for (size_t c = 0; (c < collapses.size()) && (collapseCount < collapseGoal); c++)
+			{
+				unsigned int source = collapses[c].source;
+				unsigned int target = collapses[c].target;
+				unsigned int twinSource = (kinds[source] == SEAM_VERTEX) ? nextTwin[source] : NO_VERTEX;
+				unsigned int twinTarget = (twinSource != NO_VERTEX) ?
+					findEdgeTwin(current, adjacencyOffsets, adjacentTriangles, nextTwin, twinSource, target) : NO_VERTEX;
+				if ((twinSource != NO_VERTEX) && ((twinTarget == NO_VERTEX) || (twinTarget == target)))
+				{
+					continue;
+				}
+				if (touched[source] || touched[target] || ((twinSource != NO_VERTEX) && (touched[twinSource] || touched[twinTarget])))
+				{
+					continue;
+				}
+				if (!collapseKeepsOrientation(current, adjacencyOffsets, adjacentTriangles, positions, source, target) ||
+					((twinSource != NO_VERTEX) && !collapseKeepsOrientation(current, adjacencyOffsets, adjacentTriangles, positions, twinSource, twinTarget)))
+				{
+					continue;
+				}
+
+				// collapse, and freeze everything around it for the rest of the pass
+				unsigned int sources[2] = {source, twinSource};
+				unsigned int targets[2] = {target, twinTarget};
+				for (int side = 0; side < 2; side++)
+				{
+					if (sources[side] == NO_VERTEX)
+					{
+						continue;
+					}
+					remap[sources[side]] = targets[side];
+					for (unsigned int a = adjacencyOffsets[sources[side]]; a < adjacencyOffsets[sources[side] + 1]; a++)
+					{
+						const unsigned int* triangle = &current[3 * adjacentTriangles[a]];
+						touched[triangle[0]] = touched[triangle[1]] = touched[triangle[2]] = true;
+					}
+				}
+				addQuadric(quadrics[positionGroup[target]], quadrics[positionGroup[source]]);
+				maximumCost = max(maximumCost, collapses[c].cost);
+				collapseCount++;
+			}
+			if (collapseCount == 0)
+			{
+				break;
+			}
+
+			// rewrite the triangles, dropping the ones that collapsed
+			size_t writeCursor = 0;
+			for (size_t i = 0; i < current.size(); i += 3)
+			{
+				unsigned int corner0 = remap[current[i]];
+				unsigned int corner1 = remap[current[i + 1]];
+				unsigned int corner2 = remap[current[i + 2]];
+				if ((corner0 != corner1) && (corner1 != corner2) && (corner0 != corner2))
+				{
+					current[writeCursor++] = corner0;
+					current[writeCursor++] = corner1;
+					current[writeCursor++] = corner2;
+				}
+			}
+			current.resize(writeCursor);
+			buildAdjacency(current, vertexCount, adjacencyOffsets, adjacentTriangles);
+		}
+
+		// done
+		copy(current.begin(), current.end(), destination);
+		resultError = (float)sqrt(maximumCost);
+		return current.size();
+	}
+}
@@ -0,0 +1,28 @@
+//// Declaration Guards
+#ifndef SIMPLIFY_H
+#define SIMPLIFY_H
+
+//// Imports
+#include <stddef.h>
+
+namespace SWPTAS001
+{
+	//// Simplification Routines
+	size_t simplifyMesh(const unsigned int* indices, size_t indexCount, const float* positions, size_t vertexCount,
+		size_t targetIndexCount, unsigned int* destination, float& resultError);
+}
+
+#endif
+
+// NOTE: simplifyMesh() collapses edges in order of their quadric error (Garland & Heckbert) until at most
+//       targetIndexCount indices are left or nothing can be collapsed anymore, writes the new triangle
+//       list to destination (which needs room for indexCount indices) and returns its length. Vertices
+//       are never moved or created, a collapse just merges one vertex into a neighbour, so every level
+//       of detail can index the same vertex buffer
+// NOTE: resultError is the largest distance (in mesh units) that a collapse moved the surface by, as
+//       measured by the quadrics, so it can be projected to the screen to pick a level
+// NOTE: Vertices that share a position with another vertex (a UV or normal seam) only collapse along
+//       the seam, together with their twin on the other side, and vertices on an open border only
+//       collapse along the border, so neither seams nor silhouettes get torn open. Positions shared by
+//       more than two vertices (e.g. seam ends and poles) never move. Collapses that would flip a
+//       triangle are skipped
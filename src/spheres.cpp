@@ -0,0 +1,345 @@
+//// Header
+#include "spheres.h"
+
+//// Imports
+#include <algorithm>
+#include <map>
+#include <math.h>
+
+//// Namespaces
+using namespace std;
+
+namespace SWPTAS001
+{
+	//// Constants
+	static const float PI = 3.14159265f;
+	static const unsigned int NO_VERTEX = 0xFFFFFFFF;
+	// NOTE: Each cube face is given by its normal and the directions of u and v, with u x v = normal
+	static const float CUBE_FACES[6][3][3] = {{{1, 0, 0}, {0, 0, -1}, {0, 1, 0}}, {{-1, 0, 0}, {0, 0, 1}, {0, 1, 0}},
+		{{0, 1, 0}, {1, 0, 0}, {0, 0, -1}}, {{0, -1, 0}, {1, 0, 0}, {0, 0, 1}}, {{0, 0, 1}, {1, 0, 0}, {0, 1, 0}},
+		{{0, 0, -1}, {-1, 0, 0}, {0, 1, 0}}};
+
+	/////////////
+	// Helpers //
+	/////////////
+
+	// The attribute arrays of a sphere being built, sized once and then written vertex by vertex
+	struct SphereOutput
+	{
+		ArenaVector<float>& positions;
+		ArenaVector<float>& textureCoords;
+		ArenaVector<float>& normals;
+		ArenaVector<float>& tangents;
+		ArenaVector<float>& bitangents;
+
+		void resize(size_t vertexCount)
+		{
+			positions.resize(vertexCount * 3);
+			textureCoords.resize(vertexCount * 2);
+			normals.resize(vertexCount * 3);
+			tangents.resize(vertexCount * 3);
+			bitangents.resize(vertexCount * 3);
+		}
+
+		void write(size_t vertex, const float* position, float u, float v, const float* tangent)
+		{
+			// NOTE: On a unit sphere the normal is the position, and both shapes map textures without
+			//       mirroring, so the bitangent is always normal x tangent
+			float bitangent[3] = {(position[1] * tangent[2]) - (position[2] * tangent[1]),
+				(position[2] * tangent[0]) - (position[0] * tangent[2]), (position[0] * tangent[1]) - (position[1] * tangent[0])};
+			for (int axis = 0; axis < 3; axis++)
+			{
+				positions[(3 * vertex) + axis] = position[axis];
+				normals[(3 * vertex) + axis] = position[axis];
+				tangents[(3 * vertex) + axis] = tangent[axis];
+				bitangents[(3 * vertex) + axis] = bitangent[axis];
+			}
+			textureCoords[2 * vertex] = u;
+			textureCoords[(2 * vertex) + 1] = v;
+		}
+	};
+
+	static void normalize(float* vector)
+	{
+		float length = sqrtf((vector[0] * vector[0]) + (vector[1] * vector[1]) + (vector[2] * vector[2]));
+		vector[0] /= length;
+		vector[1] /= length;
+		vector[2] /= length;
+	}
+
+	// Longitude of a point as a texture coord, increasing eastwards when looking at the sphere from outside
+	static float longitudeCoord(const float* point)
+	{
+		// NOTE: Points on the seam (z of +0 or -0) all start at 0, the triangles east of it move them to 1
+		float z = (point[2] == 0.0f) ? 0.0f : point[2];
+		return 0.5f - (atan2f(z, point[0]) / (2.0f * PI));
+	}
+
+	// How far the flattest triangle of an index range sags inside the unit sphere
+	static float sphereSagitta(const ArenaVector<float>& positions, const unsigned int* indices, size_t indexCount)
+	{
+		float sagitta = 0.0f;
+		for (size_t corner = 0; corner < indexCount; corner += 3)
+		{
+			const float* a = &positions[3 * indices[corner]];
+			const float* b = &positions[3 * indices[corner + 1]];
+			const float* c = &positions[3 * indices[corner + 2]];
+			float ab[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+			float ac[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+			float normal[3] = {(ab[1] * ac[2]) - (ab[2] * ac[1]), (ab[2] * ac[0]) - (ab[0] * ac[2]), (ab[0] * ac[1]) - (ab[1] * ac[0])};
+			normalize(normal);
+			sagitta = max(sagitta, 1.0f - ((normal[0] * a[0]) + (normal[1] * a[1]) + (normal[2] * a[2])));
+		}
+		return sagitta;
+	}
+
+	////////////////
+	// Icospheres //
+	////////////////
+
+	static void buildIcosphere(int subdivisions, int levelCount, SphereOutput& output, vector<unsigned int>& indices,
+		vector<MeshLOD>& levels)
+	{
+		// start from an icosahedron
+		const float golden = (1.0f + sqrtf(5.0f)) * 0.5f;
+		const float corners[12][3] = {{-1, golden, 0}, {1, golden, 0}, {-1, -golden, 0}, {1, -golden, 0}, {0, -1, golden},
+			{0, 1, golden}, {0, -1, -golden}, {0, 1, -golden}, {golden, 0, -1}, {golden, 0, 1}, {-golden, 0, -1}, {-golden, 0, 1}};
+		const unsigned int faces[20][3] = {{0, 11, 5}, {0, 5, 1}, {0, 1, 7}, {0, 7, 10}, {0, 10, 11}, {1, 5, 9}, {5, 11, 4},
+			{11, 10, 2}, {10, 7, 6}, {7, 1, 8}, {3, 9, 4}, {3, 4, 2}, {3, 2, 6}, {3, 6, 8}, {3, 8, 9}, {4, 9, 5}, {2, 4, 11},
+			{6, 2, 10}, {8, 6, 7}, {9, 8, 1}};
+		vector<float> points;
+		points.reserve(3 * ((10 << (2 * subdivisions)) + 2));
+		for (int corner = 0; corner < 12; corner++)
+		{
+			float point[3] = {corners[corner][0], corners[corner][1], corners[corner][2]};
+			normalize(point);
+			points.insert(points.end(), point, point + 3);
+		}
+		vector<vector<unsigned int> > triangles(subdivisions + 1);
+		triangles[0].assign(&faces[0][0], &faces[0][0] + 60);
+
+		// split every triangle into 4, sharing the new point on each edge between its two triangles
+		for (int level = 1; level <= subdivisions; level++)
+		{
+			const vector<unsigned int>& coarse = triangles[level - 1];
+			vector<unsigned int>& fine = triangles[level];
+			fine.reserve(coarse.size() * 4);
+			map<pair<unsigned int, unsigned int>, unsigned int> edgePoints;
+			for (size_t corner = 0; corner < coarse.size(); corner += 3)
+			{
+				unsigned int middle[3];
+				for (int edge = 0; edge < 3; edge++)
+				{
+					unsigned int from = coarse[corner + edge];
+					unsigned int to = coarse[corner + ((edge + 1) % 3)];
+					pair<unsigned int, unsigned int> key(min(from, to), max(from, to));
+					map<pair<unsigned int, unsigned int>, unsigned int>::iterator found = edgePoints.find(key);
+					if (found != edgePoints.end())
+					{
+						middle[edge] = found->second;
+						continue;
+					}
+					float point[3] = {points[3 * from] + points[3 * to], points[(3 * from) + 1] + points[(3 * to) + 1],
+						points[(3 * from) + 2] + points[(3 * to) + 2]};
+					normalize(point);
+					middle[edge] = (unsigned int)(points.size() / 3);
+					points.insert(points.end(), point, point + 3);
+					edgePoints[key] = middle[edge];
+				}
+				const unsigned int split[12] = {coarse[corner], middle[0], middle[2], coarse[corner + 1], middle[1], middle[0],
+					coarse[corner + 2], middle[2], middle[1], middle[0], middle[1], middle[2]};
+				fine.insert(fine.end(), split, split + 12);
+			}
+		}
+
+		// give every corner its texture coords, finest level first
+		// NOTE: Triangles across the seam wrap their western corners past 1, and a pole takes the longitude
+		//       halfway between the other two corners, so both get their own vertex for each coord they need
+		size_t pointCount = points.size() / 3;
+		vector<unsigned int> pointVertices(pointCount, NO_VERTEX);
+		vector<float> pointCoords(pointCount);
+		map<pair<unsigned int, float>, unsigned int> wrappedVertices;
+		vector<unsigned int> vertexPoints;
+		vector<float> vertexCoords;
+		vertexPoints.reserve(pointCount + (pointCount / 8));
+		vertexCoords.reserve(pointCount + (pointCount / 8));
+		for (size_t point = 0; point < pointCount; point++)
+		{
+			pointCoords[point] = longitudeCoord(&points[3 * point]);
+		}
+		levels.clear();
+		indices.clear();
+		for (int level = subdivisions; level > (subdivisions - levelCount); level--)
+		{
+			const vector<unsigned int>& levelTriangles = triangles[level];
+			MeshLOD lod = {(unsigned int)indices.size(), (unsigned int)levelTriangles.size(), 0.0f, 0};
+			for (size_t corner = 0; corner < levelTriangles.size(); corner += 3)
+			{
+				float coords[3];
+				bool pole[3];
+				float lowest = 1.0f;
+				float highest = 0.0f;
+				for (int c = 0; c < 3; c++)
+				{
+					const float* point = &points[3 * levelTriangles[corner + c]];
+					coords[c] = pointCoords[levelTriangles[corner + c]];
+					pole[c] = ((point[0] * point[0]) + (point[2] * point[2])) < 1e-12f;
+					lowest = pole[c] ? lowest : min(lowest, coords[c]);
+					highest = pole[c] ? highest : max(highest, coords[c]);
+				}
+				float poleCoord = 0.0f;
+				int poleCount = 0;
+				for (int c = 0; c < 3; c++)
+				{
+					coords[c] += (!pole[c] && ((highest - lowest) > 0.5f) && (coords[c] < 0.5f)) ? 1.0f : 0.0f;
+					poleCoord += pole[c] ? 0.0f : coords[c];
+					poleCount += pole[c] ? 1 : 0;
+				}
+				for (int c = 0; c < 3; c++)
+				{
+					unsigned int point = levelTriangles[corner + c];
+					float coord = pole[c] ? (poleCoord / (3 - poleCount)) : coords[c];
+					unsigned int vertex;
+					if (coord == pointCoords[point])
+					{
+						if (pointVertices[point] == NO_VERTEX)
+						{
+							pointVertices[point] = (unsigned int)vertexPoints.size();
+							vertexPoints.push_back(point);
+							vertexCoords.push_back(coord);
+						}
+						vertex = pointVertices[point];
+					}
+					else
+					{
+						pair<unsigned int, float> key(point, coord);
+						map<pair<unsigned int, float>, unsigned int>::iterator found = wrappedVertices.find(key);
+						if (found == wrappedVertices.end())
+						{
+							found = wrappedVertices.insert(make_pair(key, (unsigned int)vertexPoints.size())).first;
+							vertexPoints.push_back(point);
+							vertexCoords.push_back(coord);
+						}
+						vertex = found->second;
+					}
+					indices.push_back(vertex);
+				}
+			}
+			levels.push_back(lod);
+		}
+
+		// write the vertices
+		// NOTE: The tangent points east along the longitude the vertex was given, which stays well
+		//       defined at the poles
+		output.resize(vertexPoints.size());
+		for (size_t vertex = 0; vertex < vertexPoints.size(); vertex++)
+		{
+			const float* point = &points[3 * vertexPoints[vertex]];
+			float longitude = (0.5f - vertexCoords[vertex]) * 2.0f * PI;
+			float tangent[3] = {sinf(longitude), 0.0f, -cosf(longitude)};
+			float latitude = 0.5f + (asinf(max(-1.0f, min(point[1], 1.0f))) / PI);
+			output.write(vertex, point, vertexCoords[vertex], latitude, tangent);
+		}
+	}
+
+	//////////////////
+	// Cube-Spheres //
+	//////////////////
+
+	static void buildCubeSphere(int subdivisions, int levelCount, SphereOutput& output, vector<unsigned int>& indices,
+		vector<MeshLOD>& levels)
+	{
+		const int gridSize = 1 << subdivisions;
+		const size_t side = gridSize + 1;
+
+		// write a grid of vertices on each face, pushed out onto the sphere
+		// NOTE: The tangent is the face's u direction with the part along the normal taken out
+		output.resize(6 * side * side);
+		for (int face = 0; face < 6; face++)
+		{
+			const float* uAxis = CUBE_FACES[face][1];
+			for (size_t row = 0; row < side; row++)
+			{
+				for (size_t column = 0; column < side; column++)
+				{
+					float u = (float)column / gridSize;
+					float v = (float)row / gridSize;
+					float point[3];
+					cubeSpherePoint(face, u, v, point);
+					float along = (point[0] * uAxis[0]) + (point[1] * uAxis[1]) + (point[2] * uAxis[2]);
+					float tangent[3] = {uAxis[0] - (along * point[0]), uAxis[1] - (along * point[1]), uAxis[2] - (along * point[2])};
+					normalize(tangent);
+					output.write((face * side * side) + (row * side) + column, point, u, v, tangent);
+				}
+			}
+		}
+
+		// triangulate every level from the same grid, coarser levels skipping rows and columns
+		levels.clear();
+		indices.clear();
+		indices.reserve(6 * 6 * (gridSize * gridSize) * 4 / 3);
+		for (int level = 0; level < levelCount; level++)
+		{
+			const size_t step = (size_t)1 << level;
+			MeshLOD lod = {(unsigned int)indices.size(), 0, 0.0f, 0};
+			for (size_t face = 0; face < 6; face++)
+			{
+				for (size_t row = 0; (row + step) < side; row += step)
+				{
+					for (size_t column = 0; (column + step) < side; column += step)
+					{
+						unsigned int corner = (unsigned int)((face * side * side) + (row * side) + column);
+						unsigned int across = corner + (unsigned int)step;
+						unsigned int up = corner + (unsigned int)(step * side);
+						const unsigned int quad[6] = {corner, across, up + (unsigned int)step, corner, up + (unsigned int)step, up};
+						indices.insert(indices.end(), quad, quad + 6);
+					}
+				}
+			}
+			lod.indexCount = (unsigned int)(indices.size() - lod.indexOffset);
+			levels.push_back(lod);
+		}
+	}
+
+	/////////////////////
+	// Sphere Routines //
+	/////////////////////
+
+	void cubeSpherePoint(int face, float u, float v, float* point)
+	{
+		// NOTE: Only exact values (0 and 1) multiply the face axes, so points on an edge shared by two
+		//       faces come out bit for bit the same from either of them
+		const float* normal = CUBE_FACES[face][0];
+		const float* uAxis = CUBE_FACES[face][1];
+		const float* vAxis = CUBE_FACES[face][2];
+		for (int axis = 0; axis < 3; axis++)
+		{
+			point[axis] = normal[axis] + (((2.0f * u) - 1.0f) * uAxis[axis]) + (((2.0f * v) - 1.0f) * vAxis[axis]);
+		}
+		normalize(point);
+	}
+
+	void buildSphere(SphereShape shape, int subdivisions, int levelCount, ArenaVector<float>& positions, ArenaVector<float>& textureCoords,
+		ArenaVector<float>& normals, ArenaVector<float>& tangents, ArenaVector<float>& bitangents,
+		vector<unsigned int>& indices, vector<MeshLOD>& levels)
+	{
+		// build
+		subdivisions = max(0, min(subdivisions, MAX_SPHERE_SUBDIVISIONS));
+		levelCount = max(1, min(levelCount, subdivisions + 1));
+		SphereOutput output = {positions, textureCoords, normals, tangents, bitangents};
+		if (shape == CUBE_SPHERE)
+		{
+			buildCubeSphere(subdivisions, levelCount, output, indices, levels);
+		}
+		else
+		{
+			buildIcosphere(subdivisions, levelCount, output, indices, levels);
+		}
+
+		// measure
+		for (size_t level = 0; level < levels.size(); level++)
+		{
+			levels[level].error = sphereSagitta(positions, &indices[levels[level].indexOffset], levels[level].indexCount);
+		}
+	}
+}
@@ -0,0 +1,41 @@
+//// Declaration Guards
+#ifndef SPHERES_H
+#define SPHERES_H
+
+//// Imports
+#include <stddef.h>
+#include <vector>
+#include "arena.h"
+#include "meshcache.h"
+
+namespace SWPTAS001
+{
+	//// Constants
+	static const int MAX_SPHERE_SUBDIVISIONS = 8;
+
+	//// Enumerations
+	enum SphereShape { ICOSPHERE, CUBE_SPHERE };
+
+	//// Sphere Routines
+	void buildSphere(SphereShape shape, int subdivisions, int levelCount, ArenaVector<float>& positions, ArenaVector<float>& textureCoords,
+		ArenaVector<float>& normals, ArenaVector<float>& tangents, ArenaVector<float>& bitangents,
+		std::vector<unsigned int>& indices, std::vector<MeshLOD>& levels);
+	void cubeSpherePoint(int face, float u, float v, float* point);
+}
+
+#endif
+
+// NOTE: buildSphere() writes a unit sphere with every attribute straight into the given arrays, and one
+//       level of detail per subdivision step (levelCount of them, finest first), all indexing the same
+//       vertices. A level's error is how far its flattest triangle sags inside the sphere, so a renderer can
+//       pick the subdivision level from the projected size of the sphere, just like it picks a simplified
+//       level of a loaded mesh
+
+// NOTE: An icosphere splits each of the 20 faces of an icosahedron into 4, subdivisions times over, which
+//       gives 20 * 4^subdivisions nearly equal triangles. Texture coords are longitude/latitude, so vertices
+//       on the seam and at the poles are duplicated, and the tangent follows the longitude
+
+// NOTE: A cube-sphere normalizes a grid of 2^subdivisions by 2^subdivisions quads on each face of a cube,
+//       which gives 12 * 4^subdivisions triangles, somewhat larger at the face centres than at the corners.
+//       Every face carries the whole texture and has no seams within it, so its vertices are never shared.
+//       cubeSpherePoint() maps a point (u, v in [0, 1]) of one of the 6 faces onto the unit sphere
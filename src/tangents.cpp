@@ -0,0 +1,366 @@
+//// Header
+#include "tangents.h"
+
+//// Imports
+#include <vector>
+#include <string.h>
+#include <math.h>
+#include "parallel.h"
+
+//// Configurations
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define TANGENTS_SSE2
+#include <emmintrin.h>
+#endif
+
+//// Namespaces
+using namespace std;
+
+namespace SWPTAS001
+{
+	//// Constants
+	static const float TANGENT_SMOOTHING_COS = 0.70710678f;
+	static const float DEGENERATE_UV_EPSILON = 1e-6f;
+	static const size_t TANGENT_BLOCK_SIZE = 4096;
+	static const unsigned int EMPTY_GROUP_SLOT = 0xFFFFFFFF;
+
+	/////////////
+	// Helpers //
+	/////////////
+
+	// Writes the unit face tangent and the UV handedness (+1, -1, or 0 for degenerate UVs) as xyzw
+	static inline void faceTangent(const float* position0, const float* position1, const float* position2,
+		const float* normal0, const float* normal1, const float* normal2,
+		const float* texCoord0, const float* texCoord1, const float* texCoord2, float* output)
+	{
+		float edgeX1 = position1[0] - position0[0];
+		float edgeY1 = position1[1] - position0[1];
+		float edgeZ1 = position1[2] - position0[2];
+		float edgeX2 = position2[0] - position0[0];
+		float edgeY2 = position2[1] - position0[1];
+		float edgeZ2 = position2[2] - position0[2];
+		float deltaU1 = texCoord1[0] - texCoord0[0];
+		float deltaV1 = texCoord1[1] - texCoord0[1];
+		float deltaU2 = texCoord2[0] - texCoord0[0];
+		float deltaV2 = texCoord2[1] - texCoord0[1];
+
+		// NOTE: Only the direction matters, so the 1/determinant scale reduces to its sign
+		float determinant = (deltaU1 * deltaV2) - (deltaU2 * deltaV1);
+		float uvScale = (fabsf(deltaU1) + fabsf(deltaV1)) * (fabsf(deltaU2) + fabsf(deltaV2));
+		float uvSign = (determinant < 0.0f) ? -1.0f : 1.0f;
+		float tangentX = uvSign * ((deltaV2 * edgeX1) - (deltaV1 * edgeX2));
+		float tangentY = uvSign * ((deltaV2 * edgeY1) - (deltaV1 * edgeY2));
+		float tangentZ = uvSign * ((deltaV2 * edgeZ1) - (deltaV1 * edgeZ2));
+
+		// NOTE: The UV sign is relative to the winding, so it is flipped for faces wound against their normals
+		float facing = ((((edgeY1 * edgeZ2) - (edgeZ1 * edgeY2)) * (normal0[0] + normal1[0] + normal2[0])) +
+			(((edgeZ1 * edgeX2) - (edgeX1 * edgeZ2)) * (normal0[1] + normal1[1] + normal2[1])) +
+			(((edgeX1 * edgeY2) - (edgeY1 * edgeX2)) * (normal0[2] + normal1[2] + normal2[2])));
+		float handedness = (facing < 0.0f) ? -uvSign : uvSign;
+		float length = sqrtf((tangentX * tangentX) + (tangentY * tangentY) + (tangentZ * tangentZ));
+		if ((fabsf(determinant) <= (DEGENERATE_UV_EPSILON * uvScale)) || !(length > 0.0f))
+		{
+			output[0] = output[1] = output[2] = output[3] = 0.0f;
+			return;
+		}
+		output[0] = tangentX / length;
+		output[1] = tangentY / length;
+		output[2] = tangentZ / length;
+		output[3] = handedness;
+	}
+
+#ifdef TANGENTS_SSE2
+	static inline __m128 absolute4(__m128 value)
+	{
+		return _mm_andnot_ps(_mm_set1_ps(-0.0f), value);
+	}
+
+	// Same as faceTangent(), for the 4 faces starting at face, with the results written face by face
+	static inline void faceTangent4(const float* positions, const float* normals, const float* textureCoords, const unsigned int* face, float* output)
+	{
+		// gather corners into SoA registers
+		__m128 cornerX[3], cornerY[3], cornerZ[3], cornerU[3], cornerV[3];
+		__m128 normalX = _mm_setzero_ps();
+		__m128 normalY = _mm_setzero_ps();
+		__m128 normalZ = _mm_setzero_ps();
+		for (int corner = 0; corner < 3; corner++)
+		{
+			const unsigned int index0 = face[corner];
+			const unsigned int index1 = face[3 + corner];
+			const unsigned int index2 = face[6 + corner];
+			const unsigned int index3 = face[9 + corner];
+			cornerX[corner] = _mm_setr_ps(positions[3 * index0], positions[3 * index1], positions[3 * index2], positions[3 * index3]);
+			cornerY[corner] = _mm_setr_ps(positions[(3 * index0) + 1], positions[(3 * index1) + 1], positions[(3 * index2) + 1], positions[(3 * index3) + 1]);
+			cornerZ[corner] = _mm_setr_ps(positions[(3 * index0) + 2], positions[(3 * index1) + 2], positions[(3 * index2) + 2], positions[(3 * index3) + 2]);
+			cornerU[corner] = _mm_setr_ps(textureCoords[2 * index0], textureCoords[2 * index1], textureCoords[2 * index2], textureCoords[2 * index3]);
+			cornerV[corner] = _mm_setr_ps(textureCoords[(2 * index0) + 1], textureCoords[(2 * index1) + 1], textureCoords[(2 * index2) + 1], textureCoords[(2 * index3) + 1]);
+			normalX = _mm_add_ps(normalX, _mm_setr_ps(normals[3 * index0], normals[3 * index1], normals[3 * index2], normals[3 * index3]));
+			normalY = _mm_add_ps(normalY, _mm_setr_ps(normals[(3 * index0) + 1], normals[(3 * index1) + 1], normals[(3 * index2) + 1], normals[(3 * index3) + 1]));
+			normalZ = _mm_add_ps(normalZ, _mm_setr_ps(normals[(3 * index0) + 2], normals[(3 * index1) + 2], normals[(3 * index2) + 2], normals[(3 * index3) + 2]));
+		}
+
+		// edges
+		__m128 edgeX1 = _mm_sub_ps(cornerX[1], cornerX[0]);
+		__m128 edgeY1 = _mm_sub_ps(cornerY[1], cornerY[0]);
+		__m128 edgeZ1 = _mm_sub_ps(cornerZ[1], cornerZ[0]);
+		__m128 edgeX2 = _mm_sub_ps(cornerX[2], cornerX[0]);
+		__m128 edgeY2 = _mm_sub_ps(cornerY[2], cornerY[0]);
+		__m128 edgeZ2 = _mm_sub_ps(cornerZ[2], cornerZ[0]);
+		__m128 deltaU1 = _mm_sub_ps(cornerU[1], cornerU[0]);
+		__m128 deltaV1 = _mm_sub_ps(cornerV[1], cornerV[0]);
+		__m128 deltaU2 = _mm_sub_ps(cornerU[2], cornerU[0]);
+		__m128 deltaV2 = _mm_sub_ps(cornerV[2], cornerV[0]);
+
+		// tangent direction
+		__m128 determinant = _mm_sub_ps(_mm_mul_ps(deltaU1, deltaV2), _mm_mul_ps(deltaU2, deltaV1));
+		__m128 uvScale = _mm_mul_ps(_mm_add_ps(absolute4(deltaU1), absolute4(deltaV1)), _mm_add_ps(absolute4(deltaU2), absolute4(deltaV2)));
+		__m128 uvSign = _mm_or_ps(_mm_and_ps(_mm_cmplt_ps(determinant, _mm_setzero_ps()), _mm_set1_ps(-1.0f)),
+			_mm_andnot_ps(_mm_cmplt_ps(determinant, _mm_setzero_ps()), _mm_set1_ps(1.0f)));
+		__m128 tangentX = _mm_mul_ps(uvSign, _mm_sub_ps(_mm_mul_ps(deltaV2, edgeX1), _mm_mul_ps(deltaV1, edgeX2)));
+		__m128 tangentY = _mm_mul_ps(uvSign, _mm_sub_ps(_mm_mul_ps(deltaV2, edgeY1), _mm_mul_ps(deltaV1, edgeY2)));
+		__m128 tangentZ = _mm_mul_ps(uvSign, _mm_sub_ps(_mm_mul_ps(deltaV2, edgeZ1), _mm_mul_ps(deltaV1, edgeZ2)));
+
+		// handedness, flipped for faces wound against their normals
+		__m128 facing = _mm_add_ps(_mm_add_ps(
+			_mm_mul_ps(_mm_sub_ps(_mm_mul_ps(edgeY1, edgeZ2), _mm_mul_ps(edgeZ1, edgeY2)), normalX),
+			_mm_mul_ps(_mm_sub_ps(_mm_mul_ps(edgeZ1, edgeX2), _mm_mul_ps(edgeX1, edgeZ2)), normalY)),
+			_mm_mul_ps(_mm_sub_ps(_mm_mul_ps(edgeX1, edgeY2), _mm_mul_ps(edgeY1, edgeX2)), normalZ));
+		__m128 handedness = _mm_xor_ps(uvSign, _mm_and_ps(_mm_cmplt_ps(facing, _mm_setzero_ps()), _mm_set1_ps(-0.0f)));
+		__m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(tangentX, tangentX), _mm_mul_ps(tangentY, tangentY)), _mm_mul_ps(tangentZ, tangentZ)));
+
+		// normalize, zeroing degenerate faces
+		__m128 valid = _mm_and_ps(_mm_cmpgt_ps(absolute4(determinant), _mm_mul_ps(_mm_set1_ps(DEGENERATE_UV_EPSILON), uvScale)),
+			_mm_cmpgt_ps(length, _mm_setzero_ps()));
+		__m128 safeLength = _mm_or_ps(_mm_and_ps(valid, length), _mm_andnot_ps(valid, _mm_set1_ps(1.0f)));
+		tangentX = _mm_and_ps(valid, _mm_div_ps(tangentX, safeLength));
+		tangentY = _mm_and_ps(valid, _mm_div_ps(tangentY, safeLength));
+		tangentZ = _mm_and_ps(valid, _mm_div_ps(tangentZ, safeLength));
+		handedness = _mm_and_ps(valid, handedness);
+
+		// transpose back to one xyzw per face
+		_MM_TRANSPOSE4_PS(tangentX, tangentY, tangentZ, handedness);
+		_mm_storeu_ps(output, tangentX);
+		_mm_storeu_ps(output + 4, tangentY);
+		_mm_storeu_ps(output + 8, tangentZ);
+		_mm_storeu_ps(output + 12, handedness);
+	}
+#endif
+
+	static inline unsigned long long hashVertexKey(const float* position, const float* normal)
+	{
+		unsigned int bits[6];
+		memcpy(bits, position, 3 * sizeof(float));
+		memcpy(bits + 3, normal, 3 * sizeof(float));
+		unsigned long long hash = 0;
+		for (int i = 0; i < 6; i++)
+		{
+			hash = (hash ^ bits[i]) * 0x9E3779B97F4A7C15ULL;
+		}
+		return hash ^ (hash >> 29);
+	}
+
+	// Maps every vertex to the first vertex sharing its position and normal
+	static void findTangentGroups(const float* positions, const float* normals, size_t vertexCount, vector<unsigned int>& groups, int threadCount)
+	{
+		// hash every vertex
+		vector<unsigned long long> hashes(vertexCount);
+		size_t vertexBlocks = (vertexCount + TANGENT_BLOCK_SIZE - 1) / TANGENT_BLOCK_SIZE;
+		parallelFor(vertexBlocks, threadCount, [&](size_t blockIndex)
+		{
+			size_t blockEnd = min(vertexCount, (blockIndex + 1) * TANGENT_BLOCK_SIZE);
+			for (size_t vertIndex = blockIndex * TANGENT_BLOCK_SIZE; vertIndex < blockEnd; vertIndex++)
+			{
+				hashes[vertIndex] = hashVertexKey(&positions[3 * vertIndex], &normals[3 * vertIndex]);
+			}
+		});
+
+		// NOTE: Each partition owns a slice of the hash space and its own table, and inserts its vertices
+		//       in vertex order, so the first vertex of every group wins for any partition count
+		size_t partitionCount = (size_t)resolveThreadCount(threadCount);
+		groups.resize(vertexCount);
+		parallelFor(partitionCount, threadCount, [&](size_t partitionIndex)
+		{
+			size_t capacity = 64;
+			while (capacity < ((vertexCount * 2) / partitionCount))
+			{
+				capacity *= 2;
+			}
+			vector<unsigned int> slots(capacity, EMPTY_GROUP_SLOT);
+			size_t mask = capacity - 1;
+			for (size_t vertIndex = 0; vertIndex < vertexCount; vertIndex++)
+			{
+				if ((size_t)((hashes[vertIndex] >> 40) % partitionCount) != partitionIndex)
+				{
+					continue;
+				}
+				const float* position = &positions[3 * vertIndex];
+				const float* normal = &normals[3 * vertIndex];
+				size_t slot = (size_t)(hashes[vertIndex] & mask);
+				groups[vertIndex] = (unsigned int)vertIndex;
+				while (slots[slot] != EMPTY_GROUP_SLOT)
+				{
+					unsigned int other = slots[slot];
+					if ((memcmp(position, &positions[3 * other], 3 * sizeof(float)) == 0) &&
+						(memcmp(normal, &normals[3 * other], 3 * sizeof(float)) == 0))
+					{
+						groups[vertIndex] = other;
+						break;
+					}
+					slot = (slot + 1) & mask;
+				}
+				if (slots[slot] == EMPTY_GROUP_SLOT)
+				{
+					slots[slot] = (unsigned int)vertIndex;
+				}
+			}
+		});
+	}
+
+	static inline void perpendicularTo(const float* normal, float* tangent)
+	{
+		// cross the normal with whichever axis it is least aligned with
+		float axis[3] = {0.0f, 0.0f, 0.0f};
+		float absX = fabsf(normal[0]);
+		float absY = fabsf(normal[1]);
+		float absZ = fabsf(normal[2]);
+		axis[((absX <= absY) && (absX <= absZ)) ? 0 : ((absY <= absZ) ? 1 : 2)] = 1.0f;
+		tangent[0] = (normal[1] * axis[2]) - (normal[2] * axis[1]);
+		tangent[1] = (normal[2] * axis[0]) - (normal[0] * axis[2]);
+		tangent[2] = (normal[0] * axis[1]) - (normal[1] * axis[0]);
+		float length = sqrtf((tangent[0] * tangent[0]) + (tangent[1] * tangent[1]) + (tangent[2] * tangent[2]));
+		for (int i = 0; i < 3; i++)
+		{
+			tangent[i] = (length > 0.0f) ? (tangent[i] / length) : ((i == 0) ? 1.0f : 0.0f);
+		}
+	}
+
+	//////////////////////
+	// Tangent Routines //
+	//////////////////////
+
+	void generateTangentFrames(const float* positions, const float* normals, const float* textureCoords, size_t vertexCount,
+		const unsigned int* indices, size_t indexCount, float* tangents, float* bitangents, int threadCount)
+	{
+		// face tangents, 4 at a time
+		size_t faceCount = indexCount / 3;
+		vector<float> faceTangents(faceCount * 4);
+		size_t faceBlocks = (faceCount + TANGENT_BLOCK_SIZE - 1) / TANGENT_BLOCK_SIZE;
+		parallelFor(faceBlocks, threadCount, [&](size_t blockIndex)
+		{
+			size_t faceIndex = blockIndex * TANGENT_BLOCK_SIZE;
+			size_t blockEnd = min(faceCount, faceIndex + TANGENT_BLOCK_SIZE);
+#ifdef TANGENTS_SSE2
+			for (; (faceIndex + 4) <= blockEnd; faceIndex += 4)
+			{
+				faceTangent4(positions, normals, textureCoords, &indices[3 * faceIndex], &faceTangents[4 * faceIndex]);
+			}
+#endif
+			for (; faceIndex < blockEnd; faceIndex++)
+			{
+				const unsigned int* face = &indices[3 * faceIndex];
+				faceTangent(&positions[3 * face[0]], &positions[3 * face[1]], &positions[3 * face[2]],
+					&normals[3 * face[0]], &normals[3 * face[1]], &normals[3 * face[2]], &textureCoords[2 * face[0]], &textureCoords[2 * face[1]], &textureCoords[2 * face[2]], &faceTangents[4 * faceIndex]);
+			}
+		});
+
+		// list the face corners touching every group of coincident vertices
+		vector<unsigned int> groups;
+		findTangentGroups(positions, normals, vertexCount, groups, threadCount);
+		vector<unsigned int> groupStart(vertexCount + 1, 0);
+		for (size_t corner = 0; corner < (faceCount * 3); corner++)
+		{
+			groupStart[groups[indices[corner]] + 1]++;
+		}
+		for (size_t vertIndex = 0; vertIndex < vertexCount; vertIndex++)
+		{
+			groupStart[vertIndex + 1] += groupStart[vertIndex];
+		}
+		vector<unsigned int> groupCorners(faceCount * 3);
+		vector<unsigned int> groupCursor(groupStart.begin(), groupStart.end() - 1);
+		for (size_t corner = 0; corner < (faceCount * 3); corner++)
+		{
+			groupCorners[groupCursor[groups[indices[corner]]]++] = (unsigned int)corner;
+		}
+
+		// pool, orthonormalize and sign every vertex frame
+		size_t vertexBlocks = (vertexCount + TANGENT_BLOCK_SIZE - 1) / TANGENT_BLOCK_SIZE;
+		parallelFor(vertexBlocks, threadCount, [&](size_t blockIndex)
+		{
+			size_t blockEnd = min(vertexCount, (blockIndex + 1) * TANGENT_BLOCK_SIZE);
+			for (size_t vertIndex = blockIndex * TANGENT_BLOCK_SIZE; vertIndex < blockEnd; vertIndex++)
+			{
+				const unsigned int* corners = &groupCorners[groupStart[groups[vertIndex]]];
+				size_t cornerCount = groupStart[groups[vertIndex] + 1] - groupStart[groups[vertIndex]];
+
+				// the vertex's own faces decide its handedness and reference direction
+				float ownTangent[3] = {0.0f, 0.0f, 0.0f};
+				float handednessSum = 0.0f;
+				for (size_t i = 0; i < cornerCount; i++)
+				{
+					if (indices[corners[i]] == vertIndex)
+					{
+						const float* face = &faceTangents[4 * (corners[i] / 3)];
+						ownTangent[0] += face[0];
+						ownTangent[1] += face[1];
+						ownTangent[2] += face[2];
+						handednessSum += face[3];
+					}
+				}
+				float handedness = (handednessSum < 0.0f) ? -1.0f : 1.0f;
+				float ownLength = sqrtf((ownTangent[0] * ownTangent[0]) + (ownTangent[1] * ownTangent[1]) + (ownTangent[2] * ownTangent[2]));
+
+				// pool with the matching faces of coincident vertices
+				// NOTE: A vertex whose own faces are all degenerate borrows from any face of the same handedness
+				float tangent[3] = {0.0f, 0.0f, 0.0f};
+				for (size_t i = 0; i < cornerCount; i++)
+				{
+					const float* face = &faceTangents[4 * (corners[i] / 3)];
+					float alignment = (face[0] * ownTangent[0]) + (face[1] * ownTangent[1]) + (face[2] * ownTangent[2]);
+					if ((face[3] == handedness) && ((indices[corners[i]] == vertIndex) || (ownLength == 0.0f) ||
+						(alignment > (TANGENT_SMOOTHING_COS * ownLength))))
+					{
+						tangent[0] += face[0];
+						tangent[1] += face[1];
+						tangent[2] += face[2];
+					}
+				}
+
+				// Gram-Schmidt against the normal
+				const float* vertexNormal = &normals[3 * vertIndex];
+				float normalLength = sqrtf((vertexNormal[0] * vertexNormal[0]) + (vertexNormal[1] * vertexNormal[1]) + (vertexNormal[2] * vertexNormal[2]));
+				float normal[3] = {0.0f, 0.0f, 1.0f};
+				if (normalLength > 0.0f)
+				{
+					normal[0] = vertexNormal[0] / normalLength;
+					normal[1] = vertexNormal[1] / normalLength;
+					normal[2] = vertexNormal[2] / normalLength;
+				}
+				float projection = (tangent[0] * normal[0]) + (tangent[1] * normal[1]) + (tangent[2] * normal[2]);
+				tangent[0] -= projection * normal[0];
+				tangent[1] -= projection * normal[1];
+				tangent[2] -= projection * normal[2];
+				float tangentLength = sqrtf((tangent[0] * tangent[0]) + (tangent[1] * tangent[1]) + (tangent[2] * tangent[2]));
+				if (tangentLength > 1e-6f)
+				{
+					tangent[0] /= tangentLength;
+					tangent[1] /= tangentLength;
+					tangent[2] /= tangentLength;
+				}
+				else
+				{
+					perpendicularTo(normal, tangent);
+				}
+
+				// store the frame
+				float* outputTangent = &tangents[3 * vertIndex];
+				float* outputBitangent = &bitangents[3 * vertIndex];
+				outputTangent[0] = tangent[0];
+				outputTangent[1] = tangent[1];
+				outputTangent[2] = tangent[2];
+				outputBitangent[0] = handedness * ((normal[1] * tangent[2]) - (normal[2] * tangent[1]));
+				outputBitangent[1] = handedness * ((normal[2] * tangent[0]) - (normal[0] * tangent[2]));
+				outputBitangent[2] = handedness * ((normal[0] * tangent[1]) - (normal[1] * tangent[0]));
+			}
+		});
+	}
+}
@@ -0,0 +1,28 @@
+//// Declaration Guards
+#ifndef TANGENTS_H
+#define TANGENTS_H
+
+//// Imports
+#include <stddef.h>
+
+namespace SWPTAS001
+{
+	//// Tangent Routines
+	void generateTangentFrames(const float* positions, const float* normals, const float* textureCoords, size_t vertexCount,
+		const unsigned int* indices, size_t indexCount, float* tangents, float* bitangents, int threadCount);
+}
+
+#endif
+
+// NOTE: generateTangentFrames() writes an orthonormal tangent frame for every vertex of an indexed
+//       triangle list: the tangent is Gram-Schmidt orthogonalized against the vertex normal, and the
+//       bitangent is cross(normal, tangent) times the handedness of the UV mapping, so mirrored UVs get
+//       a flipped bitangent instead of a skewed one
+// NOTE: Vertices sharing a position and a normal (e.g. the two sides of a UV seam) pool their face
+//       tangents, so the frame is continuous across the seam. Only faces of the same handedness whose
+//       tangent is within 45 degrees of the vertex's own faces are pooled, which keeps poles and
+//       mirrored seams from averaging opposing directions away
+// NOTE: Faces whose UVs are degenerate (zero UV area) contribute nothing, and a vertex left without any
+//       tangent gets an arbitrary one perpendicular to its normal, so the frame is always well formed
+// NOTE: Face tangents are computed 4 faces at a time with SSE2 where available, and both passes are
+//       split across threads. The result doesn't depend on the thread count
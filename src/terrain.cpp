@@ -0,0 +1,740 @@
+//// Header
+#include "terrain.h"
+
+//// Imports
+#include "spheres.h"
+#include "parallel.h"
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+//// Namespaces
+using namespace std;
+
+namespace SWPTAS001
+{
+	//// Constants
+	static const float PI = 3.14159265f;
+	static const float MORPH_START = 0.75f; // fraction of a depth's range where its vertices start to morph
+	static const float MIN_RANGE_FACTOR = 3.0f; // ranges below 3 chunk edges can put morphing chunks next to finer ones
+	static const int IN_FLIGHT_FRAMES = 4; // chunks queued or built but not uploaded yet, in frames worth of uploads
+	static const int MIN_POOL_CHUNKS = 6 + (4 * TERRAIN_MAX_DEPTH);
+
+	/////////////
+	// Helpers //
+	/////////////
+
+	static void decodeChunkKey(uint64_t key, int& face, int& depth, int& x, int& y)
+	{
+		face = (int)(key & 7);
+		depth = (int)((key >> 3) & 31);
+		x = (int)((key >> 8) & 0xFFFFF);
+		y = (int)((key >> 28) & 0xFFFFF);
+	}
+
+	// Longitude of a unit direction as a texture coord in [0, 1], matching the UV sphere of planet.obj
+	static float longitudeCoord(const float* direction)
+	{
+		float u = -atan2f(direction[2], direction[0]) / (2.0f * PI);
+		return (u < 0.0f) ? (u + 1.0f) : u;
+	}
+
+	// Latitude of a unit direction as a texture coord in [0, 1]
+	static float latitudeCoord(const float* direction)
+	{
+		return 0.5f + (asinf(max(-1.0f, min(direction[1], 1.0f))) / PI);
+	}
+
+	// Point of the planet's surface above a point of a cube face, raised by the height map if there is one
+	static void surfacePoint(const TerrainSettings& settings, int face, float u, float v, float* point)
+	{
+		float direction[3];
+		cubeSpherePoint(face, u, v, direction);
+		float radius = settings.radius;
+		if (settings.heightMap)
+		{
+			radius += sampleHeight(*settings.heightMap, longitudeCoord(direction), latitudeCoord(direction)) * settings.maxHeight;
+		}
+		for (int axis = 0; axis < 3; axis++)
+		{
+			point[axis] = direction[axis] * radius;
+		}
+	}
+
+	//////////////////
+	// Constructors //
+	//////////////////
+
+	PlanetTerrain::PlanetTerrain()
+	{
+		memset(&fStats, 0, sizeof(TerrainStats));
+		fFrame = 0;
+		fCamera = glm::vec3(0.0f, 0.0f, 0.0f);
+		fFrustumPlanes = NULL;
+		fHorizonAngle = PI;
+		fStopping = false;
+	}
+
+	PlanetTerrain::~PlanetTerrain()
+	{
+		destroy();
+	}
+
+	///////////
+	// Setup //
+	///////////
+
+	void PlanetTerrain::create(TerrainSettings settings)
+	{
+		// reset
+		destroy();
+		fSettings = settings;
+		fSettings.maxDepth = max(0, min(fSettings.maxDepth, TERRAIN_MAX_DEPTH));
+		fSettings.poolChunks = max(fSettings.poolChunks, MIN_POOL_CHUNKS);
+		fSettings.uploadsPerFrame = max(fSettings.uploadsPerFrame, 1);
+		buildIndices();
+		fRanges.assign(fSettings.maxDepth + 1, 0.0f);
+		for (int slot = fSettings.poolChunks - 1; slot >= 0; slot--)
+		{
+			fFreeSlots.push_back(slot);
+		}
+
+		// the roots are built right away and never leave the pool
+		for (int face = 0; face < 6; face++)
+		{
+			BuiltChunk root;
+			root.key = chunkKey(face, 0, 0, 0);
+			root.vertices.resize(TERRAIN_CHUNK_VERTICES * TERRAIN_VERTEX_FLOATS);
+			buildChunk(root.key, root.vertices.data());
+			int slot;
+			takeSlot(slot);
+			makeResident(root.key, slot, true);
+			fUploading.push_back(BuiltChunk());
+			fUploading.back().key = root.key;
+			fUploading.back().vertices.swap(root.vertices);
+			TerrainUpload upload = {slot, fUploading.back().vertices.data()};
+			fUploads.push_back(upload);
+		}
+		fStats.builtChunks = 6;
+
+		// start the builders
+		// NOTE: The rendering thread is left out, it has a frame to draw
+		int builderCount = max(1, resolveThreadCount(fSettings.threadCount) - 1);
+		for (int builder = 0; builder < builderCount; builder++)
+		{
+			fBuilders.push_back(thread(&PlanetTerrain::builderLoop, this));
+		}
+		cout << "    - Planet terrain: 6 root chunks of " << TERRAIN_CHUNK_QUADS << " x " << TERRAIN_CHUNK_QUADS << " quads, "
+			<< fSettings.maxDepth << " levels below them, a pool of " << fSettings.poolChunks << " chunks ("
+			<< (((size_t)fSettings.poolChunks * TERRAIN_CHUNK_VERTICES * vertexStride()) >> 20) << " MB) and "
+			<< builderCount << " builder thread(s)" << endl;
+	}
+
+	void PlanetTerrain::destroy()
+	{
+		// stop the builders
+		{
+			lock_guard<mutex> lock(fBuildMutex);
+			fStopping = true;
+		}
+		fBuildSignal.notify_all();
+		for (size_t builder = 0; builder < fBuilders.size(); builder++)
+		{
+			fBuilders[builder].join();
+		}
+		fBuilders.clear();
+		fStopping = false;
+
+		// drop every chunk
+		fBuildQueue.clear();
+		fBuilding.clear();
+		fBuilt.clear();
+		fSpareBuffers.clear();
+		fChunks.clear();
+		fLeastRecentlyUsed.clear();
+		fFreeSlots.clear();
+		fDraws.clear();
+		fUploads.clear();
+		fUploading.clear();
+		fWanted.clear();
+		memset(&fStats, 0, sizeof(TerrainStats));
+		fFrame = 0;
+	}
+
+	void PlanetTerrain::buildIndices()
+	{
+		// NOTE: Quads are listed one quadrant at a time, so a quadrant of any chunk can be drawn on its own,
+		//       and every quad is split along the same diagonal, which the morph targets rely on
+		const int half = TERRAIN_CHUNK_QUADS / 2;
+		fIndices.clear();
+		fIndices.reserve(TERRAIN_CHUNK_QUADS * TERRAIN_CHUNK_QUADS * 6);
+		for (int quadrant = 0; quadrant < 4; quadrant++)
+		{
+			for (int row = (quadrant >> 1) * half; row < ((quadrant >> 1) + 1) * half; row++)
+			{
+				for (int column = (quadrant & 1) * half; column < ((quadrant & 1) + 1) * half; column++)
+				{
+					unsigned short corner = (unsigned short)((row * TERRAIN_CHUNK_SIDE) + column);
+					unsigned short across = corner + 1;
+					unsigned short up = corner + TERRAIN_CHUNK_SIDE;
+					const unsigned short quad[6] = {corner, across, (unsigned short)(up + 1), corner, (unsigned short)(up + 1), up};
+					fIndices.insert(fIndices.end(), quad, quad + 6);
+				}
+			}
+		}
+	}
+
+	///////////////
+	// Per Frame //
+	///////////////
+
+	void PlanetTerrain::update(glm::vec3 cameraPosition, const glm::vec4* frustumPlanes, float pixelsPerUnit)
+	{
+		// initialize
+		fFrame++;
+		finishUploads();
+		fCamera = cameraPosition;
+		fFrustumPlanes = frustumPlanes;
+		fDraws.clear();
+		fWanted.clear();
+		fStats.drawnChunks = 0;
+		fStats.culledChunks = 0;
+
+		// move finished chunks into the pool
+		collectBuiltChunks();
+
+		// size the ranges so a quad stays under quadPixels on screen
+		// NOTE: A chunk at depth d spans a quarter of a great circle over 2^d, so ranges halve with depth
+		float rangeFactor = max(MIN_RANGE_FACTOR, pixelsPerUnit / (TERRAIN_CHUNK_QUADS * fSettings.quadPixels));
+		for (int depth = 0; depth <= fSettings.maxDepth; depth++)
+		{
+			fRanges[depth] = rangeFactor * fSettings.radius * (PI * 0.5f) / (float)(1 << depth);
+		}
+		float cameraDistance = glm::length(fCamera);
+		fHorizonAngle = PI;
+		if (cameraDistance > fSettings.radius)
+		{
+			fHorizonAngle = acosf(fSettings.radius / cameraDistance) + acosf(fSettings.radius / (fSettings.radius + fSettings.maxHeight));
+		}
+
+		// select
+		for (int face = 0; face < 6; face++)
+		{
+			uint64_t root = chunkKey(face, 0, 0, 0);
+			if (chunkVisible(chunkBounds(root)))
+			{
+				selectChunk(root, 0);
+			}
+			else
+			{
+				fStats.culledChunks++;
+			}
+		}
+
+		// group the draws by depth, so the morph range changes once per depth
+		stable_sort(fDraws.begin(), fDraws.end(), [](const TerrainDraw& a, const TerrainDraw& b) { return a.depth < b.depth; });
+
+		// queue the most urgent missing chunks, replacing whatever last frame wanted
+		sort(fWanted.begin(), fWanted.end(), [](const WantedChunk& a, const WantedChunk& b)
+		{
+			return (a.depth != b.depth) ? (a.depth < b.depth) : (a.distance < b.distance);
+		});
+		{
+			// NOTE: Only a few frames worth of uploads are kept in flight, whatever is built beyond that
+			//       would just wait for the uploads while the camera moves on
+			lock_guard<mutex> lock(fBuildMutex);
+			fBuildQueue.clear();
+			size_t inFlightLimit = (size_t)(IN_FLIGHT_FRAMES * fSettings.uploadsPerFrame);
+			for (size_t wanted = 0; (wanted < fWanted.size()) && ((fBuildQueue.size() + fBuilding.size()) < inFlightLimit); wanted++)
+			{
+				if (fBuilding.find(fWanted[wanted].key) == fBuilding.end())
+				{
+					fBuildQueue.push_back(fWanted[wanted].key);
+				}
+			}
+			fStats.pendingChunks = (int)(fBuildQueue.size() + fBuilding.size());
+		}
+		fBuildSignal.notify_all();
+		fStats.residentChunks = (int)fChunks.size();
+	}
+
+	void PlanetTerrain::selectChunk(uint64_t key, int depth)
+	{
+		// NOTE: Only resident chunks get here, the roots always are and children only once built
+		Chunk& chunk = fChunks[key];
+		touchChunk(chunk);
+		int slot = chunk.slot;
+		if (depth == fSettings.maxDepth)
+		{
+			addDraw(slot, depth, -1);
+			return;
+		}
+
+		// split into whichever children are needed and ready, the parent covers the rest
+		int face, chunkDepth, x, y;
+		decodeChunkKey(key, face, chunkDepth, x, y);
+		for (int quadrant = 0; quadrant < 4; quadrant++)
+		{
+			uint64_t child = chunkKey(face, depth + 1, (2 * x) + (quadrant & 1), (2 * y) + (quadrant >> 1));
+			ChunkBounds bounds = chunkBounds(child);
+			if (!chunkVisible(bounds))
+			{
+				fStats.culledChunks++;
+				continue;
+			}
+			float distance = chunkDistance(bounds);
+			if (distance >= fRanges[depth + 1])
+			{
+				addDraw(slot, depth, quadrant);
+			}
+			else if (fChunks.find(child) != fChunks.end())
+			{
+				selectChunk(child, depth + 1);
+			}
+			else
+			{
+				WantedChunk wanted = {depth + 1, distance, child};
+				fWanted.push_back(wanted);
+				addDraw(slot, depth, quadrant);
+			}
+		}
+	}
+
+	void PlanetTerrain::addDraw(int slot, int depth, int quadrant)
+	{
+		// NOTE: Quadrants of the same chunk drawn one after the other become a single draw
+		unsigned int quadrantIndices = (unsigned int)(fIndices.size() / 4);
+		unsigned int offset = (quadrant < 0) ? 0 : (quadrant * quadrantIndices);
+		unsigned int count = (quadrant < 0) ? (unsigned int)fIndices.size() : quadrantIndices;
+		if (!fDraws.empty() && (fDraws.back().slot == slot) && ((fDraws.back().indexOffset + fDraws.back().indexCount) == offset))
+		{
+			fDraws.back().indexCount += count;
+			return;
+		}
+		float morphEnd = (depth > 0) ? fRanges[depth] : 0.0f;
+		TerrainDraw draw = {slot, depth, offset, count, morphEnd * MORPH_START, morphEnd};
+		fDraws.push_back(draw);
+		fStats.drawnChunks++;
+	}
+
+	int PlanetTerrain::uploadCount()
+	{
+		return (int)fUploads.size();
+	}
+
+	const TerrainUpload* PlanetTerrain::uploadData()
+	{
+		return fUploads.empty() ? NULL : &fUploads[0];
+	}
+
+	void PlanetTerrain::finishUploads()
+	{
+		// hand the vertex buffers back to the builders
+		lock_guard<mutex> lock(fBuildMutex);
+		for (size_t upload = 0; upload < fUploading.size(); upload++)
+		{
+			fSpareBuffers.push_back(vector<float>());
+			fSpareBuffers.back().swap(fUploading[upload].vertices);
+		}
+		fUploading.clear();
+		fUploads.clear();
+	}
+
+	int PlanetTerrain::drawCount()
+	{
+		return (int)fDraws.size();
+	}
+
+	const TerrainDraw* PlanetTerrain::drawData()
+	{
+		return fDraws.empty() ? NULL : &fDraws[0];
+	}
+
+	const TerrainStats& PlanetTerrain::stats()
+	{
+		return fStats;
+	}
+
+	/////////////
+	// Culling //
+	/////////////
+
+	PlanetTerrain::ChunkBounds PlanetTerrain::chunkBounds(uint64_t key)
+	{
+		// NOTE: Chunk edges follow great circles, so no point of a chunk is further from its centre than
+		//       its corners are
+		int face, depth, x, y;
+		decodeChunkKey(key, face, depth, x, y);
+		float size = 1.0f / (float)(1 << depth);
+		ChunkBounds bounds;
+		cubeSpherePoint(face, (x + 0.5f) * size, (y + 0.5f) * size, &bounds.direction[0]);
+		float chord = 0.0f;
+		for (int corner = 0; corner < 4; corner++)
+		{
+			glm::vec3 point;
+			cubeSpherePoint(face, (x + (corner & 1)) * size, (y + (corner >> 1)) * size, &point[0]);
+			chord = max(chord, glm::length(point - bounds.direction));
+		}
+		// NOTE: Centred halfway up the heights, so they only add half of maxHeight
+		bounds.center = bounds.direction * (fSettings.radius + (fSettings.maxHeight * 0.5f));
+		bounds.radius = (chord * (fSettings.radius + fSettings.maxHeight)) + (fSettings.maxHeight * 0.5f);
+		bounds.angle = 2.0f * asinf(min(1.0f, chord * 0.5f));
+		bounds.flatRadius = chord * fSettings.radius;
+		return bounds;
+	}
+
+	bool PlanetTerrain::chunkVisible(const ChunkBounds& bounds)
+	{
+		// behind the horizon
+		float cameraDistance = glm::length(fCamera);
+		if ((fHorizonAngle < PI) && (cameraDistance > 0.0f))
+		{
+			float cosine = max(-1.0f, min(glm::dot(bounds.direction, fCamera) / cameraDistance, 1.0f));
+			if ((acosf(cosine) - bounds.angle) > fHorizonAngle)
+			{
+				return false;
+			}
+		}
+
+		// outside the view
+		if (fFrustumPlanes)
+		{
+			for (int plane = 0; plane < 6; plane++)
+			{
+				if ((glm::dot(glm::vec3(fFrustumPlanes[plane]), bounds.center) + fFrustumPlanes[plane].w) < -bounds.radius)
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	float PlanetTerrain::chunkDistance(const ChunkBounds& bounds)
+	{
+		// NOTE: Measured to the undisplaced sphere like the morph in the vertex shader, heights would pad
+		//       the bounds of fine chunks well beyond their size and the ranges could no longer keep the
+		//       morph bands of neighbouring depths apart
+		return max(0.0f, glm::length(fCamera - (bounds.direction * fSettings.radius)) - bounds.flatRadius);
+	}
+
+	//////////
+	// Pool //
+	//////////
+
+	void PlanetTerrain::touchChunk(Chunk& chunk)
+	{
+		chunk.lastUsed = fFrame;
+		if (chunk.lruEntry != fLeastRecentlyUsed.end())
+		{
+			fLeastRecentlyUsed.splice(fLeastRecentlyUsed.begin(), fLeastRecentlyUsed, chunk.lruEntry);
+		}
+	}
+
+	bool PlanetTerrain::takeSlot(int& slot)
+	{
+		// NOTE: Chunks drawn last frame may still be drawn this frame, so only older ones are evicted
+		if (!fFreeSlots.empty())
+		{
+			slot = fFreeSlots.back();
+			fFreeSlots.pop_back();
+			return true;
+		}
+		if (fLeastRecentlyUsed.empty() || (fChunks[fLeastRecentlyUsed.back()].lastUsed + 1 >= fFrame))
+		{
+			return false;
+		}
+		uint64_t evicted = fLeastRecentlyUsed.back();
+		slot = fChunks[evicted].slot;
+		fChunks.erase(evicted);
+		fLeastRecentlyUsed.pop_back();
+		fStats.evictedChunks++;
+		return true;
+	}
+
+	void PlanetTerrain::makeResident(uint64_t key, int slot, bool pinned)
+	{
+		Chunk chunk;
+		chunk.slot = slot;
+		chunk.lastUsed = fFrame;
+		chunk.lruEntry = pinned ? fLeastRecentlyUsed.end() : fLeastRecentlyUsed.insert(fLeastRecentlyUsed.begin(), key);
+		fChunks[key] = chunk;
+	}
+
+	void PlanetTerrain::collectBuiltChunks()
+	{
+		// take this frame's share of the finished chunks
+		{
+			lock_guard<mutex> lock(fBuildMutex);
+			size_t takeCount = min(fBuilt.size(), (size_t)fSettings.uploadsPerFrame);
+			for (size_t built = 0; built < takeCount; built++)
+			{
+				fBuilding.erase(fBuilt[built].key);
+				fUploading.push_back(BuiltChunk());
+				fUploading.back().key = fBuilt[built].key;
+				fUploading.back().vertices.swap(fBuilt[built].vertices);
+			}
+			fBuilt.erase(fBuilt.begin(), fBuilt.begin() + takeCount);
+		}
+
+		// give each a slot, or drop it when the pool is full of chunks still in use
+		size_t kept = 0;
+		for (size_t built = 0; built < fUploading.size(); built++)
+		{
+			int slot;
+			if ((fChunks.find(fUploading[built].key) != fChunks.end()) || !takeSlot(slot))
+			{
+				continue;
+			}
+			makeResident(fUploading[built].key, slot, false);
+			fStats.builtChunks++;
+			fUploading[kept].key = fUploading[built].key;
+			fUploading[kept].vertices.swap(fUploading[built].vertices);
+			kept++;
+		}
+		{
+			lock_guard<mutex> lock(fBuildMutex);
+			for (size_t dropped = kept; dropped < fUploading.size(); dropped++)
+			{
+				fSpareBuffers.push_back(vector<float>());
+				fSpareBuffers.back().swap(fUploading[dropped].vertices);
+			}
+		}
+		fUploading.resize(kept);
+		for (size_t built = 0; built < fUploading.size(); built++)
+		{
+			TerrainUpload upload = {fChunks[fUploading[built].key].slot, fUploading[built].vertices.data()};
+			fUploads.push_back(upload);
+		}
+	}
+
+	//////////////
+	// Builders //
+	//////////////
+
+	void PlanetTerrain::builderLoop()
+	{
+		while (true)
+		{
+			// wait for work
+			unique_lock<mutex> lock(fBuildMutex);
+			fBuildSignal.wait(lock, [this]() { return fStopping || !fBuildQueue.empty(); });
+			if (fStopping)
+			{
+				return;
+			}
+			uint64_t key = fBuildQueue.front();
+			fBuildQueue.pop_front();
+			fBuilding.insert(key);
+			vector<float> vertices;
+			if (!fSpareBuffers.empty())
+			{
+				vertices.swap(fSpareBuffers.back());
+				fSpareBuffers.pop_back();
+			}
+			lock.unlock();
+
+			// build outside the lock
+			vertices.resize(TERRAIN_CHUNK_VERTICES * TERRAIN_VERTEX_FLOATS);
+			buildChunk(key, vertices.data());
+			lock.lock();
+			fBuilt.push_back(BuiltChunk());
+			fBuilt.back().key = key;
+			fBuilt.back().vertices.swap(vertices);
+		}
+	}
+
+	void PlanetTerrain::buildChunk(uint64_t key, float* vertices)
+	{
+		// NOTE: Grid points are counted on the lattice of the deepest level, where every coordinate is an
+		//       exact float, so a chunk and its parent (or a neighbour) agree exactly on the points they share
+		int face, depth, x, y;
+		decodeChunkKey(key, face, depth, x, y);
+		const float lattice = (float)(TERRAIN_CHUNK_QUADS << fSettings.maxDepth);
+		const int step = 1 << (fSettings.maxDepth - depth);
+		const int originX = x * TERRAIN_CHUNK_QUADS * step;
+		const int originY = y * TERRAIN_CHUNK_QUADS * step;
+
+		// the surface at every grid point, and at a ring of points around the grid for the normals
+		const int ringSide = TERRAIN_CHUNK_SIDE + 2;
+		vector<float> ring((size_t)ringSide * ringSide * 3);
+		for (int row = -1; row <= TERRAIN_CHUNK_SIDE; row++)
+		{
+			for (int column = -1; column <= TERRAIN_CHUNK_SIDE; column++)
+			{
+				bool inside = (row >= 0) && (row < TERRAIN_CHUNK_SIDE) && (column >= 0) && (column < TERRAIN_CHUNK_SIDE);
+				if (inside || fSettings.heightMap)
+				{
+					surfacePoint(fSettings, face, (originX + (column * step)) / lattice, (originY + (row * step)) / lattice,
+						&ring[(((row + 1) * ringSide) + (column + 1)) * 3]);
+				}
+			}
+		}
+
+		// positions, normals and longitudes
+		float lowest = 1.0f;
+		float highest = 0.0f;
+		for (int row = 0; row < TERRAIN_CHUNK_SIDE; row++)
+		{
+			for (int column = 0; column < TERRAIN_CHUNK_SIDE; column++)
+			{
+				float* vertex = vertices + (((row * TERRAIN_CHUNK_SIDE) + column) * TERRAIN_VERTEX_FLOATS);
+				const float* point = &ring[(((row + 1) * ringSide) + (column + 1)) * 3];
+				float direction[3];
+				cubeSpherePoint(face, (originX + (column * step)) / lattice, (originY + (row * step)) / lattice, direction);
+				for (int axis = 0; axis < 3; axis++)
+				{
+					vertex[axis] = point[axis];
+					vertex[3 + axis] = direction[axis];
+				}
+				if (fSettings.heightMap)
+				{
+					// NOTE: Across the neighbours on either side, turned outwards whichever way the face runs
+					const float* west = point - 3;
+					const float* east = point + 3;
+					const float* south = point - (ringSide * 3);
+					const float* north = point + (ringSide * 3);
+					glm::vec3 across(east[0] - west[0], east[1] - west[1], east[2] - west[2]);
+					glm::vec3 up(north[0] - south[0], north[1] - south[1], north[2] - south[2]);
+					glm::vec3 normal = glm::cross(across, up);
+					float length = glm::length(normal);
+					normal *= ((glm::dot(normal, glm::vec3(direction[0], direction[1], direction[2])) < 0.0f) ? -1.0f : 1.0f) / length;
+					vertex[3] = normal.x;
+					vertex[4] = normal.y;
+					vertex[5] = normal.z;
+				}
+				vertex[6] = longitudeCoord(direction);
+				vertex[7] = latitudeCoord(direction);
+				bool pole = ((direction[0] * direction[0]) + (direction[2] * direction[2])) < 1e-12f;
+				lowest = pole ? lowest : min(lowest, vertex[6]);
+				highest = pole ? highest : max(highest, vertex[6]);
+			}
+		}
+
+		// texture coords and tangent frames
+		// NOTE: Chunks across the seam wrap their western longitudes past 1, and a pole takes the longitude
+		//       of its neighbour towards the middle of the chunk. The tangent points east along the longitude
+		bool wraps = (highest - lowest) > 0.5f;
+		for (int row = 0; row < TERRAIN_CHUNK_SIDE; row++)
+		{
+			for (int column = 0; column < TERRAIN_CHUNK_SIDE; column++)
+			{
+				float* vertex = vertices + (((row * TERRAIN_CHUNK_SIDE) + column) * TERRAIN_VERTEX_FLOATS);
+				vertex[6] += (wraps && (vertex[6] < 0.5f)) ? 1.0f : 0.0f;
+			}
+		}
+		for (int row = 0; row < TERRAIN_CHUNK_SIDE; row++)
+		{
+			for (int column = 0; column < TERRAIN_CHUNK_SIDE; column++)
+			{
+				float* vertex = vertices + (((row * TERRAIN_CHUNK_SIDE) + column) * TERRAIN_VERTEX_FLOATS);
+				const float* normal = vertex + 3;
+				const float* position = vertex;
+				if (((position[0] * position[0]) + (position[2] * position[2])) < 1e-12f)
+				{
+					int inwardRow = row + ((row < (TERRAIN_CHUNK_QUADS / 2)) ? 1 : -1);
+					int inwardColumn = column + ((column < (TERRAIN_CHUNK_QUADS / 2)) ? 1 : -1);
+					vertex[6] = vertices[(((inwardRow * TERRAIN_CHUNK_SIDE) + inwardColumn) * TERRAIN_VERTEX_FLOATS) + 6];
+				}
+				float longitude = -2.0f * PI * vertex[6];
+				float* tangent = vertex + 8;
+				float* bitangent = vertex + 11;
+				tangent[0] = sinf(longitude);
+				tangent[1] = 0.0f;
+				tangent[2] = -cosf(longitude);
+				// NOTE: Raised normals lean away from the sphere's, the tangent has to follow
+				float lean = (normal[0] * tangent[0]) + (normal[2] * tangent[2]);
+				float tangentLength = 0.0f;
+				for (int axis = 0; axis < 3; axis++)
+				{
+					tangent[axis] -= normal[axis] * lean;
+					tangentLength += tangent[axis] * tangent[axis];
+				}
+				tangentLength = sqrtf(tangentLength);
+				for (int axis = 0; axis < 3; axis++)
+				{
+					tangent[axis] /= tangentLength;
+				}
+				bitangent[0] = (normal[1] * tangent[2]) - (normal[2] * tangent[1]);
+				bitangent[1] = (normal[2] * tangent[0]) - (normal[0] * tangent[2]);
+				bitangent[2] = (normal[0] * tangent[1]) - (normal[1] * tangent[0]);
+			}
+		}
+
+		// morph targets: where the parent's grid puts each vertex
+		// NOTE: Vertices between two parent vertices land halfway along that edge, and ones in the middle
+		//       of a parent quad halfway along its diagonal. Roots have no parent and stay put
+		for (int row = 0; row < TERRAIN_CHUNK_SIDE; row++)
+		{
+			for (int column = 0; column < TERRAIN_CHUNK_SIDE; column++)
+			{
+				float* vertex = vertices + (((row * TERRAIN_CHUNK_SIDE) + column) * TERRAIN_VERTEX_FLOATS);
+				int rowStep = (depth > 0) ? (row & 1) : 0;
+				int columnStep = (depth > 0) ? (column & 1) : 0;
+				const float* before = vertices + ((((row - rowStep) * TERRAIN_CHUNK_SIDE) + (column - columnStep)) * TERRAIN_VERTEX_FLOATS);
+				const float* after = vertices + ((((row + rowStep) * TERRAIN_CHUNK_SIDE) + (column + columnStep)) * TERRAIN_VERTEX_FLOATS);
+				for (int axis = 0; axis < 3; axis++)
+				{
+					vertex[14 + axis] = (before[axis] + after[axis]) * 0.5f;
+				}
+			}
+		}
+	}
+
+	uint64_t PlanetTerrain::chunkKey(int face, int depth, int x, int y)
+	{
+		return (uint64_t)face | ((uint64_t)depth << 3) | ((uint64_t)x << 8) | ((uint64_t)y << 28);
+	}
+
+	////////////////////
+	// Shared Buffers //
+	////////////////////
+
+	VertexLayout PlanetTerrain::vertexLayout()
+	{
+		// NOTE: Every chunk vertex is position, normal, uv, tangent and bitangent, as floats, followed by the
+		//       morph target at morphOffset()
+		VertexLayout layout;
+		const int components[VERTEX_ATTRIBUTE_COUNT] = {3, 3, 2, 3, 3, 0};
+		int offset = 0;
+		for (int attribute = 0; attribute < VERTEX_ATTRIBUTE_COUNT; attribute++)
+		{
+			layout.components[attribute] = components[attribute];
+			layout.offsets[attribute] = offset;
+			layout.formats[attribute] = FLOAT_FORMAT;
+			offset += components[attribute] * sizeof(float);
+		}
+		layout.stride = vertexStride();
+		return layout;
+	}
+
+	int PlanetTerrain::morphOffset()
+	{
+		return 14 * sizeof(float);
+	}
+
+	int PlanetTerrain::vertexStride()
+	{
+		return TERRAIN_VERTEX_FLOATS * sizeof(float);
+	}
+
+	int PlanetTerrain::slotCount()
+	{
+		return fSettings.poolChunks;
+	}
+
+	int PlanetTerrain::indexCount()
+	{
+		return (int)fIndices.size();
+	}
+
+	const unsigned short* PlanetTerrain::indexData()
+	{
+		return fIndices.empty() ? NULL : &fIndices[0];
+	}
+
+	float PlanetTerrain::radius()
+	{
+		return fSettings.radius;
+	}
+}
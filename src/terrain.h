@@ -0,0 +1,193 @@
+//// Declaration Guards
+#ifndef TERRAIN_H
+#define TERRAIN_H
+
+//// Imports
+#include <GLM/glm.hpp>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include <list>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "geometry.h"
+#include "heightmap.h"
+
+namespace SWPTAS001
+{
+	//// Constants
+	static const int TERRAIN_CHUNK_QUADS = 32; // quads along each edge of a chunk, a power of 2
+	static const int TERRAIN_CHUNK_SIDE = TERRAIN_CHUNK_QUADS + 1;
+	static const int TERRAIN_CHUNK_VERTICES = TERRAIN_CHUNK_SIDE * TERRAIN_CHUNK_SIDE;
+	static const int TERRAIN_VERTEX_FLOATS = 17; // position, normal, uv, tangent, bitangent, morph target
+	static const int TERRAIN_MAX_DEPTH = 12;
+
+	//// Structures
+	struct TerrainSettings
+	{
+		float radius = 1.72f; // of the planet, in object space
+		float maxHeight = 0.0f; // highest point above the radius, for bounds and horizon culling
+		const HeightMap* heightMap = NULL; // raises the surface by up to maxHeight, NULL for a smooth sphere
+		int maxDepth = 10; // deepest quadtree level, at most TERRAIN_MAX_DEPTH
+		float quadPixels = 8.0f; // on-screen size a chunk quad may reach before the chunk is split
+		int poolChunks = 512; // chunks kept resident in the vertex pool
+		int uploadsPerFrame = 8; // finished chunks moved into the pool each frame
+		int threadCount = 0; // chunk builders, 0 uses every available core
+	};
+
+	struct TerrainDraw
+	{
+		int slot; // pool slot holding the chunk's vertices
+		int depth;
+		unsigned int indexOffset; // into indexData(), the whole chunk or one quadrant of it
+		unsigned int indexCount;
+		float morphStart; // object space distances over which vertices morph to the parent's grid
+		float morphEnd;
+	};
+
+	struct TerrainUpload
+	{
+		int slot;
+		const float* vertices; // TERRAIN_CHUNK_VERTICES * TERRAIN_VERTEX_FLOATS
+	};
+
+	struct TerrainStats
+	{
+		int drawnChunks;
+		int culledChunks;
+		int residentChunks;
+		int pendingChunks;
+		int builtChunks; // since create()
+		int evictedChunks;
+	};
+
+	//// Classes
+	class PlanetTerrain
+	{
+		public:
+			//// Constructors
+			PlanetTerrain();
+			~PlanetTerrain();
+			//// Setup
+			void create(TerrainSettings settings);
+			void destroy();
+			//// Per Frame
+			void update(glm::vec3 cameraPosition, const glm::vec4* frustumPlanes, float pixelsPerUnit);
+			int uploadCount();
+			const TerrainUpload* uploadData();
+			void finishUploads();
+			int drawCount();
+			const TerrainDraw* drawData();
+			const TerrainStats& stats();
+			//// Shared Buffers
+			VertexLayout vertexLayout();
+			int morphOffset();
+			int vertexStride();
+			int slotCount();
+			int indexCount();
+			const unsigned short* indexData();
+			//// Geometry
+			float radius();
+			void buildChunk(uint64_t key, float* vertices);
+			static uint64_t chunkKey(int face, int depth, int x, int y);
+
+		private:
+			//// Chunk State
+			struct Chunk
+			{
+				int slot;
+				unsigned int lastUsed; // frame
+				std::list<uint64_t>::iterator lruEntry; // fLeastRecentlyUsed.end() for the roots
+			};
+			struct ChunkBounds
+			{
+				glm::vec3 center;
+				float radius;
+				glm::vec3 direction; // unit direction to the centre of the chunk
+				float angle; // half the angle the chunk spans, seen from the planet centre
+				float flatRadius; // bounding radius of the chunk on the undisplaced sphere
+			};
+			struct BuiltChunk
+			{
+				uint64_t key;
+				std::vector<float> vertices;
+			};
+			struct WantedChunk
+			{
+				int depth;
+				float distance;
+				uint64_t key;
+			};
+			TerrainSettings fSettings;
+			std::unordered_map<uint64_t, Chunk> fChunks; // resident chunks only
+			std::list<uint64_t> fLeastRecentlyUsed; // resident chunks, most recently used first
+			std::vector<int> fFreeSlots;
+			std::vector<unsigned short> fIndices;
+			std::vector<float> fRanges; // per depth, distance within which the depth is needed
+			std::vector<TerrainDraw> fDraws;
+			std::vector<TerrainUpload> fUploads;
+			std::vector<BuiltChunk> fUploading;
+			std::vector<WantedChunk> fWanted;
+			TerrainStats fStats;
+			unsigned int fFrame;
+			//// Frame State
+			glm::vec3 fCamera;
+			const glm::vec4* fFrustumPlanes;
+			float fHorizonAngle;
+			//// Builders
+			std::vector<std::thread> fBuilders;
+			std::mutex fBuildMutex;
+			std::condition_variable fBuildSignal;
+			std::deque<uint64_t> fBuildQueue;
+			std::unordered_set<uint64_t> fBuilding; // taken by a builder, until collected
+			std::vector<BuiltChunk> fBuilt;
+			std::vector<std::vector<float> > fSpareBuffers;
+			bool fStopping;
+			//// Processing
+			void buildIndices();
+			ChunkBounds chunkBounds(uint64_t key);
+			bool chunkVisible(const ChunkBounds& bounds);
+			float chunkDistance(const ChunkBounds& bounds);
+			void selectChunk(uint64_t key, int depth);
+			void addDraw(int slot, int depth, int quadrant);
+			void touchChunk(Chunk& chunk);
+			bool takeSlot(int& slot);
+			void makeResident(uint64_t key, int slot, bool pinned);
+			void collectBuiltChunks();
+			void builderLoop();
+	};
+}
+
+#endif
+
+// NOTE: PlanetTerrain draws a planet as a cube-sphere whose 6 faces are each the root of a quadtree of
+//       chunks, every chunk the same grid of TERRAIN_CHUNK_QUADS x TERRAIN_CHUNK_QUADS quads, so all of them
+//       share one index buffer and one vertex format. It only decides what to draw and where the vertices
+//       go, the renderer owns the GL buffers: a vertex pool of slotCount() chunks, filled from the uploads
+//       of each update() and drawn with a base vertex of slot * TERRAIN_CHUNK_VERTICES
+
+// NOTE: Levels of detail follow CDLOD (Strugar, "Continuous Distance-Dependent Level of Detail for
+//       Rendering Heightmaps"): depth d is needed within a distance that halves with every depth, set so a
+//       quad stays under quadPixels on screen. A chunk is split where its children fall within their range,
+//       and a child that is out of range, or not built yet, is covered by its parent's quadrant instead.
+//       Every vertex also stores where its parent's grid puts it, and the vertex shader morphs towards that
+//       over the last quarter of the chunk's range, so levels blend without popping or cracks
+
+// NOTE: Chunks are culled against the view frustum and against the horizon: from a camera at distance d,
+//       nothing of a sphere of radius r that rises at most h is visible more than acos(r / d) +
+//       acos(r / (r + h)) away from the point below the camera
+
+// NOTE: Chunks are built on worker threads, most urgent first (coarsest, then nearest), and at most
+//       uploadsPerFrame of them go into the pool per frame, so flying low costs a steady amount per frame.
+//       The pool evicts the least recently used chunks, except the 6 roots, which are always resident
+
+// NOTE: With a heightMap, every vertex is raised by the map's height at its longitude and latitude, and
+//       the normals come from the raised neighbours (including those just outside the chunk), so they
+//       match across chunk edges. Shared vertices raise to exactly the same point, and morph targets are
+//       the parent's raised vertices. Normals don't morph, a finer chunk keeps its own. Levels of detail
+//       go by the distance to the undisplaced sphere (the vertex shader morphs by the distance from
+//       morphCamera to normalize(position) * morphRadius), heights only go into culling
@@ -0,0 +1,156 @@
+//// Header
+#include "texturecache.h"
+
+//// Imports
+#include "blockcompress.h"
+#include <iostream>
+#include <vector>
+#include <stdio.h>
+#include <string.h>
+
+//// Namespaces
+using namespace std;
+
+namespace SWPTAS001
+{
+	//// Constants
+	static const char TEXTURE_CACHE_MAGIC[8] = {'S', 'W', 'P', 'T', 'E', 'X', '\0', '\0'};
+	static const unsigned int TEXTURE_CACHE_VERSION = 4;
+	static const size_t TEXTURE_CACHE_ALIGNMENT = 4096;
+
+	/////////////
+	// Helpers //
+	/////////////
+
+	static inline size_t alignOffset(size_t offset)
+	{
+		return (offset + (TEXTURE_CACHE_ALIGNMENT - 1)) & ~(TEXTURE_CACHE_ALIGNMENT - 1);
+	}
+
+	////////////////////
+	// Cache Routines //
+	////////////////////
+
+	string textureCachePath(string sourceFilename)
+	{
+		return sourceFilename + ".texcache";
+	}
+
+	bool openTextureCache(string sourceFilename, MipMode mode, bool compressed, float bumpStrength, MappedFile& cacheFile, MipChain& chain)
+	{
+		// map cache
+		if (!cacheFile.open(textureCachePath(sourceFilename)))
+		{
+			return false;
+		}
+		if (cacheFile.size() < sizeof(TextureCacheHeader))
+		{
+			cacheFile.close();
+			return false;
+		}
+		TextureCacheHeader header;
+		memcpy(&header, cacheFile.data(), sizeof(TextureCacheHeader));
+		if ((memcmp(header.magic, TEXTURE_CACHE_MAGIC, sizeof(TEXTURE_CACHE_MAGIC)) != 0) || (header.version != TEXTURE_CACHE_VERSION)
+			|| (header.mode != (unsigned int)mode) || (header.format > (unsigned int)BC5_TEXTURE)
+			|| ((header.format != (unsigned int)RGBA8_TEXTURE) != compressed) || (header.levelCount == 0)
+			|| ((header.bumpStrength != 0.0f) && (header.bumpStrength != bumpStrength)))
+		{
+			cacheFile.close();
+			return false;
+		}
+
+		// check the cache against its source, then against itself
+		if (!sourceStampMatches(sourceFilename, header.source)
+			|| (hashBytes(cacheFile.data() + sizeof(TextureCacheHeader), cacheFile.size() - sizeof(TextureCacheHeader)) != header.checksum))
+		{
+			cacheFile.close();
+			return false;
+		}
+
+		// resolve levels
+		size_t tableEnd = sizeof(TextureCacheHeader) + (header.levelCount * sizeof(TextureCacheLevel));
+		if (cacheFile.size() < tableEnd)
+		{
+			cacheFile.close();
+			return false;
+		}
+		chain.format = (TextureFormat)header.format;
+		chain.psnr = header.psnr;
+		chain.bumpStrength = header.bumpStrength;
+		chain.levels.clear();
+		chain.texels.clear();
+		for (unsigned int levelIndex = 0; levelIndex < header.levelCount; levelIndex++)
+		{
+			TextureCacheLevel level;
+			memcpy(&level, cacheFile.data() + sizeof(TextureCacheHeader) + (levelIndex * sizeof(TextureCacheLevel)), sizeof(TextureCacheLevel));
+			if ((level.offset > cacheFile.size()) || (level.size > (cacheFile.size() - level.offset))
+				|| (level.size != textureLevelSize(chain.format, (int)level.width, (int)level.height)))
+			{
+				chain.levels.clear();
+				cacheFile.close();
+				return false;
+			}
+			MipLevel mipLevel = {(int)level.width, (int)level.height, (size_t)level.offset};
+			chain.levels.push_back(mipLevel);
+		}
+		chain.mappedTexels = (const unsigned char*)cacheFile.data();
+		return true;
+	}
+
+	bool writeTextureCache(string sourceFilename, const SourceStamp& stamp, MipMode mode, const MipChain& chain)
+	{
+		// build header and level table
+		TextureCacheHeader header;
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, TEXTURE_CACHE_MAGIC, sizeof(TEXTURE_CACHE_MAGIC));
+		header.version = TEXTURE_CACHE_VERSION;
+		header.levelCount = (unsigned int)chain.levels.size();
+		header.source = stamp;
+		header.mode = (unsigned int)mode;
+		header.format = (unsigned int)chain.format;
+		header.psnr = chain.psnr;
+		header.bumpStrength = chain.bumpStrength;
+		vector<TextureCacheLevel> levels(chain.levels.size());
+		size_t offset = alignOffset(sizeof(TextureCacheHeader) + (levels.size() * sizeof(TextureCacheLevel)));
+		for (size_t levelIndex = 0; levelIndex < levels.size(); levelIndex++)
+		{
+			levels[levelIndex].width = (unsigned int)chain.levels[levelIndex].width;
+			levels[levelIndex].height = (unsigned int)chain.levels[levelIndex].height;
+			levels[levelIndex].offset = offset;
+			levels[levelIndex].size = textureLevelSize(chain.format, chain.levels[levelIndex].width, chain.levels[levelIndex].height);
+			offset = alignOffset(offset + (size_t)levels[levelIndex].size);
+		}
+
+		// lay out the file, padding included, so the checksum covers exactly what is written
+		size_t fileSize = levels.empty() ? offset : (size_t)(levels.back().offset + levels.back().size);
+		vector<char> contents(fileSize, 0);
+		memcpy(&contents[sizeof(TextureCacheHeader)], &levels[0], levels.size() * sizeof(TextureCacheLevel));
+		for (size_t levelIndex = 0; levelIndex < levels.size(); levelIndex++)
+		{
+			memcpy(&contents[(size_t)levels[levelIndex].offset], mipLevelTexels(chain, levelIndex), (size_t)levels[levelIndex].size);
+		}
+		header.checksum = hashBytes(&contents[sizeof(TextureCacheHeader)], fileSize - sizeof(TextureCacheHeader));
+		memcpy(&contents[0], &header, sizeof(TextureCacheHeader));
+
+		// write
+		// NOTE: Written to a temporary file first, so a half written cache is never picked up
+		string cachePath = textureCachePath(sourceFilename);
+		string temporaryPath = cachePath + ".tmp";
+		FILE* cacheFile = fopen(temporaryPath.c_str(), "wb");
+		if (!cacheFile)
+		{
+			cout << "    - Unable to write texture cache: " << cachePath << endl;
+			return false;
+		}
+		bool written = (fwrite(&contents[0], 1, fileSize, cacheFile) == fileSize);
+		written = (fclose(cacheFile) == 0) && written;
+		remove(cachePath.c_str());
+		if (!written || (rename(temporaryPath.c_str(), cachePath.c_str()) != 0))
+		{
+			remove(temporaryPath.c_str());
+			cout << "    - Unable to write texture cache: " << cachePath << endl;
+			return false;
+		}
+		return true;
+	}
+}
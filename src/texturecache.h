@@ -0,0 +1,55 @@
+//// Declaration Guards
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+//// Imports
+#include <string>
+#include "mappedfile.h"
+#include "meshcache.h"
+#include "mipmaps.h"
+
+namespace SWPTAS001
+{
+	//// Structures
+	struct TextureCacheHeader
+	{
+		char magic[8];
+		unsigned int version;
+		unsigned int levelCount;
+		SourceStamp source;
+		unsigned int mode; // MipMode the levels were filtered with
+		unsigned int format; // TextureFormat the levels are stored in
+		float psnr; // MipChain::psnr of block formats
+		float bumpStrength; // MipChain::bumpStrength of normal maps derived from heights
+		unsigned long long checksum; // hashBytes() of everything after the header
+	};
+
+	struct TextureCacheLevel
+	{
+		unsigned int width;
+		unsigned int height;
+		unsigned long long offset;
+		unsigned long long size;
+	};
+
+	//// Cache Routines
+	std::string textureCachePath(std::string sourceFilename);
+	bool openTextureCache(std::string sourceFilename, MipMode mode, bool compressed, float bumpStrength, MappedFile& cacheFile, MipChain& chain);
+	bool writeTextureCache(std::string sourceFilename, const SourceStamp& stamp, MipMode mode, const MipChain& chain);
+}
+
+#endif
+
+// NOTE: A texture cache lives next to its image (venusmap.png -> venusmap.png.texcache) and is the
+//       texture's GPU-ready container: a header, a table of TextureCacheLevel entries and then every
+//       level's RGBA texels or compressed blocks, each aligned to a 4 KB page, so a later launch gets
+//       the whole mip chain without decoding, filtering or compressing anything
+// NOTE: openTextureCache() maps the file and points the chain's levels straight into the mapping
+//       (MipChain::mappedTexels), so nothing is copied on the way to glTexImage2D; cacheFile must stay
+//       open for as long as the chain is used. The checksum is verified first, so a truncated or
+//       damaged file is rebuilt rather than uploaded
+// NOTE: As with mesh caches (see meshcache.h), a cache is only used while it matches its image and was
+//       filtered in the same mode, compressed (or not) as asked and, for normals derived from heights,
+//       derived at the same bumpStrength. It is trusted as is when the image is missing, so a deployment
+//       can ship containers alone, it is written in native byte order through a temporary file, and the
+//       version number is bumped whenever the layout or the filtering changes
@@ -0,0 +1,162 @@
+//// Header
+#include "textures.h"
+
+//// Imports
+#include "texturecache.h"
+#include "blockcompress.h"
+#include "heightmap.h"
+#include "mappedfile.h"
+#include "stb_image.h"
+#include <iostream>
+#include <chrono>
+#include <algorithm>
+#include <vector>
+
+//// Namespaces
+using namespace std;
+
+namespace SWPTAS001
+{
+	//////////////////
+	// Constructors //
+	//////////////////
+
+	TextureDecoder::TextureDecoder(const TextureSettings& settings) : fSettings(settings), fSavedTime(0.0)
+	{
+	}
+
+	TextureDecoder::~TextureDecoder()
+	{
+		for (map<string, Decode>::iterator decode = fDecodes.begin(); decode != fDecodes.end(); decode++)
+		{
+			if (decode->second.worker.joinable())
+			{
+				decode->second.worker.join();
+			}
+		}
+	}
+
+	///////////////////
+	// Core Routines //
+	///////////////////
+
+	void TextureDecoder::start(string filename, MipMode mode)
+	{
+		if (fDecodes.find(filename) != fDecodes.end())
+		{
+			return;
+		}
+		// NOTE: Map entries don't move as others are added, so the worker can fill in its own image
+		DecodedImage* image = &fDecodes[filename].image;
+		TextureSettings settings = fSettings;
+		fDecodes[filename].worker = thread([filename, mode, settings, image]()
+		{
+			// NOTE: A matching texture cache is mapped as is, which skips decoding, filtering and compressing altogether
+			chrono::high_resolution_clock::time_point decodeStart = chrono::high_resolution_clock::now();
+			image->fromCache = openTextureCache(filename, mode, settings.compress, settings.bumpStrength, image->cacheFile, image->mips);
+			if (!image->fromCache)
+			{
+				MappedFile sourceFile;
+				SourceStamp stamp;
+				if (readSourceStamp(filename, stamp) && sourceFile.open(filename))
+				{
+					stamp.hash = hashBytes(sourceFile.data(), sourceFile.size());
+					int width, height, channels;
+					unsigned char* pixels = stbi_load_from_memory((const stbi_uc*)sourceFile.data(), (int)sourceFile.size(), &width, &height, &channels, 4);
+					if (pixels)
+					{
+						// NOTE: Normal maps are rarely gray, so a gray one is taken to hold heights instead
+						if ((mode == NORMAL_MIPS) && isGrayscale(pixels, (size_t)width * height))
+						{
+							vector<unsigned char> normals((size_t)width * height * 4);
+							deriveNormalMap(pixels, width, height, settings.bumpStrength, &normals[0], 0);
+							generateMipChain(&normals[0], width, height, mode, image->mips, 0);
+							image->mips.bumpStrength = settings.bumpStrength;
+						}
+						else
+						{
+							generateMipChain(pixels, width, height, mode, image->mips, 0);
+						}
+						stbi_image_free(pixels);
+						if (settings.compress)
+						{
+							MipChain blocks;
+							compressMipChain(image->mips, chooseBlockFormat(image->mips, mode), blocks, 0);
+							image->mips = move(blocks);
+						}
+						writeTextureCache(filename, stamp, mode, image->mips);
+					}
+				}
+			}
+			if (!image->mips.levels.empty())
+			{
+				image->width = image->mips.levels[0].width;
+				image->height = image->mips.levels[0].height;
+				image->pixels = (image->mips.format == RGBA8_TEXTURE) ? mipLevelTexels(image->mips, 0) : NULL;
+			}
+			image->decodeTime = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - decodeStart).count();
+		});
+	}
+
+	const DecodedImage& TextureDecoder::wait(string filename, MipMode mode)
+	{
+		start(filename, mode);
+		Decode& decode = fDecodes[filename];
+		if (decode.worker.joinable())
+		{
+			chrono::high_resolution_clock::time_point waitStart = chrono::high_resolution_clock::now();
+			decode.worker.join();
+			decode.image.waitTime = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - waitStart).count();
+			if (decode.image.mips.levels.empty())
+			{
+				cout << "Unable to load texture: " << filename << endl;
+			}
+			else
+			{
+				double saved = max(0.0, decode.image.decodeTime - decode.image.waitTime);
+				fSavedTime += saved;
+				cout << "    - " << (decode.image.fromCache ? "Mapped " : "Decoded ") << filename << " (" << decode.image.width << " x "
+					<< decode.image.height << ", " << decode.image.mips.levels.size() << " mip levels";
+				if (decode.image.mips.format != RGBA8_TEXTURE)
+				{
+					static const char* formatNames[] = {"RGBA", "BC1", "BC3", "BC5"};
+					cout << " as " << formatNames[decode.image.mips.format] << " at " << decode.image.mips.psnr << " dB";
+				}
+				if (decode.image.mips.bumpStrength != 0.0f)
+				{
+					cout << ", normals derived from heights at strength " << decode.image.mips.bumpStrength;
+				}
+				cout << (decode.image.fromCache ? " from its cache" : "") << ") in " << decode.image.decodeTime << " ms on a worker";
+				if (fSettings.reportOverlap)
+				{
+					cout << ", waited " << decode.image.waitTime << " ms for it (saved " << saved << " ms)";
+				}
+				cout << endl;
+			}
+		}
+		return decode.image;
+	}
+
+	void TextureDecoder::release(string filename)
+	{
+		map<string, Decode>::iterator decode = fDecodes.find(filename);
+		if (decode == fDecodes.end())
+		{
+			return;
+		}
+		if (decode->second.worker.joinable())
+		{
+			decode->second.worker.join();
+		}
+		fDecodes.erase(decode);
+	}
+
+	///////////////
+	// Accessors //
+	///////////////
+
+	double TextureDecoder::savedTime()
+	{
+		return fSavedTime;
+	}
+}
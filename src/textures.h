@@ -0,0 +1,85 @@
+//// Declaration Guards
+#ifndef TEXTURES_H
+#define TEXTURES_H
+
+//// Imports
+#include <string>
+#include <map>
+#include <thread>
+#include <stddef.h>
+#include "mipmaps.h"
+#include "mappedfile.h"
+
+namespace SWPTAS001
+{
+	//// Structures
+	struct TextureSettings
+	{
+		bool compress = true; // block compress every chain (see blockcompress.h)
+		float bumpStrength = 12.0f; // texels the height range of a grayscale NORMAL_MIPS image stands for (see heightmap.h)
+		bool reportOverlap = true; // log how long each wait() blocked and how much decode time it saved
+	};
+
+	struct DecodedImage
+	{
+		int width = 0;
+		int height = 0;
+		const unsigned char* pixels = NULL; // width * height RGBA texels (mip level 0), NULL if compressed or the file couldn't be decoded
+		MipChain mips; // every mip level, including level 0, empty if the file couldn't be decoded
+		MappedFile cacheFile; // the texture cache mips points into, when it came from there
+		bool fromCache = false; // mapped from the texture cache rather than decoded and filtered
+		double decodeTime = 0.0; // ms the worker spent decoding (or reading the cache) and filtering
+		double waitTime = 0.0; // ms the caller of wait() was blocked
+	};
+
+	//// Classes
+	class TextureDecoder
+	{
+		//// Constructors
+		public:
+			TextureDecoder(const TextureSettings& settings = TextureSettings());
+			~TextureDecoder();
+
+		//// Core Routines
+		public:
+			void start(std::string filename, MipMode mode);
+			const DecodedImage& wait(std::string filename, MipMode mode);
+			void release(std::string filename);
+
+		//// Accessors
+		public:
+			double savedTime();
+
+		//// Decoding State
+		private:
+			struct Decode
+			{
+				std::thread worker;
+				DecodedImage image;
+			};
+			std::map<std::string, Decode> fDecodes;
+			TextureSettings fSettings;
+			double fSavedTime;
+
+		//// Copy Guards
+		private:
+			TextureDecoder(const TextureDecoder&);
+			TextureDecoder& operator=(const TextureDecoder&);
+	};
+}
+
+#endif
+
+// NOTE: start() decodes an image file to RGBA and builds its mip chain (see mipmaps.h) on its own worker
+//       thread right away, so decodes can run while the window, the GL context and the meshes are set
+//       up. The chain is mapped from the image's texture cache (see texturecache.h) when it matches, and
+//       written there otherwise. wait() blocks only until that one image is done (starting it first if
+//       nobody did) and must be called from the thread that called start(). Images stay decoded until
+//       release() or the decoder goes away
+// NOTE: Unless the settings say otherwise, every chain is block compressed (see blockcompress.h)
+//       before it is cached, so only the first launch pays for encoding and pixels stays NULL
+// NOTE: A NORMAL_MIPS image that turns out to be grayscale is a height map, so a normal map is derived
+//       from it (see deriveNormalMap()) before filtering, and the cache keeps the result
+// NOTE: savedTime() adds up, over every image waited for, how much of its decode time the caller didn't
+//       spend blocked, i.e. the wall-clock time the overlap saved. Callers with nothing to overlap (such as
+//       the texture baker) turn reportOverlap off, so the log doesn't claim savings that never happened
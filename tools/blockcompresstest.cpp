@@ -0,0 +1,174 @@
+//// Imports
+#include "../src/blockcompress.h"
+#include "../src/heightmap.h"
+#include "../src/stb_image.h"
+#include <iostream>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <ctype.h>
+#include <math.h>
+
+//// Namespaces
+using namespace std;
+
+//// Constants
+static const double BC1_MIN_PSNR = 32.0;
+static const double BC3_MIN_PSNR = 32.0;
+static const double BC5_MIN_PSNR = 40.0;
+static const int SYNTHETIC_SIZE = 256;
+static const float BUMP_STRENGTH = 12.0f;
+
+/////////////
+// Helpers //
+/////////////
+
+static const char* formatName(SWPTAS001::TextureFormat format)
+{
+	static const char* names[] = {"RGBA8", "BC1", "BC3", "BC5"};
+	return names[format];
+}
+
+static double minimumPSNR(SWPTAS001::TextureFormat format)
+{
+	return (format == SWPTAS001::BC1_TEXTURE) ? BC1_MIN_PSNR : ((format == SWPTAS001::BC3_TEXTURE) ? BC3_MIN_PSNR : BC5_MIN_PSNR);
+}
+
+// Compresses the chain to the format, decodes it back on the CPU and checks the whole chain against the threshold
+static bool checkRoundTrip(const string& name, const SWPTAS001::MipChain& source, SWPTAS001::TextureFormat format)
+{
+	SWPTAS001::MipChain compressed;
+	SWPTAS001::MipChain decoded;
+	SWPTAS001::compressMipChain(source, format, compressed, 0);
+	SWPTAS001::decompressMipChain(compressed, decoded, 0);
+	// NOTE: Each level's error is weighted by its texels, as that is how much of the screen it covers. The
+	//       smallest levels squeeze whole gradients into a block or two and can't be judged on their own
+	double worstPSNR = INFINITY;
+	size_t worstLevel = 0;
+	double weightedError = 0.0;
+	size_t totalTexels = 0;
+	for (size_t level = 0; level < source.levels.size(); level++)
+	{
+		size_t texelCount = (size_t)source.levels[level].width * source.levels[level].height;
+		double psnr = SWPTAS001::measurePSNR(SWPTAS001::mipLevelTexels(source, level), SWPTAS001::mipLevelTexels(decoded, level),
+			texelCount, format);
+		weightedError += texelCount * pow(10.0, -psnr / 10.0);
+		totalTexels += texelCount;
+		if (psnr < worstPSNR)
+		{
+			worstPSNR = psnr;
+			worstLevel = level;
+		}
+	}
+	double chainPSNR = -10.0 * log10(weightedError / totalTexels);
+	bool passed = (chainPSNR >= minimumPSNR(format));
+	cout << "    - " << name << " as " << formatName(format) << ": " << chainPSNR << " dB over " << source.levels.size()
+		<< " levels (needs " << minimumPSNR(format) << "), " << compressed.psnr << " dB at level 0, worst " << worstPSNR
+		<< " dB at level " << worstLevel << (passed ? "" : " FAILED") << endl;
+	return passed;
+}
+
+// Builds a smooth test image: a colour gradient, the same with an alpha ramp, or the normals of a bumpy surface
+static vector<unsigned char> syntheticImage(int kind)
+{
+	vector<unsigned char> pixels((size_t)SYNTHETIC_SIZE * SYNTHETIC_SIZE * 4);
+	for (int y = 0; y < SYNTHETIC_SIZE; y++)
+	{
+		for (int x = 0; x < SYNTHETIC_SIZE; x++)
+		{
+			unsigned char* texel = &pixels[4 * (((size_t)y * SYNTHETIC_SIZE) + x)];
+			float u = (float)x / (SYNTHETIC_SIZE - 1);
+			float v = (float)y / (SYNTHETIC_SIZE - 1);
+			if (kind < 2)
+			{
+				texel[0] = (unsigned char)(255.0f * u);
+				texel[1] = (unsigned char)(255.0f * v);
+				texel[2] = (unsigned char)(127.5f + (127.5f * sinf(6.2831853f * (u + v))));
+				texel[3] = (kind == 1) ? (unsigned char)(255.0f * (1.0f - u)) : 255;
+			}
+			else
+			{
+				float slopeX = 0.5f * cosf(12.566371f * u) * sinf(12.566371f * v);
+				float slopeY = 0.5f * sinf(12.566371f * u) * cosf(12.566371f * v);
+				float length = sqrtf((slopeX * slopeX) + (slopeY * slopeY) + 1.0f);
+				texel[0] = (unsigned char)(127.5f + (127.5f * (-slopeX / length)));
+				texel[1] = (unsigned char)(127.5f + (127.5f * (-slopeY / length)));
+				texel[2] = (unsigned char)(127.5f + (127.5f * (1.0f / length)));
+				texel[3] = 255;
+			}
+		}
+	}
+	return pixels;
+}
+
+// NOTE: Standalone round trip check for the block compressor. Every image given (and three smooth synthetic
+//       ones) gets its mip chain compressed and decoded back with the CPU decoder, and every level is compared
+//       against the level it came from. Colour images are checked as BC1 and as BC3, normal maps (named as the
+//       texture baker tells them apart, grayscale ones derived into normals first) as BC5. The exit status is
+//       non-zero when any chain falls below the format's PSNR threshold
+int main(int argc, char** argv)
+{
+	// initialize
+	cout << "\n[Block Compression Test]\n";
+	int checkCount = 0;
+	int failureCount = 0;
+
+	// synthetic images
+	const char* syntheticNames[] = {"synthetic gradient", "synthetic gradient with alpha", "synthetic normals"};
+	for (int kind = 0; kind < 3; kind++)
+	{
+		vector<unsigned char> pixels = syntheticImage(kind);
+		SWPTAS001::MipMode mode = (kind == 2) ? SWPTAS001::NORMAL_MIPS : SWPTAS001::COLOR_MIPS;
+		SWPTAS001::MipChain chain;
+		SWPTAS001::generateMipChain(&pixels[0], SYNTHETIC_SIZE, SYNTHETIC_SIZE, mode, chain, 0);
+		SWPTAS001::TextureFormat format = SWPTAS001::chooseBlockFormat(chain, mode);
+		failureCount += !checkRoundTrip(syntheticNames[kind], chain, format);
+		checkCount++;
+	}
+
+	// images
+	for (int i = 1; i < argc; i++)
+	{
+		string filename = argv[i];
+		int width;
+		int height;
+		int channels;
+		unsigned char* pixels = stbi_load(filename.c_str(), &width, &height, &channels, 4);
+		if (pixels == NULL)
+		{
+			cout << "    - Unable to load " << filename << " FAILED" << endl;
+			failureCount++;
+			continue;
+		}
+		string name = filename;
+		transform(name.begin(), name.end(), name.begin(), ::tolower);
+		bool normalMap = (name.find("bump") != string::npos) || (name.find("normal") != string::npos);
+		SWPTAS001::MipChain chain;
+		if (normalMap && SWPTAS001::isGrayscale(pixels, (size_t)width * height))
+		{
+			vector<unsigned char> normals((size_t)width * height * 4);
+			SWPTAS001::deriveNormalMap(pixels, width, height, BUMP_STRENGTH, &normals[0], 0);
+			SWPTAS001::generateMipChain(&normals[0], width, height, SWPTAS001::NORMAL_MIPS, chain, 0);
+		}
+		else
+		{
+			SWPTAS001::generateMipChain(pixels, width, height, normalMap ? SWPTAS001::NORMAL_MIPS : SWPTAS001::COLOR_MIPS, chain, 0);
+		}
+		stbi_image_free(pixels);
+		if (normalMap)
+		{
+			failureCount += !checkRoundTrip(filename, chain, SWPTAS001::BC5_TEXTURE);
+			checkCount++;
+		}
+		else
+		{
+			failureCount += !checkRoundTrip(filename, chain, SWPTAS001::BC1_TEXTURE);
+			failureCount += !checkRoundTrip(filename, chain, SWPTAS001::BC3_TEXTURE);
+			checkCount += 2;
+		}
+	}
+
+	// done
+	cout << "\n[" << (failureCount == 0 ? "Passed" : "Failed") << " " << (checkCount - failureCount) << " of " << checkCount << " round trip(s)]\n";
+	return (failureCount == 0) ? 0 : 1;
+}
@@ -0,0 +1,57 @@
+//// Imports
+#include "../src/geometry.h"
+#include <iostream>
+#include <stdlib.h>
+
+//// Namespaces
+using namespace std;
+
+// NOTE: Standalone converter that (re)builds the .meshcache next to every OBJ it is given, so that
+//       caches can be pre-baked during deployment rather than on the first run of AdvGL
+int main(int argc, char** argv)
+{
+	// initialize
+	cout << "\n[Mesh Baker]\n";
+	SWPTAS001::LoaderSettings loaderSettings;
+	int bakedCount = 0;
+	// parse arguments
+	for (int i = 1; i < argc; i++)
+	{
+		string argument = argv[i];
+		if ((argument == "--threads") && ((i + 1) < argc))
+		{
+			loaderSettings.threadCount = atoi(argv[++i]);
+			continue;
+		}
+		if ((argument == "--memory-budget") && ((i + 1) < argc))
+		{
+			loaderSettings.memoryBudget = (size_t)atoi(argv[++i]) << 20;
+			continue;
+		}
+		if ((argument == "--crease-angle") && ((i + 1) < argc))
+		{
+			loaderSettings.creaseAngle = (float)atof(argv[++i]);
+			continue;
+		}
+		if ((argument == "--displace") && ((i + 2) < argc))
+		{
+			loaderSettings.displacementMap = argv[++i];
+			loaderSettings.displacementScale = (float)atof(argv[++i]);
+			continue;
+		}
+		if (argument == "--qtangents")
+		{
+			loaderSettings.qtangents = true;
+			continue;
+		}
+		// NOTE: Any existing cache is removed first, so every file is always parsed and rewritten
+		cout << "Baking " << argument << ":" << endl;
+		remove(SWPTAS001::meshCachePath(argument).c_str());
+		SWPTAS001::GeometryData geometry;
+		geometry.loadFromOBJFile(argument, loaderSettings);
+		bakedCount += (geometry.vertexCount() > 0);
+	}
+	// done
+	cout << "\n[Baked " << bakedCount << " mesh(es)]\n";
+	return 0;
+}
@@ -0,0 +1,344 @@
+//// Imports
+#include "../src/numparse.h"
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include <ctype.h>
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//// Namespaces
+using namespace std;
+
+//// Constants
+static const size_t RANDOM_FLOAT_COUNT = 2000000;
+static const size_t RANDOM_GROUP_COUNT = 1000000;
+static const size_t BENCHMARK_FLOAT_COUNT = 4000000;
+static const int BENCHMARK_PASSES = 5;
+
+/////////////
+// Helpers //
+/////////////
+
+static size_t failureCount = 0;
+static volatile float benchmarkSink = 0.0f;
+
+static bool startsToken(const char* text)
+{
+	// NOTE: strtof() and strtol() skip leading whitespace, the OBJ parsers don't
+	return (*text != '\0') && !isspace((unsigned char)*text);
+}
+
+static int clampIndex(long field)
+{
+	// NOTE: Out of range indices saturate instead of wrapping
+	return (int)((field > INT_MAX) ? INT_MAX : ((field < -INT_MAX) ? -INT_MAX : field));
+}
+
+static void reportFailure(const string& kind, const string& text, const string& expected, const string& actual)
+{
+	// NOTE: Only the first few failures are printed, the total is reported at the end
+	if (failureCount < 20)
+	{
+		cout << "    - " << kind << " mismatch on \"" << text << "\": expected " << expected << ", got " << actual << endl;
+	}
+	failureCount++;
+}
+
+static string describeFloat(float value, size_t consumed)
+{
+	char description[64];
+	unsigned int bits;
+	memcpy(&bits, &value, sizeof(value));
+	snprintf(description, sizeof(description), "%.9g (0x%08X) after %u chars", value, bits, (unsigned int)consumed);
+	return description;
+}
+
+static void checkFloat(const string& text)
+{
+	// NOTE: Each string is checked twice, at the end of the buffer and followed by a full line, so both
+	//       the scalar tail and the 16 byte blocks get exercised
+	for (int padded = 0; padded < 2; padded++)
+	{
+		string buffer = text + (padded ? " 0.000000 0.000000 0.000000 0.000000 0.000000\n" : "");
+		// reference
+		char* referenceEnd = NULL;
+		float expected = strtof(buffer.c_str(), &referenceEnd);
+		size_t expectedLength = startsToken(buffer.c_str()) ? (referenceEnd - buffer.c_str()) : 0;
+		// parser
+		const char* cursor = buffer.data();
+		float actual = 0.0f;
+		bool parsed = SWPTAS001::parseFloat(cursor, buffer.data() + text.size(), actual);
+		size_t actualLength = cursor - buffer.data();
+		if (expectedLength == 0)
+		{
+			if (parsed)
+			{
+				reportFailure("Float", text, "no number", describeFloat(actual, actualLength));
+			}
+			continue;
+		}
+		bool sameValue = (isnan(expected) && isnan(actual)) || (memcmp(&expected, &actual, sizeof(float)) == 0);
+		if (!parsed || !sameValue || (expectedLength != actualLength))
+		{
+			reportFailure("Float", text, describeFloat(expected, expectedLength),
+				parsed ? describeFloat(actual, actualLength) : string("no number"));
+		}
+	}
+}
+
+static void checkIndexGroup(const string& text)
+{
+	for (int padded = 0; padded < 2; padded++)
+	{
+		string buffer = text + (padded ? " 1/1/1 2/2/2 3/3/3 4/4/4 5/5/5 6/6/6 7/7/7\n" : "");
+		// reference: up to three '/' separated strtol() fields, empty fields stay 0
+		int expected[3] = {0, 0, 0};
+		int expectedFields = 0;
+		const char* scan = buffer.c_str();
+		char* fieldEnd = (char*)scan;
+		long field = startsToken(scan) ? strtol(scan, &fieldEnd, 10) : 0;
+		if (fieldEnd != scan)
+		{
+			expected[0] = clampIndex(field);
+			expectedFields = 1;
+			scan = fieldEnd;
+			while ((expectedFields < 3) && (*scan == '/'))
+			{
+				scan++;
+				fieldEnd = (char*)scan;
+				field = startsToken(scan) ? strtol(scan, &fieldEnd, 10) : 0;
+				expected[expectedFields] = (fieldEnd != scan) ? clampIndex(field) : 0;
+				scan = fieldEnd;
+				expectedFields++;
+			}
+			// the whole run of digits, signs and separators is consumed, even past a fourth field
+			while (isdigit((unsigned char)*scan) || (*scan == '/') || (*scan == '-') || (*scan == '+'))
+			{
+				scan++;
+			}
+		}
+		// parser
+		const char* cursor = buffer.data();
+		int actual[3];
+		int actualFields = SWPTAS001::parseIndexGroup(cursor, buffer.data() + text.size(), actual);
+		if (expectedFields == 0)
+		{
+			if (actualFields != 0)
+			{
+				reportFailure("Index group", text, "no group", to_string(actualFields) + " field(s)");
+			}
+			continue;
+		}
+		if ((actualFields != expectedFields) || (memcmp(expected, actual, sizeof(expected)) != 0) ||
+			((cursor - buffer.data()) != (scan - buffer.c_str())))
+		{
+			reportFailure("Index group", text,
+				to_string(expected[0]) + "/" + to_string(expected[1]) + "/" + to_string(expected[2]) + " in " + to_string(expectedFields) + " field(s)",
+				to_string(actual[0]) + "/" + to_string(actual[1]) + "/" + to_string(actual[2]) + " in " + to_string(actualFields) + " field(s)");
+		}
+	}
+}
+
+static string randomFloatText(mt19937& generator)
+{
+	// NOTE: Mostly what exporters write (fixed point with 4-6 decimals), plus shortest round-trip,
+	//       scientific notation and arbitrary digit strings with exponents, which hit the fallback
+	char text[96];
+	uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	uniform_int_distribution<int> style(0, 5);
+	uniform_int_distribution<int> magnitude(-45, 39);
+	switch (style(generator))
+	{
+		case 0:
+			snprintf(text, sizeof(text), "%.6f", unit(generator));
+			break;
+		case 1:
+			snprintf(text, sizeof(text), "%.4f", unit(generator) * 1000.0f);
+			break;
+		case 2:
+			snprintf(text, sizeof(text), "%.9g", unit(generator) * powf(10.0f, (float)(magnitude(generator) / 2)));
+			break;
+		case 3:
+			snprintf(text, sizeof(text), "%e", (double)unit(generator) * pow(10.0, magnitude(generator)));
+			break;
+		case 4:
+		{
+			// random float bit patterns, printed exactly
+			unsigned int bits = generator();
+			float value;
+			memcpy(&value, &bits, sizeof(value));
+			snprintf(text, sizeof(text), "%.9g", isfinite(value) ? value : 1.0f);
+			break;
+		}
+		default:
+		{
+			// random digit strings, up to 30 digits either side of the point
+			uniform_int_distribution<int> digitCount(0, 30);
+			uniform_int_distribution<int> digit(0, 9);
+			string digits = (generator() & 1) ? "-" : "";
+			int integerDigits = digitCount(generator);
+			int fractionDigits = digitCount(generator);
+			for (int index = 0; index < integerDigits; index++)
+			{
+				digits += (char)('0' + digit(generator));
+			}
+			digits += ".";
+			for (int index = 0; index < fractionDigits; index++)
+			{
+				digits += (char)('0' + digit(generator));
+			}
+			digits += "e" + to_string(magnitude(generator));
+			return digits;
+		}
+	}
+	return text;
+}
+
+static string randomIndexGroupText(mt19937& generator)
+{
+	// NOTE: Covers all four corner forms, with indices from 1 to 9 digits and negative (relative) ones
+	uniform_int_distribution<int> form(0, 3);
+	uniform_int_distribution<int> digitCount(1, 9);
+	string fields[3];
+	for (int index = 0; index < 3; index++)
+	{
+		int digits = digitCount(generator);
+		fields[index] = ((generator() % 8) == 0) ? "-" : "";
+		fields[index] += to_string(1 + (generator() % 9));
+		for (int place = 1; place < digits; place++)
+		{
+			fields[index] += to_string(generator() % 10);
+		}
+	}
+	switch (form(generator))
+	{
+		case 0:
+			return fields[0];
+		case 1:
+			return fields[0] + "/" + fields[1];
+		case 2:
+			return fields[0] + "//" + fields[2];
+		default:
+			return fields[0] + "/" + fields[1] + "/" + fields[2];
+	}
+}
+
+template <typename ParseFunction>
+static double measureThroughput(const string& buffer, size_t tokenCount, ParseFunction parse)
+{
+	// NOTE: The best of a few passes, reported in MB/s of source text
+	double bestTime = 1e30;
+	float checksum = 0.0f;
+	for (int pass = 0; pass < BENCHMARK_PASSES; pass++)
+	{
+		chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+		checksum += parse(buffer, tokenCount);
+		double time = chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+		bestTime = (time < bestTime) ? time : bestTime;
+	}
+	// keep the parses from being optimised away
+	benchmarkSink = checksum;
+	return (buffer.size() / (1024.0 * 1024.0)) / bestTime;
+}
+
+static float parseAllFast(const string& buffer, size_t tokenCount)
+{
+	const char* cursor = buffer.data();
+	const char* end = buffer.data() + buffer.size();
+	float sum = 0.0f;
+	for (size_t token = 0; token < tokenCount; token++)
+	{
+		float value;
+		SWPTAS001::parseFloat(cursor, end, value);
+		sum += value;
+		cursor++;
+	}
+	return sum;
+}
+
+static float parseAllStrtof(const string& buffer, size_t tokenCount)
+{
+	const char* cursor = buffer.c_str();
+	float sum = 0.0f;
+	for (size_t token = 0; token < tokenCount; token++)
+	{
+		char* tokenEnd;
+		sum += strtof(cursor, &tokenEnd);
+		cursor = tokenEnd + 1;
+	}
+	return sum;
+}
+
+// NOTE: Standalone checker for the OBJ number parser. parseFloat() must match strtof() bit for bit, and
+//       consume exactly as many characters, on generated and edge case strings; parseIndexGroup() must
+//       match a strtol() split of the same corner. The throughput of both float parsers is reported on
+//       vertex-like text, and the exit status is non-zero on any mismatch
+int main(int argc, char** argv)
+{
+	// initialize
+	cout << "\n[Number Parser Test]\n";
+	mt19937 generator(argc > 1 ? (unsigned int)atoi(argv[1]) : 2016u);
+
+	// edge cases
+	const char* floatEdgeCases[] = {
+		"0", "-0", "+0", "0.0", "-0.0", ".5", "-.5", "5.", "+5.", "00000000000000000000001.5", "1e0", "1E+2",
+		"1e-2", "1.e3", "-1.5e", "1.5e+", "2.5e-x", "e5", ".", "-", "+", "-.", "abc", "",
+		"1.17549435e-38", "1.17549421e-38", "1.4e-45", "7e-46", "1e-46", "3.40282347e38", "3.40282357e38",
+		"3.5e38", "1e39", "1e-50", "1e400", "0.1", "0.2", "0.3", "16777216", "16777217", "16777218",
+		"1.00000005960464477539062", "1.00000017881393432617188", "0.500000029802322387695312",
+		"123456789012345678901234567890", "0.000000000000000000000000000001234", "9007199254740993",
+		"18446744073709551616", "1e22", "1e23", "1e-22", "1e-23", "inf", "-inf", "infinity", "nan",
+		"-nan", "1.5/2", "-2.25 3", "0.123456\r\n", "1,5"};
+	for (size_t index = 0; index < sizeof(floatEdgeCases) / sizeof(floatEdgeCases[0]); index++)
+	{
+		checkFloat(floatEdgeCases[index]);
+	}
+	const char* groupEdgeCases[] = {
+		"1", "1/2", "1//3", "1/2/3", "-1/-2/-3", "+1/+2/+3", "1/", "1//", "1/2/", "/1/2", "//", "",
+		"12345678/12345678/12345678", "123456789/123456789/123456789", "2147483647/1/1", "99999999999/1/1",
+		"1/2/3/4", "1/2/3 4/5/6", "10000/10000/10000", "7/8/9\r\n", "a/b/c", "1/a/3"};
+	for (size_t index = 0; index < sizeof(groupEdgeCases) / sizeof(groupEdgeCases[0]); index++)
+	{
+		checkIndexGroup(groupEdgeCases[index]);
+	}
+	size_t edgeFailures = failureCount;
+	cout << "    - Checked " << (sizeof(floatEdgeCases) / sizeof(floatEdgeCases[0])) << " float and "
+		<< (sizeof(groupEdgeCases) / sizeof(groupEdgeCases[0])) << " index group edge cases, "
+		<< edgeFailures << " mismatch(es)" << endl;
+
+	// generated strings
+	for (size_t index = 0; index < RANDOM_FLOAT_COUNT; index++)
+	{
+		checkFloat(randomFloatText(generator));
+	}
+	for (size_t index = 0; index < RANDOM_GROUP_COUNT; index++)
+	{
+		checkIndexGroup(randomIndexGroupText(generator));
+	}
+	cout << "    - Checked " << RANDOM_FLOAT_COUNT << " generated floats and " << RANDOM_GROUP_COUNT
+		<< " generated index groups, " << (failureCount - edgeFailures) << " mismatch(es)" << endl;
+
+	// throughput on vertex-like text
+	string benchmarkText;
+	uniform_real_distribution<float> coordinate(-1.0f, 1.0f);
+	for (size_t index = 0; index < BENCHMARK_FLOAT_COUNT; index++)
+	{
+		char text[32];
+		snprintf(text, sizeof(text), "%.6f ", coordinate(generator));
+		benchmarkText += text;
+	}
+	double fastRate = measureThroughput(benchmarkText, BENCHMARK_FLOAT_COUNT, parseAllFast);
+	double strtofRate = measureThroughput(benchmarkText, BENCHMARK_FLOAT_COUNT, parseAllStrtof);
+	cout << "    - parseFloat: " << fastRate << " MB/s, strtof: " << strtofRate << " MB/s ("
+		<< (fastRate / strtofRate) << "x)" << endl;
+
+	// done
+	cout << "\n[" << (failureCount == 0 ? "Passed" : "Failed") << " with " << failureCount << " mismatch(es)]\n";
+	return (failureCount == 0) ? 0 : 1;
+}
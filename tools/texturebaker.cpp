@@ -0,0 +1,75 @@
+//// Imports
+#include "../src/textures.h"
+#include "../src/texturecache.h"
+#include <iostream>
+#include <algorithm>
+#include <vector>
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+//// Namespaces
+using namespace std;
+
+// NOTE: Standalone converter that (re)builds the .texcache container next to every image it is given, so
+//       AdvGL maps its textures ready for the GPU instead of decoding PNGs at startup. Images whose names
+//       mention "bump" or "normal" are filtered as normal maps and anything else as colour, unless
+//       --normal or --color comes before the file. A grayscale normal map is taken as heights and turned
+//       into normals, --bump-strength sets how steep
+int main(int argc, char** argv)
+{
+	// initialize
+	cout << "\n[Texture Baker]\n";
+	SWPTAS001::TextureSettings textureSettings;
+	textureSettings.reportOverlap = false;
+	vector<string> filenames;
+	vector<SWPTAS001::MipMode> modes;
+	// parse arguments
+	for (int i = 1; i < argc; i++)
+	{
+		string argument = argv[i];
+		if (argument == "--no-compression")
+		{
+			textureSettings.compress = false;
+			continue;
+		}
+		if ((argument == "--bump-strength") && ((i + 1) < argc))
+		{
+			textureSettings.bumpStrength = (float)atof(argv[++i]);
+			continue;
+		}
+		SWPTAS001::MipMode mode = SWPTAS001::COLOR_MIPS;
+		if (((argument == "--normal") || (argument == "--color")) && ((i + 1) < argc))
+		{
+			mode = (argument == "--normal") ? SWPTAS001::NORMAL_MIPS : SWPTAS001::COLOR_MIPS;
+			argument = argv[++i];
+		}
+		else
+		{
+			string name = argument;
+			transform(name.begin(), name.end(), name.begin(), ::tolower);
+			bool normalMap = (name.find("bump") != string::npos) || (name.find("normal") != string::npos);
+			mode = normalMap ? SWPTAS001::NORMAL_MIPS : SWPTAS001::COLOR_MIPS;
+		}
+		filenames.push_back(argument);
+		modes.push_back(mode);
+	}
+	// NOTE: Any existing cache is removed first, so every image is always decoded and rewritten, and
+	//       all of them decode at once on the decoder's workers
+	SWPTAS001::TextureDecoder textureDecoder(textureSettings);
+	for (size_t file = 0; file < filenames.size(); file++)
+	{
+		remove(SWPTAS001::textureCachePath(filenames[file]).c_str());
+		textureDecoder.start(filenames[file], modes[file]);
+	}
+	int bakedCount = 0;
+	for (size_t file = 0; file < filenames.size(); file++)
+	{
+		cout << "Baking " << filenames[file] << (modes[file] == SWPTAS001::NORMAL_MIPS ? " as a normal map:" : ":") << endl;
+		bakedCount += !textureDecoder.wait(filenames[file], modes[file]).mips.levels.empty();
+		textureDecoder.release(filenames[file]);
+	}
+	// done
+	cout << "\n[Baked " << bakedCount << " texture(s)]\n";
+	return 0;
+}